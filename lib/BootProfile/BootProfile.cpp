@@ -0,0 +1,29 @@
+#include "BootProfile.h"
+#include <Logger.h>
+#include <esp_timer.h>
+
+void BootProfile::Mark(const char *name) {
+  uint32_t us = esp_timer_get_time();
+  bool recorded = false;
+  portENTER_CRITICAL(&lock);
+  uint8_t index = numPhases.load(std::memory_order_relaxed);
+  if (index < BOOT_MAX_PHASES) {
+    phases[index] = {name, us};
+    numPhases.store(index + 1, std::memory_order_release);
+    recorded = true;
+  }
+  portEXIT_CRITICAL(&lock);
+  if (recorded) {
+    LOG_INFO("Boot phase %s done at %u.%03u ms", name, us / 1000, us % 1000);
+  }
+}
+
+uint32_t BootProfile::GetPhaseUs(const char *name) const {
+  uint8_t count = GetNumPhases();
+  for (uint8_t i = 0; i < count; i++) {
+    if (strcmp(phases[i].name, name) == 0) {
+      return phases[i].us;
+    }
+  }
+  return 0;
+}
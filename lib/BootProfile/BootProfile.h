@@ -0,0 +1,44 @@
+#ifndef BOOTPROFILE_H
+#define BOOTPROFILE_H
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * @brief Timestamps of the boot phases
+ * @details Mark() records the time since the app started (esp_timer, in us)
+ * under a phase name and logs it. Phases are marked from setup() and from
+ * the network task as they finish, so they are not strictly sequential:
+ * each timestamp is absolute, not a duration.
+ */
+#define BOOT_MAX_PHASES 12
+
+struct BootPhase {
+  const char *name; // Literal
+  uint32_t us;      // Microseconds since the app started
+};
+
+class BootProfile {
+public:
+  /**
+   * @brief Record that phase `name` just finished (any task)
+   */
+  void Mark(const char *name);
+
+  uint8_t GetNumPhases() const {
+    return numPhases.load(std::memory_order_acquire);
+  }
+  const BootPhase &GetPhase(uint8_t index) const { return phases[index]; }
+
+  /**
+   * @brief Time phase `name` finished, 0 if it has not (yet)
+   */
+  uint32_t GetPhaseUs(const char *name) const;
+
+private:
+  BootPhase phases[BOOT_MAX_PHASES];
+  std::atomic<uint8_t> numPhases{0}; // Published with the phase written
+  portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+};
+
+#endif // BOOTPROFILE_H
@@ -1,35 +1,150 @@
 #include "DebounceButton.h"
+#include <Deadline.h>
 
-DebounceButton::DebounceButton(int buttonPin, unsigned long debounceDelay)
-    : buttonPin(buttonPin), debounceDelay(debounceDelay), lastButtonState(HIGH),
-      buttonState(HIGH), lastDebounceTime(0) {
+DebounceButton::DebounceButton(int buttonPin, uint8_t input, uint8_t longInput,
+                               unsigned long debounceDelay)
+    : buttonPin(buttonPin), input(input), longInput(longInput),
+      debounceDelay(debounceDelay) {
   pinMode(buttonPin, INPUT_PULLUP);
 
   // ensure it doesn't register a press on startup
-  int initialState = digitalRead(buttonPin);
-  lastButtonState = initialState;
-  buttonState = initialState;
+  stable = digitalRead(buttonPin) == LOW;
+  hold = stable ? kConsumed : kReleased;
 }
 
-bool DebounceButton::isPressed() {
-  int reading = digitalRead(buttonPin);
+void DebounceButton::Attach(uint8_t newIndex, ButtonEdgeQueue *edgeQueue) {
+  index = newIndex;
+  edges = edgeQueue;
+  attachInterruptArg(buttonPin, &DebounceButton::HandleEdge, this, CHANGE);
+}
+
+void IRAM_ATTR DebounceButton::HandleEdge(void *arg) {
+  DebounceButton *button = static_cast<DebounceButton *>(arg);
+
+  // All GPIO handlers are dispatched from one ISR, so this is the queue's only
+  // producer. A full queue just drops the edge; the timer re-reads the pin
+  // once the lockout expires and catches up.
+  ButtonEdge edge = {button->index, digitalRead(button->buttonPin) == LOW,
+                     (uint32_t)millis()};
+  button->edges->Push(edge);
+}
+
+void InputManager::AddButton(DebounceButton *button) {
+  if (numButtons < MAX_BUTTONS) {
+    buttons[numButtons++] = button;
+  }
+}
+
+void InputManager::AddChord(DebounceButton *first, DebounceButton *second,
+                            uint8_t input) {
+  if (numChords < MAX_CHORDS) {
+    chords[numChords++] = {first, second, input};
+  }
+}
+
+void InputManager::AddSource(InputSource *source) {
+  if (numSources < MAX_INPUT_SOURCES) {
+    sources[numSources++] = source;
+  }
+}
+
+void InputManager::Begin() {
+  for (uint8_t i = 0; i < numButtons; i++) {
+    buttons[i]->Attach(i, &edges);
+  }
+
+  esp_timer_create_args_t args = {};
+  args.callback = &InputManager::PollCallback;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "input";
+  esp_timer_create(&args, &timer);
+  esp_timer_start_periodic(timer, INPUT_POLL_MS * 1000);
+}
+
+void InputManager::PollCallback(void *arg) {
+  static_cast<InputManager *>(arg)->Poll(millis());
+}
 
-  // Debounce logic
-  if (reading != lastButtonState) {
-    lastDebounceTime = millis();
+void InputManager::Poll(uint32_t now) {
+  // Leading-edge debounce: the first edge is taken at its ISR timestamp and
+  // anything inside the lockout window is treated as bounce.
+  ButtonEdge edge;
+  while (edges.Pop(edge)) {
+    DebounceButton &button = *buttons[edge.button];
+    if (edge.pressed != button.stable &&
+        reached(edge.time_ms, button.lockoutUntil)) {
+      Accept(button, edge.pressed, edge.time_ms);
+    }
   }
 
-  // Check if the button has been pressed for more than the debounce delay
-  if ((millis() - lastDebounceTime) > debounceDelay) {
-    if (reading != buttonState) {
-      buttonState = reading;
+  for (uint8_t i = 0; i < numButtons; i++) {
+    DebounceButton &button = *buttons[i];
+
+    // Once the lockout is over the pin has settled, so pick up a level that
+    // was bounced away from (or whose edge was dropped)
+    if (reached(now, button.lockoutUntil)) {
+      bool level = digitalRead(button.buttonPin) == LOW;
+      if (level != button.stable) {
+        Accept(button, level, now);
+      }
+    }
+
+    if (button.hold != DebounceButton::kPressed &&
+        button.hold != DebounceButton::kRepeating) {
+      continue;
+    }
 
-      if (buttonState == HIGH) {
-        return true;
+    if (button.longInput != NO_INPUT) {
+      if (reached(now, button.pressedAt + LONG_PRESS_MS)) {
+        Emit(button.longInput, now);
+        button.hold = DebounceButton::kConsumed;
       }
+    } else if (reached(now, button.nextRepeat)) {
+      Emit(button.input, now);
+      button.hold = DebounceButton::kRepeating;
+      button.nextRepeat += REPEAT_INTERVAL_MS;
     }
   }
 
-  lastButtonState = reading;
-  return false;
+  InputEvent event;
+  for (uint8_t i = 0; i < numSources; i++) {
+    if (sources[i]->Poll(now, event)) {
+      events.Push(event);
+    }
+  }
+}
+
+void InputManager::Accept(DebounceButton &button, bool pressed, uint32_t now) {
+  button.stable = pressed;
+  button.lockoutUntil = now + button.debounceDelay;
+
+  if (!pressed) {
+    // Short presses report on release so chords and long presses can win
+    if (button.hold == DebounceButton::kPressed) {
+      Emit(button.input, now);
+    }
+    button.hold = DebounceButton::kReleased;
+    return;
+  }
+
+  button.hold = DebounceButton::kPressed;
+  button.pressedAt = now;
+  button.nextRepeat = now + REPEAT_DELAY_MS;
+
+  for (uint8_t i = 0; i < numChords; i++) {
+    Chord &chord = chords[i];
+    if (chord.first->stable && chord.second->stable &&
+        chord.first->hold != DebounceButton::kConsumed &&
+        chord.second->hold != DebounceButton::kConsumed) {
+      Emit(chord.input, now);
+      chord.first->hold = DebounceButton::kConsumed;
+      chord.second->hold = DebounceButton::kConsumed;
+    }
+  }
+}
+
+void InputManager::Emit(uint8_t input, uint32_t now) {
+  InputEvent event = {input, 1, now};
+  events.Push(event); // Drop on overflow rather than block the timer
 }
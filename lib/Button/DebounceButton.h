@@ -2,27 +2,145 @@
 #define DEBOUNCEBUTTON_H
 
 #include <Arduino.h>
+#include <esp_timer.h>
 
-#define NO_INPUT 0
-#define UP 1
-#define DOWN 2
-#define SELECT 3
+#include "InputEvent.h"
+#include "InputQueue.h"
 
+#define MAX_BUTTONS 4
+#define MAX_CHORDS 2
+#define MAX_INPUT_SOURCES 2
+#define INPUT_POLL_MS 5        // Period of the debounce/gesture timer
+#define LONG_PRESS_MS 600      // Hold time before a long press is reported
+#define REPEAT_DELAY_MS 400    // Hold time before auto-repeat kicks in
+#define REPEAT_INTERVAL_MS 120 // Time between auto-repeats while held
+
+/**
+ * @brief Raw pin change captured by a button ISR
+ */
+struct ButtonEdge {
+  uint8_t button;   // Index of the button inside its InputManager
+  bool pressed;     // Level after the edge (true = pressed)
+  uint32_t time_ms; // millis() when the edge fired
+};
+
+typedef InputQueue<ButtonEdge, 32> ButtonEdgeQueue;
+typedef InputQueue<InputEvent, 16> InputEventQueue;
+
+/**
+ * @brief Active-low push button sampled by a pin-change interrupt
+ * @details The ISR only timestamps edges; debouncing and gesture decoding
+ * happen in the InputManager timer, which owns the state below.
+ */
 class DebounceButton {
 public:
-  // Constructor
-  DebounceButton(int buttonPin, unsigned long debounceDelay = 50);
+  /**
+   * @brief Constructor
+   * @param buttonPin GPIO the button pulls to ground
+   * @param input Input reported on a short press
+   * @param longInput Input reported once when held for LONG_PRESS_MS. With
+   * NO_INPUT the button auto-repeats `input` while held instead.
+   * @param debounceDelay Lockout after an accepted edge in milliseconds
+   */
+  DebounceButton(int buttonPin, uint8_t input, uint8_t longInput = NO_INPUT,
+                 unsigned long debounceDelay = 50);
+
+  /**
+   * @brief Attach the pin-change interrupt
+   * @param index Index reported in every ButtonEdge
+   * @param edges Queue the ISR pushes edges into
+   */
+  void Attach(uint8_t index, ButtonEdgeQueue *edges);
 
-  // Method to check if the button is pressed
-  bool isPressed();
-  uint8_t getInput();
+  // Debounced level as last seen by the InputManager
+  bool IsHeld() const { return stable; }
 
 private:
-  const int buttonPin;                // Pin number for the button
-  const unsigned long debounceDelay;  // Debounce time in milliseconds
-  int buttonState = LOW;              // Current reading from the button
-  int lastButtonState = LOW;          // Previous reading from the button
-  unsigned long lastDebounceTime = 0; // Last time the button state was toggled
+  friend class InputManager;
+
+  enum HoldState : uint8_t {
+    kReleased,  // Not pressed
+    kPressed,   // Pressed, nothing reported yet
+    kRepeating, // Held long enough to auto-repeat
+    kConsumed   // Long press or chord reported, ignore until release
+  };
+
+  static void IRAM_ATTR HandleEdge(void *arg);
+
+  const int buttonPin;               // Pin number for the button
+  const uint8_t input;               // Input on a short press
+  const uint8_t longInput;           // Input on a long press (or NO_INPUT)
+  const unsigned long debounceDelay; // Debounce time in milliseconds
+  uint8_t index = 0;                 // Index in the owning InputManager
+  ButtonEdgeQueue *edges = nullptr;  // Queue fed by the ISR
+
+  bool stable = false;        // Debounced level (true = pressed)
+  HoldState hold = kReleased; // Gesture state while pressed
+  uint32_t lockoutUntil = 0;  // End of the current debounce lockout
+  uint32_t pressedAt = 0;     // Time the current press was accepted
+  uint32_t nextRepeat = 0;    // Time of the next auto-repeat
+};
+
+/**
+ * @brief Turns button edges into a queue of timestamped input events
+ * @details Button ISRs feed a lock-free edge queue; a periodic esp_timer
+ * drains it, debounces, detects long presses, auto-repeat and chords and
+ * pushes InputEvents for loop() to consume. Extra InputSources are polled
+ * from the same timer. Input latency therefore no longer depends on how long
+ * rendering or HTTP handling takes.
+ */
+class InputManager {
+public:
+  /**
+   * @brief Register a button (call before Begin)
+   */
+  void AddButton(DebounceButton *button);
+
+  /**
+   * @brief Report `input` instead of the individual buttons when both are
+   * pressed together
+   */
+  void AddChord(DebounceButton *first, DebounceButton *second, uint8_t input);
+
+  /**
+   * @brief Register an extra source (e.g. a rotary encoder) polled alongside
+   * the buttons (call before Begin)
+   */
+  void AddSource(InputSource *source);
+
+  /**
+   * @brief Attach the button interrupts and start the gesture timer
+   */
+  void Begin();
+
+  /**
+   * @brief Pop the next input event
+   * @return false once the queue is empty
+   */
+  bool Read(InputEvent &event) { return events.Pop(event); }
+
+private:
+  struct Chord {
+    DebounceButton *first;
+    DebounceButton *second;
+    uint8_t input;
+  };
+
+  static void PollCallback(void *arg);
+  void Poll(uint32_t now);
+  void Accept(DebounceButton &button, bool pressed, uint32_t now);
+  void Emit(uint8_t input, uint32_t now);
+
+  DebounceButton *buttons[MAX_BUTTONS] = {};
+  uint8_t numButtons = 0;
+  Chord chords[MAX_CHORDS] = {};
+  uint8_t numChords = 0;
+  InputSource *sources[MAX_INPUT_SOURCES] = {};
+  uint8_t numSources = 0;
+
+  ButtonEdgeQueue edges;   // ISR -> timer
+  InputEventQueue events;  // timer -> loop()
+  esp_timer_handle_t timer = nullptr;
 };
 
 // for easy
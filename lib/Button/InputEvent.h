@@ -0,0 +1,40 @@
+#ifndef INPUTEVENT_H
+#define INPUTEVENT_H
+
+#include <stdint.h>
+
+#define NO_INPUT 0
+#define UP 1
+#define DOWN 2
+#define SELECT 3
+#define BACK 4 // Long press on select
+#define HOME 5 // Up and down pressed together
+
+/**
+ * @brief Debounced, decoded input ready for Screen::HandleInput
+ */
+struct InputEvent {
+  uint8_t input;    // UP, DOWN, SELECT, BACK or HOME
+  uint8_t steps;    // How many times to apply the input (encoder speed-up)
+  uint32_t time_ms; // millis() when the gesture was recognised
+};
+
+/**
+ * @brief Something besides the buttons that produces input events
+ * @details Polled from the InputManager timer, so implementations must not
+ * block and only need to be safe against that one caller.
+ */
+class InputSource {
+public:
+  virtual ~InputSource() {}
+
+  /**
+   * @brief Sample the source
+   * @param now_ms Current millis()
+   * @param event Filled in when there is something to report
+   * @return true if `event` was filled in
+   */
+  virtual bool Poll(uint32_t now_ms, InputEvent &event) = 0;
+};
+
+#endif // INPUTEVENT_H
@@ -0,0 +1,61 @@
+#ifndef INPUTQUEUE_H
+#define INPUTQUEUE_H
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @brief Fixed-size single-producer/single-consumer ring buffer
+ * @details Lock-free: the producer only writes head_ and the consumer only
+ * writes tail_, so it is safe to push from an ISR or timer callback and pop
+ * from loop() without disabling interrupts. One slot is kept free to tell a
+ * full queue from an empty one.
+ * @tparam T Item type (should be trivially copyable)
+ * @tparam N Number of slots, must be a power of two
+ */
+template <typename T, uint32_t N> class InputQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+
+public:
+  /**
+   * @brief Push an item (producer side)
+   * @return false if the queue was full and the item was dropped
+   * @note Always inlined so ISR callers stay entirely in IRAM
+   */
+  inline __attribute__((always_inline)) bool Push(const T &item) {
+    const uint32_t head = head_.load(std::memory_order_relaxed);
+    const uint32_t next = (head + 1) & (N - 1);
+    if (next == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    items_[head] = item;
+    head_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Pop the oldest item (consumer side)
+   * @return false if the queue was empty
+   */
+  inline __attribute__((always_inline)) bool Pop(T &item) {
+    const uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = items_[tail];
+    tail_.store((tail + 1) & (N - 1), std::memory_order_release);
+    return true;
+  }
+
+  bool IsEmpty() const {
+    return tail_.load(std::memory_order_acquire) ==
+           head_.load(std::memory_order_acquire);
+  }
+
+private:
+  T items_[N];
+  std::atomic<uint32_t> head_{0}; // Next slot to write (producer owned)
+  std::atomic<uint32_t> tail_{0}; // Next slot to read (consumer owned)
+};
+
+#endif // INPUTQUEUE_H
@@ -0,0 +1,200 @@
+#include "CrashLog.h"
+#include <Logger.h>
+#include <Preferences.h>
+#include <esp_idf_version.h>
+#include <esp_partition.h>
+#include <esp_system.h>
+
+// The summary API needs the ELF dump format (the Arduino core's default)
+#if defined(CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH) &&                            \
+    defined(CONFIG_ESP_COREDUMP_DATA_FORMAT_ELF) &&                            \
+    ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 4, 0)
+#define CRASH_HAS_COREDUMP 1
+#include <esp_core_dump.h>
+#else
+#define CRASH_HAS_COREDUMP 0
+#endif
+
+static const char *const resetReasonNames[CRASH_RESET_REASONS] = {
+    "unknown",   "powerOn",  "external", "software",
+    "panic",     "intWdt",   "taskWdt",  "wdt",
+    "deepSleep", "brownout", "sdio",     "usb",
+    "jtag",      "efuse",    "powerGlitch", "cpuLockup"};
+
+const char *resetReasonName(uint8_t reason) {
+  return reason < CRASH_RESET_REASONS ? resetReasonNames[reason] : "unknown";
+}
+
+const char *exceptionCauseName(uint32_t cause) {
+  switch (cause) {
+  case 0:
+    return "IllegalInstruction";
+  case 2:
+    return "InstructionFetchError";
+  case 3:
+    return "LoadStoreError";
+  case 6:
+    return "IntegerDivideByZero";
+  case 9:
+    return "LoadStoreAlignment";
+  case 20:
+    return "InstFetchProhibited";
+  case 28:
+    return "LoadProhibited";
+  case 29:
+    return "StoreProhibited";
+  }
+  return "";
+}
+
+static bool isCrashReason(uint8_t reason) {
+  return reason == ESP_RST_PANIC || reason == ESP_RST_INT_WDT ||
+         reason == ESP_RST_TASK_WDT || reason == ESP_RST_WDT;
+}
+
+static const esp_partition_t *coreDumpPartition() {
+  static const esp_partition_t *partition = esp_partition_find_first(
+      ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_COREDUMP, nullptr);
+  return partition;
+}
+
+/**
+ * @brief Identifies a core dump image: the IDF keeps its checksum in the
+ * last bytes, so two dumps only match if they are the same dump
+ */
+struct CoreDumpId {
+  uint32_t size;
+  uint32_t checksum; // Last word of the image
+  uint32_t boot;     // Boot that captured it
+};
+
+void CrashLog::Begin() {
+  resetReason = esp_reset_reason();
+
+#if CRASH_HAS_COREDUMP
+  // Checking the image reads all of it, so only once per boot
+  size_t address;
+  if (esp_core_dump_image_get(&address, &coreDumpSize) != ESP_OK) {
+    coreDumpSize = 0;
+  }
+#endif
+
+  Preferences prefs;
+  prefs.begin("crashlog", false);
+  bootCount = prefs.getUInt("boots", 0) + 1;
+  prefs.putUInt("boots", bootCount);
+  prefs.getBytes("resets", resetCounts, sizeof(resetCounts));
+  if (resetReason < CRASH_RESET_REASONS) {
+    resetCounts[resetReason]++;
+  }
+  prefs.putBytes("resets", resetCounts, sizeof(resetCounts));
+  CoreDumpId id = {};
+  prefs.getBytes("dump", &id, sizeof(id));
+
+  if (isCrashReason(resetReason)) {
+    // A watchdog reset may leave no dump; the record still says when
+    crash = {};
+    crash.boot = bootCount;
+    crash.resetReason = resetReason;
+    // The dump stays in flash until the next crash overwrites it; a reset
+    // that wrote none would otherwise capture the previous one again
+    uint32_t checksum = CoreDumpChecksum();
+    if (coreDumpSize != 0 &&
+        (coreDumpSize != id.size || checksum != id.checksum)) {
+      CaptureCoreDump();
+      id = {(uint32_t)coreDumpSize, checksum, bootCount};
+      prefs.putBytes("dump", &id, sizeof(id));
+    }
+    prefs.putBytes("record", &crash, sizeof(crash));
+    hasCrash = true;
+    LOG_ERROR("Boot %u after %s: task %s, PC 0x%08x", bootCount,
+              resetReasonName(resetReason), crash.task, crash.pc);
+  } else {
+    hasCrash =
+        prefs.getBytes("record", &crash, sizeof(crash)) == sizeof(crash);
+    LOG_INFO("Boot %u after %s", bootCount, resetReasonName(resetReason));
+  }
+  prefs.end();
+  coreDumpBoot = coreDumpSize != 0 ? id.boot : 0;
+}
+
+uint32_t CrashLog::CoreDumpChecksum() const {
+  uint32_t checksum = 0;
+  const esp_partition_t *partition = coreDumpPartition();
+  if (partition != nullptr && coreDumpSize >= sizeof(checksum)) {
+    esp_partition_read(partition, coreDumpSize - sizeof(checksum), &checksum,
+                       sizeof(checksum));
+  }
+  return checksum;
+}
+
+bool CrashLog::CaptureCoreDump() {
+#if CRASH_HAS_COREDUMP
+  esp_core_dump_summary_t summary;
+  if (esp_core_dump_get_summary(&summary) != ESP_OK) {
+    return false;
+  }
+
+  strncpy(crash.task, summary.exc_task, sizeof(crash.task) - 1);
+  crash.pc = summary.exc_pc;
+  crash.depth = summary.exc_bt_info.depth < CRASH_BACKTRACE_DEPTH
+                    ? summary.exc_bt_info.depth
+                    : CRASH_BACKTRACE_DEPTH;
+  for (uint8_t i = 0; i < crash.depth; i++) {
+    crash.backtrace[i] = summary.exc_bt_info.bt[i];
+  }
+  crash.corrupted = summary.exc_bt_info.corrupted;
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+  crash.cause = summary.ex_info.exc_cause;
+  crash.address = summary.ex_info.exc_vaddr;
+#endif
+  strncpy(crash.elfSha, (const char *)summary.app_elf_sha256,
+          CRASH_ELF_SHA_LENGTH);
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint32_t CrashLog::GetCrashCount() const {
+  uint32_t count = 0;
+  for (uint8_t reason = 0; reason < CRASH_RESET_REASONS; reason++) {
+    if (isCrashReason(reason)) {
+      count += resetCounts[reason];
+    }
+  }
+  return count;
+}
+
+size_t CrashLog::ReadCoreDump(size_t offset, uint8_t *buffer,
+                              size_t length) const {
+  const esp_partition_t *partition = coreDumpPartition();
+  if (partition == nullptr || offset >= coreDumpSize) {
+    return 0;
+  }
+  if (length > coreDumpSize - offset) {
+    length = coreDumpSize - offset;
+  }
+  // The image starts at the beginning of the partition
+  if (esp_partition_read(partition, offset, buffer, length) != ESP_OK) {
+    return 0;
+  }
+  return length;
+}
+
+void CrashLog::Clear() {
+  Preferences prefs;
+  prefs.begin("crashlog", false);
+  prefs.remove("record");
+  prefs.remove("dump");
+  prefs.end();
+  hasCrash = false;
+  crash = {};
+  coreDumpSize = 0;
+  coreDumpBoot = 0;
+
+  const esp_partition_t *partition = coreDumpPartition();
+  if (partition != nullptr) {
+    esp_partition_erase_range(partition, 0, partition->size);
+  }
+}
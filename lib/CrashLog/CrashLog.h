@@ -0,0 +1,113 @@
+#ifndef CRASHLOG_H
+#define CRASHLOG_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Crash capture from the coredump partition, and reset statistics
+ * @details On a panic or watchdog reset the IDF writes a core dump to the
+ * `coredump` partition (see filesystem.csv). On the next boot Begin()
+ * extracts its summary (faulting task, PC, exception cause and address,
+ * backtrace) into a compact CrashRecord kept in NVS, and counts the boot
+ * under its reset reason. Each dump is summarised once: its size and
+ * checksum are kept in NVS, so a later reset that writes no dump (most
+ * watchdog resets) doesn't pick up the old one again. The full dump stays
+ * in flash for download until Clear() or the next crash replaces it;
+ * decode either with the firmware's
+ * ELF (`xtensa-esp32-elf-addr2line -pfiaC -e firmware.elf <addresses>` or
+ * `espcoredump.py info_corefile`).
+ */
+#define CRASH_BACKTRACE_DEPTH 16 // Frames kept in the record
+#define CRASH_RESET_REASONS 16   // Counters, indexed by esp_reset_reason_t
+#define CRASH_ELF_SHA_LENGTH 16  // Hex digits of the build's ELF SHA-256
+
+/**
+ * @brief Summary of the last crash
+ */
+struct CrashRecord {
+  uint32_t boot;        // Boot count when the crash was found
+  uint8_t resetReason;  // esp_reset_reason_t of that boot
+  uint8_t depth;        // Frames in backtrace
+  bool corrupted;       // Backtrace stopped at a corrupted frame
+  char task[16];        // Task running when it crashed
+  uint32_t pc;          // Program counter at the exception
+  uint32_t cause;       // EXCCAUSE (Xtensa exception cause)
+  uint32_t address;     // EXCVADDR (faulting data address, if any)
+  uint32_t backtrace[CRASH_BACKTRACE_DEPTH];
+  char elfSha[CRASH_ELF_SHA_LENGTH + 1]; // Build the dump belongs to
+};
+
+/**
+ * @brief Short name of an esp_reset_reason_t value
+ */
+const char *resetReasonName(uint8_t reason);
+
+/**
+ * @brief Name of an Xtensa exception cause, "" if unknown
+ */
+const char *exceptionCauseName(uint32_t cause);
+
+class CrashLog {
+public:
+  /**
+   * @brief Count this boot and capture a pending core dump
+   * @details Call once from setup(). Does two NVS writes, three after
+   * a crash and four if it left a new core dump.
+   */
+  void Begin();
+
+  uint32_t GetBootCount() const { return bootCount; }
+  uint8_t GetResetReason() const { return resetReason; }
+
+  /**
+   * @brief Boots that ended in `reason` (an esp_reset_reason_t)
+   */
+  uint32_t GetResetCount(uint8_t reason) const {
+    return reason < CRASH_RESET_REASONS ? resetCounts[reason] : 0;
+  }
+
+  /**
+   * @brief Boots after a panic or a watchdog reset
+   */
+  uint32_t GetCrashCount() const;
+
+  bool HasCrash() const { return hasCrash; }
+  const CrashRecord &GetCrash() const { return crash; }
+
+  /**
+   * @brief Size of the core dump in flash, 0 if there is none
+   */
+  size_t GetCoreDumpSize() const { return coreDumpSize; }
+
+  /**
+   * @brief Boot that found the core dump in flash, 0 if there is none
+   * @details Older than GetCrash().boot when the last crash left no dump
+   */
+  uint32_t GetCoreDumpBoot() const { return coreDumpBoot; }
+
+  /**
+   * @brief Copy part of the raw core dump, for download in chunks
+   * @return Bytes copied, 0 past the end
+   */
+  size_t ReadCoreDump(size_t offset, uint8_t *buffer, size_t length) const;
+
+  /**
+   * @brief Forget the crash record and erase the core dump
+   * @note Reset counters are kept
+   */
+  void Clear();
+
+private:
+  bool CaptureCoreDump();
+  uint32_t CoreDumpChecksum() const;
+
+  uint32_t bootCount = 0;
+  uint8_t resetReason = 0;
+  uint32_t resetCounts[CRASH_RESET_REASONS] = {};
+  bool hasCrash = false;
+  CrashRecord crash = {};
+  size_t coreDumpSize = 0;
+  uint32_t coreDumpBoot = 0;
+};
+
+#endif // CRASHLOG_H
@@ -0,0 +1,76 @@
+#include "RotaryEncoder.h"
+
+#include <driver/pcnt.h>
+
+void PcntEncoder::Begin() {
+  pcnt_unit_t unit = (pcnt_unit_t)unit_;
+
+  // Channel 0 counts edges on A, using B as direction
+  pcnt_config_t config = {};
+  config.pulse_gpio_num = pin_a_;
+  config.ctrl_gpio_num = pin_b_;
+  config.channel = PCNT_CHANNEL_0;
+  config.unit = unit;
+  config.pos_mode = PCNT_COUNT_DEC;
+  config.neg_mode = PCNT_COUNT_INC;
+  config.lctrl_mode = PCNT_MODE_REVERSE;
+  config.hctrl_mode = PCNT_MODE_KEEP;
+  config.counter_h_lim = ENCODER_PCNT_LIMIT;
+  config.counter_l_lim = -ENCODER_PCNT_LIMIT;
+  pcnt_unit_config(&config);
+
+  // Channel 1 counts edges on B, using A as direction (x4 decoding)
+  config.pulse_gpio_num = pin_b_;
+  config.ctrl_gpio_num = pin_a_;
+  config.channel = PCNT_CHANNEL_1;
+  config.pos_mode = PCNT_COUNT_INC;
+  config.neg_mode = PCNT_COUNT_DEC;
+  pcnt_unit_config(&config);
+
+  pcnt_set_filter_value(unit, ENCODER_FILTER_TICKS);
+  pcnt_filter_enable(unit);
+
+  pcnt_event_enable(unit, PCNT_EVT_H_LIM);
+  pcnt_event_enable(unit, PCNT_EVT_L_LIM);
+  pcnt_counter_pause(unit);
+  pcnt_counter_clear(unit);
+
+  pcnt_isr_service_install(0);
+  pcnt_isr_handler_add(unit, &PcntEncoder::HandleLimit, this);
+  pcnt_intr_enable(unit);
+  pcnt_counter_resume(unit);
+}
+
+int32_t PcntEncoder::ReadCount(uint32_t) {
+  int16_t count;
+  int32_t overflow;
+
+  // Re-read if the limit interrupt fired between the two reads
+  do {
+    overflow = overflow_;
+    pcnt_get_counter_value((pcnt_unit_t)unit_, &count);
+  } while (overflow != overflow_);
+
+  // The counter already wrapped but the interrupt hasn't run yet
+  int32_t total = overflow + count;
+  if (total - last_total_ < -ENCODER_PCNT_LIMIT / 2) {
+    total += ENCODER_PCNT_LIMIT;
+  } else if (total - last_total_ > ENCODER_PCNT_LIMIT / 2) {
+    total -= ENCODER_PCNT_LIMIT;
+  }
+  last_total_ = total;
+  return total;
+}
+
+void PcntEncoder::HandleLimit(void *arg) {
+  PcntEncoder *encoder = static_cast<PcntEncoder *>(arg);
+  uint32_t status = 0;
+  pcnt_get_event_status((pcnt_unit_t)encoder->unit_, &status);
+
+  // The hardware counter resets to zero when it hits a limit
+  if (status & PCNT_EVT_H_LIM) {
+    encoder->overflow_ += ENCODER_PCNT_LIMIT;
+  } else if (status & PCNT_EVT_L_LIM) {
+    encoder->overflow_ -= ENCODER_PCNT_LIMIT;
+  }
+}
@@ -0,0 +1,183 @@
+#ifndef ROTARYENCODER_H
+#define ROTARYENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <InputEvent.h>
+
+// Define ENCODER_A_PIN and ENCODER_B_PIN (e.g. in build_flags) to enable the
+// encoder in main.cpp; its push switch is wired like any other DebounceButton.
+
+#define ENCODER_COUNTS_PER_DETENT 4 // Quadrature counts per mechanical click
+#define ENCODER_PCNT_LIMIT 32000    // Hardware range before folding in software
+#define ENCODER_FILTER_TICKS 1000   // Glitch filter in APB ticks (12.5 us)
+#define ENCODER_ACCEL_MIN_RATE 8    // Detents/s where acceleration starts
+#define ENCODER_ACCEL_MAX_RATE 40   // Detents/s where it reaches the maximum
+#define ENCODER_ACCEL_MAX_STEP 10   // Largest step multiplier
+#define ENCODER_ACCEL_IDLE_MS 250   // Gap after which speed is forgotten
+
+/**
+ * @brief Recorded encoder position, used to replay traces off-target
+ */
+struct EncoderSample {
+  uint32_t time_ms; // Time the count was observed
+  int32_t count;    // Raw quadrature count at that time
+};
+
+/**
+ * @brief Turns detents into step counts based on how fast the knob spins
+ * @details Slow turns move one step per detent. Above ENCODER_ACCEL_MIN_RATE
+ * the multiplier ramps linearly up to ENCODER_ACCEL_MAX_STEP, so long value
+ * adjustments take a flick instead of dozens of clicks.
+ */
+class EncoderAccelerator {
+public:
+  /**
+   * @brief Convert detents seen at `now_ms` into UI steps
+   * @param detents Number of detents since the last call (unsigned)
+   * @param now_ms Current millis()
+   * @return Steps to apply, at least `detents`
+   */
+  uint8_t Apply(uint32_t detents, uint32_t now_ms) {
+    uint32_t elapsed = now_ms - last_ms_;
+    last_ms_ = now_ms;
+
+    if (elapsed < ENCODER_ACCEL_IDLE_MS) {
+      uint32_t rate = detents * 1000 / (elapsed ? elapsed : 1);
+      // Smooth over a few polls so one quick click doesn't jump the value
+      rate_ = (rate_ * 3 + rate) / 4;
+    } else {
+      rate_ = 0; // A pause ends the spin; the next click starts slow
+    }
+
+    uint32_t multiplier = 1;
+    if (rate_ > ENCODER_ACCEL_MIN_RATE) {
+      multiplier += (rate_ - ENCODER_ACCEL_MIN_RATE) *
+                    (ENCODER_ACCEL_MAX_STEP - 1) /
+                    (ENCODER_ACCEL_MAX_RATE - ENCODER_ACCEL_MIN_RATE);
+      if (multiplier > ENCODER_ACCEL_MAX_STEP) {
+        multiplier = ENCODER_ACCEL_MAX_STEP;
+      }
+    }
+
+    uint32_t steps = detents * multiplier;
+    return steps > 255 ? 255 : steps;
+  }
+
+private:
+  uint32_t last_ms_ = 0; // Time of the previous detent batch
+  uint32_t rate_ = 0;    // Smoothed detents per second
+};
+
+/**
+ * @brief Common detent/acceleration logic for any quadrature count source
+ * @details Clockwise turns are reported as UP, counter-clockwise as DOWN,
+ * with InputEvent::steps carrying the accelerated step count.
+ */
+class EncoderSource : public InputSource {
+public:
+  EncoderSource(uint8_t counts_per_detent = ENCODER_COUNTS_PER_DETENT)
+      : counts_per_detent_(counts_per_detent) {}
+
+  bool Poll(uint32_t now_ms, InputEvent &event) override {
+    int32_t moved = ReadCount(now_ms) - consumed_;
+    int32_t detents = moved / counts_per_detent_;
+    if (detents == 0) {
+      return false;
+    }
+    // Keep the remainder so half-turned detents aren't lost
+    consumed_ += detents * counts_per_detent_;
+
+    uint32_t magnitude = detents > 0 ? detents : -detents;
+    event.input = detents > 0 ? UP : DOWN;
+    event.steps = accelerator_.Apply(magnitude, now_ms);
+    event.time_ms = now_ms;
+    return true;
+  }
+
+protected:
+  /**
+   * @brief Current absolute quadrature count
+   * @param now_ms Current millis() (only used by replayed traces)
+   */
+  virtual int32_t ReadCount(uint32_t now_ms) = 0;
+
+private:
+  const uint8_t counts_per_detent_;
+  int32_t consumed_ = 0; // Count already turned into events
+  EncoderAccelerator accelerator_;
+};
+
+/**
+ * @brief Encoder counted by the ESP32 PCNT peripheral
+ * @details Both channels of one PCNT unit decode full x4 quadrature with the
+ * hardware glitch filter on, so detents cost no CPU at all. The only
+ * interrupt is the rare counter-limit event, which folds the 16-bit hardware
+ * count into a 32-bit software total.
+ */
+class PcntEncoder : public EncoderSource {
+public:
+  /**
+   * @brief Constructor
+   * @param pin_a GPIO of the A (CLK) signal
+   * @param pin_b GPIO of the B (DT) signal
+   * @param unit PCNT unit to use (0-7)
+   */
+  PcntEncoder(uint8_t pin_a, uint8_t pin_b, uint8_t unit = 0)
+      : pin_a_(pin_a), pin_b_(pin_b), unit_(unit) {}
+
+  /**
+   * @brief Configure and start the counter (call from setup)
+   */
+  void Begin();
+
+protected:
+  int32_t ReadCount(uint32_t now_ms) override;
+
+private:
+  static void HandleLimit(void *arg);
+
+  const uint8_t pin_a_;
+  const uint8_t pin_b_;
+  const uint8_t unit_;
+  volatile int32_t overflow_ = 0; // Counts folded out of the hardware counter
+  int32_t last_total_ = 0;        // Previous ReadCount() result
+};
+
+/**
+ * @brief Host-side encoder that replays a recorded trace
+ * @details Feed it samples captured from a real knob (or synthesised) and poll
+ * it with simulated time to check detent and acceleration behaviour off-target.
+ */
+class TraceEncoder : public EncoderSource {
+public:
+  /**
+   * @brief Constructor
+   * @param samples Trace sorted by time
+   * @param num_samples Number of samples in the trace
+   */
+  TraceEncoder(const EncoderSample *samples, size_t num_samples,
+               uint8_t counts_per_detent = ENCODER_COUNTS_PER_DETENT)
+      : EncoderSource(counts_per_detent), samples_(samples),
+        num_samples_(num_samples) {}
+
+  // True once every sample has been replayed
+  bool IsDone() const { return next_ >= num_samples_; }
+
+protected:
+  int32_t ReadCount(uint32_t now_ms) override {
+    while (next_ < num_samples_ && samples_[next_].time_ms <= now_ms) {
+      count_ = samples_[next_++].count;
+    }
+    return count_;
+  }
+
+private:
+  const EncoderSample *samples_;
+  const size_t num_samples_;
+  size_t next_ = 0;
+  int32_t count_ = 0;
+};
+
+#endif // ROTARYENCODER_H
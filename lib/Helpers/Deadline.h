@@ -0,0 +1,15 @@
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Whether `now` is at or after `deadline`, both millis() timestamps
+ * @details Compares the signed difference, so it stays right across the
+ * 49-day wrap as long as the two are less than 24 days apart.
+ */
+static inline bool reached(uint32_t now, uint32_t deadline) {
+  return (int32_t)(now - deadline) >= 0;
+}
+
+#endif // DEADLINE_H
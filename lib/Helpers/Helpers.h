@@ -2,7 +2,7 @@
 #define HELPERS
 
 #include <Arduino.h>
-#include <DNSServer.h>
+#include <CaptiveDns.h>
 #include <ESPAsyncWebServer.h>
 #include <Preferences.h>
 #include <U8g2lib.h>
@@ -11,7 +11,6 @@
 // Networking & Server Configuration
 #define MAX_CLIENTS 4   // Maximum number of WiFi clients
 #define WIFI_CHANNEL 6  // WiFi channel for access point
-#define DNS_INTERVAL 30 // DNS server processing interval (ms) to prevent
 const IPAddress localIP(1, 2, 3, 4);           // Local IP address for AP
 const IPAddress gatewayIP(1, 2, 3, 4);         // Gateway IP (same as localIP)
 const IPAddress subnetMask(255, 255, 255, 0);  // Subnet mask
@@ -20,7 +19,7 @@ const char *ssid = "PhytoLabs"; // AP SSID
 const char *password = NULL; // AP password (NULL for open network)
 
 // Web Server and DNS
-DNSServer dnsServer;
+CaptiveDns dnsServer;
 AsyncWebServer server(80);
 
 // Global Variables
@@ -0,0 +1,417 @@
+#include "DigitalSensors.h"
+#include <Deadline.h>
+
+static const char *const kTemperatureHumidityUnits[] = {"°C", "%"};
+
+// DS18B20 function commands
+#define DS18B20_FAMILY 0x28
+#define DS18B20_CONVERT_T 0x44
+#define DS18B20_READ_SCRATCHPAD 0xBE
+#define DS18B20_POWER_ON_VALUE 0x0550 // 85 °C, read before any conversion
+
+// SHT3x commands
+#define SHT3X_CMD_SOFT_RESET 0x30A2
+#define SHT3X_CMD_MEASURE_HIGH 0x2400 // Single shot, no clock stretching
+
+// BME280 registers
+#define BME280_REG_CALIB_T1 0x88
+#define BME280_REG_CALIB_H2 0xE1
+#define BME280_REG_CHIP_ID 0xD0
+#define BME280_REG_CTRL_HUM 0xF2
+#define BME280_REG_CTRL_MEAS 0xF4
+#define BME280_REG_CONFIG 0xF5
+#define BME280_REG_DATA 0xF7
+#define BME280_CHIP_ID 0x60
+#define BME280_CTRL_HUM_X1 0x01
+#define BME280_CTRL_MEAS_FORCED 0x25 // Temperature x1, pressure x1, forced
+
+const char *Dht22::GetUnit(uint8_t channel) const {
+  return channel < 2 ? kTemperatureHumidityUnits[channel] : "";
+}
+
+bool Dht22::Begin() {
+  // Open drain with the input kept enabled, so the line can be pulled low
+  // for the start pulse and the reply seen without touching the pin mode
+  pinMode(pin, INPUT_PULLUP | OUTPUT_OPEN_DRAIN);
+  digitalWrite(pin, HIGH);
+  attachInterruptArg(pin, &Dht22::HandleEdge, this, FALLING);
+
+  esp_timer_create_args_t args = {};
+  args.callback = &Dht22::ReleaseLine;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "dht22";
+  return esp_timer_create(&args, &timer) == ESP_OK;
+}
+
+void Dht22::ReleaseLine(void *arg) {
+  Dht22 *dht = static_cast<Dht22 *>(arg);
+  digitalWrite(dht->pin, HIGH);
+}
+
+void IRAM_ATTR Dht22::HandleEdge(void *arg) {
+  Dht22 *dht = static_cast<Dht22 *>(arg);
+  uint8_t count = dht->edgeCount;
+  if (count < DHT22_EDGES) {
+    dht->edges[count] = micros();
+    dht->edgeCount = count + 1;
+  }
+}
+
+void Dht22::Poll(uint32_t now_ms) {
+  if (timer == nullptr) {
+    return;
+  }
+
+  if (state == kIdle) {
+    if (reached(now_ms, nextStart)) {
+      edgeCount = 0;
+      digitalWrite(pin, LOW);
+      esp_timer_start_once(timer, DHT22_START_US);
+      startedAt = now_ms;
+      state = kReading;
+    }
+    return;
+  }
+
+  if (reached(now_ms, startedAt + DHT22_FRAME_MS)) {
+    Decode();
+    nextStart = startedAt + DHT22_INTERVAL_MS;
+    state = kIdle;
+  }
+}
+
+void Dht22::Decode() {
+  // Each bit is a 50 us low followed by a 26 us (0) or 70 us (1) high, so
+  // the time between falling edges gives the bit. The 40 bits sit between
+  // the last 41 edges; anything before that is the start pulse and the
+  // sensor's response.
+  uint8_t count = edgeCount;
+  if (count < 41) {
+    return;
+  }
+  uint8_t base = count - 41;
+
+  uint8_t data[5] = {};
+  for (uint8_t bit = 0; bit < 40; bit++) {
+    uint32_t period = edges[base + bit + 1] - edges[base + bit];
+    if (period > DHT22_ONE_THRESHOLD_US) {
+      data[bit >> 3] |= 0x80 >> (bit & 7);
+    }
+  }
+  if ((uint8_t)(data[0] + data[1] + data[2] + data[3]) != data[4]) {
+    return;
+  }
+
+  float temperature = (((data[2] & 0x7F) << 8) | data[3]) * 0.1f;
+  values[0] = (data[2] & 0x80) ? -temperature : temperature;
+  values[1] = ((data[0] << 8) | data[1]) * 0.1f;
+  freshMask = 0x03;
+}
+
+bool Dht22::ReadInput(uint8_t channel, float &value) {
+  if (channel >= 2 || !(freshMask & (1 << channel))) {
+    return false;
+  }
+  freshMask &= ~(1 << channel);
+  value = values[channel];
+  return true;
+}
+
+bool Ds18b20::Begin() {
+  bus.Begin();
+  bus.ResetSearch();
+  uint8_t rom[ONEWIRE_ROM_SIZE];
+  uint8_t found = 0; // Devices of any kind
+  while (found < 255 && bus.Search(rom)) {
+    found++;
+    if (numDevices < DS18B20_MAX_DEVICES && rom[0] == DS18B20_FAMILY &&
+        OneWireBus::Crc8(rom, ONEWIRE_ROM_SIZE) == 0) {
+      memcpy(roms[numDevices++], rom, ONEWIRE_ROM_SIZE);
+    }
+  }
+  alone = found == 1 && numDevices == 1;
+  return numDevices > 0;
+}
+
+void Ds18b20::ConfigureInput(uint8_t channel) {
+  if (channel < DS18B20_MAX_DEVICES) {
+    inputMask |= 1 << channel;
+  }
+}
+
+void Ds18b20::Poll(uint32_t now_ms) {
+  switch (state) {
+  case kIdle:
+    if (inputMask == 0 || !reached(now_ms, startedAt + DS18B20_INTERVAL_MS)) {
+      return;
+    }
+    startedAt = now_ms;
+    if (bus.Reset()) {
+      // Every probe converts at once
+      bus.Skip();
+      bus.WriteByte(DS18B20_CONVERT_T);
+      state = kConverting;
+    }
+    return;
+
+  case kConverting:
+    if (!reached(now_ms, startedAt + DS18B20_CONVERSION_MS)) {
+      return;
+    }
+    next = 0;
+    transferred = 0;
+    state = kReading;
+    // Fall through - start on the first probe straight away
+  case kReading:
+    while (next < numDevices && !(inputMask & (1 << next))) {
+      next++;
+    }
+    if (next >= numDevices) {
+      state = kIdle;
+      return;
+    }
+    if (ContinueRead()) {
+      next++;
+    }
+    return;
+  }
+}
+
+bool Ds18b20::ContinueRead() {
+  uint8_t budget = DS18B20_BYTES_PER_POLL;
+  if (transferred == 0) {
+    if (!bus.Reset()) {
+      return true;
+    }
+    budget /= 2; // A reset takes about as long as two bytes
+  }
+
+  const uint8_t *rom = alone ? nullptr : roms[next];
+  uint8_t addressLength = OneWireBus::AddressLength(rom);
+  uint8_t requestLength = addressLength + 1; // Plus READ SCRATCHPAD
+  uint8_t end = requestLength + DS18B20_SCRATCHPAD_SIZE;
+  for (; budget > 0 && transferred < end; budget--, transferred++) {
+    if (transferred < addressLength) {
+      bus.WriteByte(OneWireBus::AddressByte(rom, transferred));
+    } else if (transferred < requestLength) {
+      bus.WriteByte(DS18B20_READ_SCRATCHPAD);
+    } else {
+      scratchpad[transferred - requestLength] = bus.ReadByte();
+    }
+  }
+  if (transferred < end) {
+    return false;
+  }
+  transferred = 0;
+
+  if (OneWireBus::Crc8(scratchpad, DS18B20_SCRATCHPAD_SIZE) != 0) {
+    return true;
+  }
+  // A probe that browned out mid-conversion reports its power-on value
+  int16_t raw = (int16_t)((scratchpad[1] << 8) | scratchpad[0]);
+  if (raw == DS18B20_POWER_ON_VALUE) {
+    return true;
+  }
+  values[next] = raw / 16.0f;
+  freshMask |= 1 << next;
+  return true;
+}
+
+bool Ds18b20::ReadInput(uint8_t channel, float &value) {
+  if (channel >= numDevices || !(freshMask & (1 << channel))) {
+    return false;
+  }
+  freshMask &= ~(1 << channel);
+  value = values[channel];
+  return true;
+}
+
+// Sensirion CRC-8: polynomial 0x31, initial value 0xFF
+static uint8_t sensirionCrc(const uint8_t *data, uint8_t length) {
+  uint8_t crc = 0xFF;
+  while (length--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++) {
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+const char *Sht3x::GetUnit(uint8_t channel) const {
+  return channel < 2 ? kTemperatureHumidityUnits[channel] : "";
+}
+
+bool Sht3x::Begin() {
+  uint8_t command[2] = {SHT3X_CMD_SOFT_RESET >> 8,
+                        SHT3X_CMD_SOFT_RESET & 0xFF};
+  return bus.Write(address, command, sizeof(command));
+}
+
+void Sht3x::Poll(uint32_t now_ms) {
+  if (!measuring) {
+    if (reached(now_ms, nextStart)) {
+      uint8_t command[2] = {SHT3X_CMD_MEASURE_HIGH >> 8,
+                            SHT3X_CMD_MEASURE_HIGH & 0xFF};
+      measuring = bus.Write(address, command, sizeof(command));
+      startedAt = now_ms;
+      nextStart = now_ms + SHT3X_INTERVAL_MS;
+    }
+    return;
+  }
+
+  if (!reached(now_ms, startedAt + SHT3X_MEASURE_MS)) {
+    return;
+  }
+  measuring = false;
+
+  // Temperature and humidity words, each followed by its CRC
+  uint8_t data[6];
+  if (!bus.Read(address, data, sizeof(data)) ||
+      sensirionCrc(data, 2) != data[2] || sensirionCrc(data + 3, 2) != data[5]) {
+    return;
+  }
+  uint16_t rawTemperature = (data[0] << 8) | data[1];
+  uint16_t rawHumidity = (data[3] << 8) | data[4];
+  values[0] = -45.0f + 175.0f * rawTemperature / 65535.0f;
+  values[1] = 100.0f * rawHumidity / 65535.0f;
+  freshMask = 0x03;
+}
+
+bool Sht3x::ReadInput(uint8_t channel, float &value) {
+  if (channel >= 2 || !(freshMask & (1 << channel))) {
+    return false;
+  }
+  freshMask &= ~(1 << channel);
+  value = values[channel];
+  return true;
+}
+
+const char *Bme280::GetUnit(uint8_t channel) const {
+  return channel < 2 ? kTemperatureHumidityUnits[channel]
+                     : (channel == 2 ? "hPa" : "");
+}
+
+bool Bme280::Begin() {
+  uint8_t id;
+  uint8_t t[26];
+  uint8_t h[7];
+  if (!bus.ReadRegisters(address, BME280_REG_CHIP_ID, &id, 1) ||
+      id != BME280_CHIP_ID ||
+      !bus.ReadRegisters(address, BME280_REG_CALIB_T1, t, sizeof(t)) ||
+      !bus.ReadRegisters(address, BME280_REG_CALIB_H2, h, sizeof(h))) {
+    return false;
+  }
+
+  // Little-endian words, layout from the datasheet's calibration table
+  digT1 = t[0] | (t[1] << 8);
+  digT2 = t[2] | (t[3] << 8);
+  digT3 = t[4] | (t[5] << 8);
+  digP1 = t[6] | (t[7] << 8);
+  digP2 = t[8] | (t[9] << 8);
+  digP3 = t[10] | (t[11] << 8);
+  digP4 = t[12] | (t[13] << 8);
+  digP5 = t[14] | (t[15] << 8);
+  digP6 = t[16] | (t[17] << 8);
+  digP7 = t[18] | (t[19] << 8);
+  digP8 = t[20] | (t[21] << 8);
+  digP9 = t[22] | (t[23] << 8);
+  digH1 = t[25];
+  digH2 = h[0] | (h[1] << 8);
+  digH3 = h[2];
+  digH4 = (int16_t)((int8_t)h[3] * 16) | (h[4] & 0x0F);
+  digH5 = (int16_t)((int8_t)h[5] * 16) | (h[4] >> 4);
+  digH6 = (int8_t)h[6];
+
+  // Humidity oversampling only latches on the next ctrl_meas write
+  uint8_t ctrlHum[2] = {BME280_REG_CTRL_HUM, BME280_CTRL_HUM_X1};
+  uint8_t config[2] = {BME280_REG_CONFIG, 0x00}; // No IIR filter
+  present = bus.Write(address, ctrlHum, sizeof(ctrlHum)) &&
+            bus.Write(address, config, sizeof(config));
+  return present;
+}
+
+void Bme280::Poll(uint32_t now_ms) {
+  if (!present) {
+    return;
+  }
+
+  if (!measuring) {
+    if (reached(now_ms, nextStart)) {
+      uint8_t command[2] = {BME280_REG_CTRL_MEAS, BME280_CTRL_MEAS_FORCED};
+      measuring = bus.Write(address, command, sizeof(command));
+      startedAt = now_ms;
+      nextStart = now_ms + BME280_INTERVAL_MS;
+    }
+    return;
+  }
+
+  if (!reached(now_ms, startedAt + BME280_MEASURE_MS)) {
+    return;
+  }
+  measuring = false;
+
+  // Pressure, temperature and humidity in one burst
+  uint8_t data[8];
+  if (bus.ReadRegisters(address, BME280_REG_DATA, data, sizeof(data))) {
+    Compensate(data);
+  }
+}
+
+void Bme280::Compensate(const uint8_t data[8]) {
+  int32_t adcP = (data[0] << 12) | (data[1] << 4) | (data[2] >> 4);
+  int32_t adcT = (data[3] << 12) | (data[4] << 4) | (data[5] >> 4);
+  int32_t adcH = (data[6] << 8) | data[7];
+
+  // Temperature, 0.01 °C (datasheet 4.2.3)
+  int32_t var1 = ((((adcT >> 3) - ((int32_t)digT1 << 1))) * digT2) >> 11;
+  int32_t var2 = (((((adcT >> 4) - (int32_t)digT1) *
+                    ((adcT >> 4) - (int32_t)digT1)) >>
+                   12) *
+                  digT3) >>
+                 14;
+  int32_t tFine = var1 + var2;
+  values[0] = ((tFine * 5 + 128) >> 8) / 100.0f;
+
+  // Pressure, Pa in Q24.8
+  int64_t p1 = (int64_t)tFine - 128000;
+  int64_t p2 = p1 * p1 * digP6;
+  p2 += (p1 * digP5) << 17;
+  p2 += (int64_t)digP4 << 35;
+  p1 = ((p1 * p1 * digP3) >> 8) + ((p1 * digP2) << 12);
+  p1 = ((((int64_t)1) << 47) + p1) * digP1 >> 33;
+  if (p1 != 0) {
+    int64_t p = 1048576 - adcP;
+    p = (((p << 31) - p2) * 3125) / p1;
+    int64_t p3 = ((int64_t)digP9 * (p >> 13) * (p >> 13)) >> 25;
+    int64_t p4 = ((int64_t)digP8 * p) >> 19;
+    p = ((p + p3 + p4) >> 8) + ((int64_t)digP7 << 4);
+    values[2] = (uint32_t)p / 25600.0f; // Q24.8 Pa to hPa
+  }
+
+  // Humidity, %RH in Q22.10
+  int32_t h = tFine - 76800;
+  h = (((((adcH << 14) - ((int32_t)digH4 << 20) - ((int32_t)digH5 * h)) +
+         16384) >>
+        15) *
+       (((((((h * digH6) >> 10) * (((h * (int32_t)digH3) >> 11) + 32768)) >>
+           10) +
+          2097152) *
+             digH2 +
+         8192) >>
+        14));
+  h -= ((((h >> 15) * (h >> 15)) >> 7) * (int32_t)digH1) >> 4;
+  h = h < 0 ? 0 : (h > 419430400 ? 419430400 : h);
+  values[1] = (h >> 12) / 1024.0f;
+  freshMask = 0x07;
+}
+
+bool Bme280::ReadInput(uint8_t channel, float &value) {
+  if (channel >= 3 || !(freshMask & (1 << channel))) {
+    return false;
+  }
+  freshMask &= ~(1 << channel);
+  value = values[channel];
+  return true;
+}
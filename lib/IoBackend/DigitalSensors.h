@@ -0,0 +1,177 @@
+#ifndef DIGITALSENSORS_H
+#define DIGITALSENSORS_H
+
+#include <esp_timer.h>
+
+#include "I2cBus.h"
+#include "IoBackend.h"
+#include "OneWireBus.h"
+
+/**
+ * Drivers for digital temperature / humidity sensors. Their conversions take
+ * 10-750 ms, so none of them waits: each Poll() advances a small state machine
+ * (start a conversion, come back once it's due, collect the result) and
+ * returns. Poll() should run more often than the control tick, see
+ * pollInterval in loop().
+ */
+
+#define DHT22_START_US 1100     // Host start pulse
+#define DHT22_FRAME_MS 10       // Start pulse + response + 40 bits, rounded up
+#define DHT22_INTERVAL_MS 2000  // Sensor can't be read more often
+#define DHT22_EDGES 48          // Falling edges captured per frame
+#define DHT22_ONE_THRESHOLD_US 100 // Bit period above this is a 1
+
+#define DS18B20_MAX_DEVICES 8
+#define DS18B20_CONVERSION_MS 750 // 12-bit resolution
+#define DS18B20_INTERVAL_MS 2000
+#define DS18B20_SCRATCHPAD_SIZE 9
+#define DS18B20_BYTES_PER_POLL 4 // Bus time per Poll() while reading, ~2.4 ms
+
+#define SHT3X_MEASURE_MS 16 // High repeatability single shot
+#define SHT3X_INTERVAL_MS 2000
+
+#define BME280_MEASURE_MS 10 // 1x oversampling on all three
+#define BME280_INTERVAL_MS 1000
+
+/**
+ * @brief DHT22 / AM2302 on one GPIO: channel 0 = °C, channel 1 = %RH
+ * @details A one-shot esp_timer ends the start pulse, then a GPIO interrupt
+ * timestamps the falling edges of the 40-bit reply while the loop carries on.
+ * The next Poll() after the frame decodes the bit periods.
+ */
+class Dht22 : public IoBackend {
+public:
+  explicit Dht22(uint8_t pin) : pin(pin) {}
+
+  const char *GetName() const override { return "DHT22"; }
+  const char *GetUnit(uint8_t channel) const override;
+  bool Begin() override;
+  void Poll(uint32_t now_ms) override;
+  bool ReadInput(uint8_t channel, float &value) override;
+
+private:
+  enum State : uint8_t { kIdle, kReading };
+
+  static void ReleaseLine(void *arg);
+  static void HandleEdge(void *arg);
+  void Decode();
+
+  const uint8_t pin;
+  esp_timer_handle_t timer = nullptr;
+  State state = kIdle;
+  uint32_t startedAt = 0;
+  uint32_t nextStart = 0;
+  volatile uint32_t edges[DHT22_EDGES];
+  volatile uint8_t edgeCount = 0;
+  float values[2] = {};
+  uint8_t freshMask = 0; // Channels with a sample not yet taken
+};
+
+/**
+ * @brief DS18B20 probes sharing one 1-Wire bus; channel n = n-th probe found
+ * by Begin() (ROM order), in °C
+ * @details All probes convert together (SKIP ROM), then the scratchpads are
+ * read DS18B20_BYTES_PER_POLL bytes per Poll(): 1-Wire lets the master pause
+ * between any two slots. A probe alone on the bus is addressed with SKIP ROM
+ * rather than its 8-byte ROM code, so its read takes 11 bytes instead of 19.
+ * A byte takes about 0.6 ms, so no call holds the bus for more than about
+ * 2.5 ms.
+ */
+class Ds18b20 : public IoBackend {
+public:
+  explicit Ds18b20(uint8_t pin) : bus(pin) {}
+
+  const char *GetName() const override { return "DS18B20"; }
+  const char *GetUnit(uint8_t channel) const override { return "°C"; }
+  bool Begin() override;
+  void ConfigureInput(uint8_t channel) override;
+  void Poll(uint32_t now_ms) override;
+  bool ReadInput(uint8_t channel, float &value) override;
+
+  uint8_t GetNumDevices() const { return numDevices; }
+
+private:
+  enum State : uint8_t { kIdle, kConverting, kReading };
+
+  /**
+   * @brief Move the read of probe `next` along by a few bytes
+   * @return true once it is over, whether it succeeded or not
+   */
+  bool ContinueRead();
+
+  OneWireBus bus;
+  uint8_t roms[DS18B20_MAX_DEVICES][ONEWIRE_ROM_SIZE];
+  uint8_t numDevices = 0;
+  bool alone = false; // The only device on the bus, SKIP ROM reaches it
+  uint8_t inputMask = 0; // Probes used by a sensor
+  uint8_t freshMask = 0; // Probes with a sample not yet taken
+  State state = kIdle;
+  uint8_t next = 0;        // Probe being read
+  uint8_t transferred = 0; // Bytes of its read done, 0 before the reset
+  uint8_t scratchpad[DS18B20_SCRATCHPAD_SIZE];
+  uint32_t startedAt = 0;
+  float values[DS18B20_MAX_DEVICES] = {};
+};
+
+/**
+ * @brief Sensirion SHT30/31/35 over I2C: channel 0 = °C, channel 1 = %RH
+ */
+class Sht3x : public IoBackend {
+public:
+  Sht3x(I2cBus &bus, uint8_t address = 0x44) : bus(bus), address(address) {}
+
+  const char *GetName() const override { return "SHT3x"; }
+  const char *GetUnit(uint8_t channel) const override;
+  bool Begin() override;
+  void Poll(uint32_t now_ms) override;
+  bool ReadInput(uint8_t channel, float &value) override;
+
+private:
+  I2cBus &bus;
+  const uint8_t address;
+  bool measuring = false;
+  uint32_t startedAt = 0;
+  uint32_t nextStart = 0;
+  float values[2] = {};
+  uint8_t freshMask = 0;
+};
+
+/**
+ * @brief Bosch BME280 over I2C in forced mode: channel 0 = °C, 1 = %RH,
+ * 2 = hPa
+ * @details Uses the datasheet's integer compensation, so no float maths runs
+ * until the final scaling.
+ */
+class Bme280 : public IoBackend {
+public:
+  Bme280(I2cBus &bus, uint8_t address = 0x76) : bus(bus), address(address) {}
+
+  const char *GetName() const override { return "BME280"; }
+  const char *GetUnit(uint8_t channel) const override;
+  bool Begin() override;
+  void Poll(uint32_t now_ms) override;
+  bool ReadInput(uint8_t channel, float &value) override;
+
+private:
+  void Compensate(const uint8_t data[8]);
+
+  I2cBus &bus;
+  const uint8_t address;
+  bool present = false;
+  bool measuring = false;
+  uint32_t startedAt = 0;
+  uint32_t nextStart = 0;
+  float values[3] = {};
+  uint8_t freshMask = 0;
+
+  // Factory calibration (datasheet names)
+  uint16_t digT1;
+  int16_t digT2, digT3;
+  uint16_t digP1;
+  int16_t digP2, digP3, digP4, digP5, digP6, digP7, digP8, digP9;
+  uint8_t digH1, digH3;
+  int16_t digH2, digH4, digH5;
+  int8_t digH6;
+};
+
+#endif // DIGITALSENSORS_H
@@ -0,0 +1,29 @@
+#include "I2cBus.h"
+
+#include <Wire.h>
+
+bool WireBus::Write(uint8_t address, const uint8_t *data, size_t length) {
+  wire.beginTransmission(address);
+  wire.write(data, length);
+  return wire.endTransmission() == 0;
+}
+
+bool WireBus::Read(uint8_t address, uint8_t *data, size_t length) {
+  if (wire.requestFrom(address, length) != length) {
+    return false;
+  }
+  for (size_t i = 0; i < length; i++) {
+    data[i] = wire.read();
+  }
+  return true;
+}
+
+bool WireBus::ReadRegisters(uint8_t address, uint8_t reg, uint8_t *data,
+                            size_t length) {
+  wire.beginTransmission(address);
+  wire.write(reg);
+  if (wire.endTransmission(false) != 0) {
+    return false;
+  }
+  return Read(address, data, length);
+}
@@ -0,0 +1,52 @@
+#ifndef I2CBUS_H
+#define I2CBUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class TwoWire;
+
+/**
+ * @brief Minimal I2C master interface the expander drivers talk to
+ * @details Every call is one bus transaction, which keeps "one transfer per
+ * device per tick" easy to check with a counting bus (see test/test_io).
+ */
+class I2cBus {
+public:
+  virtual ~I2cBus() {}
+
+  /**
+   * @brief Write `length` bytes to a device
+   * @return false if the device didn't acknowledge
+   */
+  virtual bool Write(uint8_t address, const uint8_t *data, size_t length) = 0;
+
+  /**
+   * @brief Read `length` bytes from a device
+   */
+  virtual bool Read(uint8_t address, uint8_t *data, size_t length) = 0;
+
+  /**
+   * @brief Set the register pointer, then read with a repeated start
+   */
+  virtual bool ReadRegisters(uint8_t address, uint8_t reg, uint8_t *data,
+                             size_t length) = 0;
+};
+
+/**
+ * @brief I2cBus on an Arduino TwoWire port
+ */
+class WireBus : public I2cBus {
+public:
+  explicit WireBus(TwoWire &wire) : wire(wire) {}
+
+  bool Write(uint8_t address, const uint8_t *data, size_t length) override;
+  bool Read(uint8_t address, uint8_t *data, size_t length) override;
+  bool ReadRegisters(uint8_t address, uint8_t reg, uint8_t *data,
+                     size_t length) override;
+
+private:
+  TwoWire &wire;
+};
+
+#endif // I2CBUS_H
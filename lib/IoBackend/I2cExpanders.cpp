@@ -0,0 +1,206 @@
+#include "I2cExpanders.h"
+#include <Deadline.h>
+
+// ADS1115 registers and config fields
+#define ADS1115_REG_CONVERSION 0x00
+#define ADS1115_REG_CONFIG 0x01
+#define ADS1115_CONFIG_START 0x8000  // OS: start a single conversion
+#define ADS1115_CONFIG_MUX_AIN0 0x4000 // AINx against GND, x in bits 13:12
+#define ADS1115_CONFIG_PGA_4V 0x0200   // +/-4.096 V full scale
+#define ADS1115_CONFIG_SINGLE 0x0100   // Power down after each conversion
+#define ADS1115_CONFIG_860SPS 0x00E0
+#define ADS1115_CONFIG_NO_COMP 0x0003  // Comparator off
+#define ADS1115_VOLTS_PER_LSB (4.096f / 32768.0f)
+
+// MCP23017 registers (IOCON.BANK = 0, so A/B pairs are adjacent)
+#define MCP23017_REG_IODIRA 0x00
+#define MCP23017_REG_GPIOA 0x12
+#define MCP23017_REG_OLATA 0x14
+
+bool Ads1115::Begin() {
+  uint8_t config[2];
+  return bus.ReadRegisters(address, ADS1115_REG_CONFIG, config, 2);
+}
+
+void Ads1115::ConfigureInput(uint8_t channel) {
+  if (channel < ADS1115_CHANNELS) {
+    inputMask |= 1 << channel;
+  }
+}
+
+bool Ads1115::StartConversion(uint8_t channel) {
+  uint16_t config = ADS1115_CONFIG_START | ADS1115_CONFIG_MUX_AIN0 |
+                    (channel << 12) | ADS1115_CONFIG_PGA_4V |
+                    ADS1115_CONFIG_SINGLE | ADS1115_CONFIG_860SPS |
+                    ADS1115_CONFIG_NO_COMP;
+  uint8_t data[3] = {ADS1115_REG_CONFIG, (uint8_t)(config >> 8),
+                     (uint8_t)config};
+  return bus.Write(address, data, sizeof(data));
+}
+
+void Ads1115::Poll(uint32_t now_ms) {
+  if (inputMask == 0) {
+    return;
+  }
+
+  uint8_t next = 0;
+  if (converting >= 0) {
+    if (!reached(now_ms, startedAt + ADS1115_CONVERSION_MS)) {
+      return; // Polled faster than the converter, try again next time
+    }
+    uint8_t data[2];
+    if (bus.ReadRegisters(address, ADS1115_REG_CONVERSION, data, 2)) {
+      int16_t raw = (int16_t)((data[0] << 8) | data[1]);
+      values[converting] = raw * ADS1115_VOLTS_PER_LSB;
+      freshMask |= 1 << converting;
+    }
+    next = converting + 1;
+  }
+
+  // Next channel in use after the one just read
+  for (uint8_t i = 0; i < ADS1115_CHANNELS; i++) {
+    uint8_t channel = (next + i) % ADS1115_CHANNELS;
+    if (inputMask & (1 << channel)) {
+      converting = StartConversion(channel) ? channel : -1;
+      startedAt = now_ms;
+      return;
+    }
+  }
+}
+
+bool Ads1115::ReadInput(uint8_t channel, float &value) {
+  if (channel >= ADS1115_CHANNELS || !(freshMask & (1 << channel))) {
+    return false;
+  }
+  freshMask &= ~(1 << channel);
+  value = values[channel];
+  return true;
+}
+
+bool Mcp23017::Begin() {
+  uint8_t data[2];
+  bool present = bus.ReadRegisters(address, MCP23017_REG_IODIRA, data, 2);
+  // Push whatever was configured before the device was probed
+  directionDirty = latchDirty = true;
+  Flush();
+  return present;
+}
+
+void Mcp23017::ConfigureInput(uint8_t channel) {
+  if (channel < MCP23017_CHANNELS) {
+    direction |= 1 << channel;
+    inputMask |= 1 << channel;
+    directionDirty = true;
+  }
+}
+
+void Mcp23017::ConfigureOutput(uint8_t channel) {
+  if (channel < MCP23017_CHANNELS) {
+    direction &= ~(1 << channel);
+    inputMask &= ~(1 << channel);
+    latch &= ~(1 << channel);
+    directionDirty = latchDirty = true;
+  }
+}
+
+void Mcp23017::Poll(uint32_t now_ms) {
+  if (inputMask == 0) {
+    return;
+  }
+  uint8_t data[2];
+  if (bus.ReadRegisters(address, MCP23017_REG_GPIOA, data, 2)) {
+    inputs = data[0] | (data[1] << 8);
+    freshMask = inputMask;
+  }
+}
+
+bool Mcp23017::ReadInput(uint8_t channel, float &value) {
+  if (channel >= MCP23017_CHANNELS || !(freshMask & (1 << channel))) {
+    return false;
+  }
+  freshMask &= ~(1 << channel);
+  value = (inputs >> channel) & 1;
+  return true;
+}
+
+void Mcp23017::WriteOutput(uint8_t channel, bool on) {
+  if (channel >= MCP23017_CHANNELS) {
+    return;
+  }
+  uint16_t bit = 1 << channel;
+  uint16_t updated = on ? (latch | bit) : (latch & ~bit);
+  if (updated != latch) {
+    latch = updated;
+    latchDirty = true;
+  }
+}
+
+void Mcp23017::Flush() {
+  // Latch first so new outputs never glitch on with a stale level
+  if (latchDirty) {
+    uint8_t data[3] = {MCP23017_REG_OLATA, (uint8_t)latch,
+                       (uint8_t)(latch >> 8)};
+    latchDirty = !bus.Write(address, data, sizeof(data));
+  }
+  if (directionDirty) {
+    uint8_t data[3] = {MCP23017_REG_IODIRA, (uint8_t)direction,
+                       (uint8_t)(direction >> 8)};
+    directionDirty = !bus.Write(address, data, sizeof(data));
+  }
+}
+
+bool Pcf8574::Begin() {
+  dirty = true;
+  Flush();
+  return !dirty;
+}
+
+void Pcf8574::ConfigureInput(uint8_t channel) {
+  if (channel < PCF8574_CHANNELS) {
+    inputMask |= 1 << channel;
+    dirty = true;
+  }
+}
+
+void Pcf8574::ConfigureOutput(uint8_t channel) {
+  if (channel < PCF8574_CHANNELS) {
+    inputMask &= ~(1 << channel);
+    latch &= ~(1 << channel);
+    dirty = true;
+  }
+}
+
+void Pcf8574::Poll(uint32_t now_ms) {
+  if (inputMask != 0 && bus.Read(address, &inputs, 1)) {
+    freshMask = inputMask;
+  }
+}
+
+bool Pcf8574::ReadInput(uint8_t channel, float &value) {
+  if (channel >= PCF8574_CHANNELS || !(freshMask & (1 << channel))) {
+    return false;
+  }
+  freshMask &= ~(1 << channel);
+  value = (inputs >> channel) & 1;
+  return true;
+}
+
+void Pcf8574::WriteOutput(uint8_t channel, bool on) {
+  if (channel >= PCF8574_CHANNELS) {
+    return;
+  }
+  uint8_t bit = 1 << channel;
+  uint8_t updated = on ? (latch | bit) : (latch & ~bit);
+  if (updated != latch) {
+    latch = updated;
+    dirty = true;
+  }
+}
+
+void Pcf8574::Flush() {
+  if (dirty) {
+    // Inputs must be driven high (weak pull-up) to be readable
+    uint8_t port = latch | inputMask;
+    dirty = !bus.Write(address, &port, 1);
+  }
+}
@@ -0,0 +1,108 @@
+#ifndef I2CEXPANDERS_H
+#define I2CEXPANDERS_H
+
+#include "I2cBus.h"
+#include "IoBackend.h"
+
+#define ADS1115_CHANNELS 4
+#define ADS1115_CONVERSION_MS 2 // One single-shot conversion at 860 SPS
+#define ADS1115_FULL_SCALE 4.095f // Volts, one LSB short of the PGA range
+#define MCP23017_CHANNELS 16
+#define PCF8574_CHANNELS 8
+
+/**
+ * @brief ADS1115 16-bit ADC, single-ended channels 0-3, read in volts
+ * @details The chip has a single converter behind a multiplexer, so the
+ * channels can't be sampled in one transfer. Instead Poll() runs a
+ * non-blocking round robin: it collects the conversion started on the
+ * previous tick and starts the next configured channel, costing one read and
+ * one write per tick and never waiting on the bus.
+ */
+class Ads1115 : public IoBackend {
+public:
+  Ads1115(I2cBus &bus, uint8_t address = 0x48) : bus(bus), address(address) {}
+
+  const char *GetName() const override { return "ADS1115"; }
+  const char *GetUnit(uint8_t channel) const override { return "V"; }
+  bool Begin() override;
+  void ConfigureInput(uint8_t channel) override;
+  void Poll(uint32_t now_ms) override;
+  bool ReadInput(uint8_t channel, float &value) override;
+
+  bool IsAtRail(uint8_t channel, float value) const override {
+    return value >= ADS1115_FULL_SCALE || value <= -ADS1115_FULL_SCALE;
+  }
+
+private:
+  bool StartConversion(uint8_t channel);
+
+  I2cBus &bus;
+  const uint8_t address;
+  uint8_t inputMask = 0;     // Channels in use
+  uint8_t freshMask = 0;     // Channels with a sample not yet taken
+  int8_t converting = -1;    // Channel being converted, -1 if idle
+  uint32_t startedAt = 0;    // millis() the conversion was started
+  float values[ADS1115_CHANNELS] = {};
+};
+
+/**
+ * @brief MCP23017 16-bit GPIO expander (channels 0-15 = GPA0..GPB7)
+ * @details Outputs are kept in a shadow latch and written to OLATA/OLATB in
+ * one transfer by Flush(), only when something changed. Inputs are read from
+ * GPIOA/GPIOB in one transfer per Poll() and report 0 or 1.
+ */
+class Mcp23017 : public IoBackend {
+public:
+  Mcp23017(I2cBus &bus, uint8_t address = 0x20) : bus(bus), address(address) {}
+
+  const char *GetName() const override { return "MCP23017"; }
+  bool Begin() override;
+  void ConfigureInput(uint8_t channel) override;
+  void ConfigureOutput(uint8_t channel) override;
+  void Poll(uint32_t now_ms) override;
+  bool ReadInput(uint8_t channel, float &value) override;
+  void WriteOutput(uint8_t channel, bool on) override;
+  void Flush() override;
+
+private:
+  I2cBus &bus;
+  const uint8_t address;
+  uint16_t direction = 0xFFFF; // IODIR, 1 = input (power-on default)
+  uint16_t inputMask = 0;      // Channels used as sensor inputs
+  uint16_t latch = 0;          // OLAT shadow
+  uint16_t inputs = 0;         // Last GPIO read
+  uint16_t freshMask = 0;      // Inputs read but not yet taken
+  bool directionDirty = false;
+  bool latchDirty = false;
+};
+
+/**
+ * @brief PCF8574 8-bit quasi-bidirectional expander (channels 0-7)
+ * @details The whole port is one byte: Flush() writes outputs (with input
+ * bits held high so they can be read) and Poll() reads it back, one transfer
+ * each.
+ */
+class Pcf8574 : public IoBackend {
+public:
+  Pcf8574(I2cBus &bus, uint8_t address = 0x27) : bus(bus), address(address) {}
+
+  const char *GetName() const override { return "PCF8574"; }
+  bool Begin() override;
+  void ConfigureInput(uint8_t channel) override;
+  void ConfigureOutput(uint8_t channel) override;
+  void Poll(uint32_t now_ms) override;
+  bool ReadInput(uint8_t channel, float &value) override;
+  void WriteOutput(uint8_t channel, bool on) override;
+  void Flush() override;
+
+private:
+  I2cBus &bus;
+  const uint8_t address;
+  uint8_t inputMask = 0; // Bits used as inputs
+  uint8_t latch = 0;     // Output bits
+  uint8_t inputs = 0;    // Last port read
+  uint8_t freshMask = 0; // Inputs read but not yet taken
+  bool dirty = true;
+};
+
+#endif // I2CEXPANDERS_H
@@ -0,0 +1,215 @@
+#ifndef IOBACKEND_H
+#define IOBACKEND_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Fixed backend ids, stored with each sensor and relay ("io" in the
+ * config JSON) so saved configs keep pointing at the same hardware
+ */
+#define IO_NATIVE 0   // ESP32 GPIO / ADC
+#define IO_ADS1115 1  // 4 channel 16-bit ADC
+#define IO_MCP23017 2 // 16 bit GPIO expander
+#define IO_PCF8574 3  // 8 bit GPIO expander
+#define IO_DHT22 4    // Temperature / humidity, single-wire
+#define IO_DS18B20 5  // Temperature probes on a 1-Wire bus
+#define IO_SHT3X 6    // Temperature / humidity over I2C
+#define IO_BME280 7   // Temperature / humidity / pressure over I2C
+#define MAX_IO_BACKENDS 8
+
+#define NATIVE_PWM_CHANNELS 16 // LEDC channels on the ESP32
+#define NATIVE_PWM_BITS 10     // Duty resolution, fine up to ~78 kHz
+
+/**
+ * @brief Where sensors are read from and relays are written to
+ * @details The loop calls Poll() on every sensor poll and then reads every
+ * input with ReadInput(). Poll() must never wait on the hardware: slow
+ * sensors start a conversion on one call and collect it on a later one.
+ * After evaluating the relays the loop calls WriteOutput() for the ones that
+ * switched followed by one Flush(). Bus backends refresh all their inputs in
+ * Poll() and push all their outputs in Flush(), so each device costs at most
+ * one transfer each way per poll.
+ */
+class IoBackend {
+public:
+  virtual ~IoBackend() {}
+
+  // Short name for the web UI
+  virtual const char *GetName() const = 0;
+
+  // Unit of the values an input channel reports, "" if unitless
+  virtual const char *GetUnit(uint8_t channel) const { return ""; }
+
+  /**
+   * @brief Probe and initialise the hardware (call from setup)
+   * @return false if the device didn't answer
+   */
+  virtual bool Begin() { return true; }
+
+  /**
+   * @brief Make `channel` an input (called when a sensor is registered)
+   */
+  virtual void ConfigureInput(uint8_t channel) {}
+
+  /**
+   * @brief Make `channel` an output, initially off (called when a relay is
+   * registered)
+   */
+  virtual void ConfigureOutput(uint8_t channel) {}
+
+  /**
+   * @brief Make `channel` a PWM output at `frequency` Hz, initially at 0
+   * @return false if the backend (or the channel) can't do hardware PWM
+   */
+  virtual bool ConfigurePwm(uint8_t channel, uint32_t frequency) {
+    return false;
+  }
+
+  /**
+   * @brief Advance input acquisition without blocking
+   * @param now_ms Current millis()
+   */
+  virtual void Poll(uint32_t now_ms) {}
+
+  /**
+   * @brief Take the latest sample of an input channel
+   * @return false if the channel has no new sample since the last call, so
+   * filters only ever see each sample once
+   */
+  virtual bool ReadInput(uint8_t channel, float &value) { return false; }
+
+  /**
+   * @brief Whether a reading sits at the end of the channel's measurable
+   * range, i.e. the real signal may be beyond it (used for clip detection)
+   */
+  virtual bool IsAtRail(uint8_t channel, float value) const { return false; }
+
+  /**
+   * @brief Set an output channel; may be buffered until Flush()
+   */
+  virtual void WriteOutput(uint8_t channel, bool on) {}
+
+  /**
+   * @brief Set the duty (0-1) of a channel set up with ConfigurePwm()
+   */
+  virtual void WriteDuty(uint8_t channel, float duty) {}
+
+  /**
+   * @brief Push buffered outputs to the hardware
+   */
+  virtual void Flush() {}
+};
+
+/**
+ * @brief The ESP32's own pins: analogRead() inputs, digitalWrite() outputs
+ * and LEDC PWM outputs
+ */
+class NativeIo : public IoBackend {
+public:
+  NativeIo() {
+    for (int i = 0; i < NATIVE_PWM_CHANNELS; i++) {
+      pwmPins[i] = NO_PWM_PIN;
+    }
+  }
+
+  const char *GetName() const override { return "ESP32"; }
+  const char *GetUnit(uint8_t channel) const override { return "V"; }
+
+  void ConfigureInput(uint8_t channel) override {
+    ReleasePwm(channel);
+    pinMode(channel, INPUT);
+  }
+
+  void ConfigureOutput(uint8_t channel) override {
+    ReleasePwm(channel);
+    pinMode(channel, OUTPUT);
+    digitalWrite(channel, LOW);
+  }
+
+  bool ConfigurePwm(uint8_t channel, uint32_t frequency) override {
+    int8_t slot = FindPwm(channel);
+    if (slot < 0) {
+      slot = FindPwm(NO_PWM_PIN);
+      if (slot < 0) {
+        return false; // Every LEDC channel is taken
+      }
+    }
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    if (pwmPins[slot] == channel) {
+      ledcDetach(channel);
+    }
+    if (!ledcAttach(channel, frequency, NATIVE_PWM_BITS)) {
+      pwmPins[slot] = NO_PWM_PIN;
+      return false;
+    }
+#else
+    if (ledcSetup(slot, frequency, NATIVE_PWM_BITS) == 0) {
+      return false; // Frequency out of reach at this resolution
+    }
+    ledcAttachPin(channel, slot);
+#endif
+    pwmPins[slot] = channel;
+    WriteDuty(channel, 0.0f);
+    return true;
+  }
+
+  bool ReadInput(uint8_t channel, float &value) override {
+    // Millivolts corrected with the ADC characterisation burned into eFuse
+    // (falls back to the nominal curve on chips without it)
+    value = analogReadMilliVolts(channel) * 0.001f;
+    return true;
+  }
+
+  bool IsAtRail(uint8_t channel, float value) const override {
+    // The ADC bottoms out around 0.1 V and saturates a little above 3.1 V at
+    // the default 11 dB attenuation
+    return value <= 0.1f || value >= 3.1f;
+  }
+
+  void WriteOutput(uint8_t channel, bool on) override {
+    digitalWrite(channel, on ? HIGH : LOW);
+  }
+
+  void WriteDuty(uint8_t channel, float duty) override {
+    uint32_t value = duty * ((1 << NATIVE_PWM_BITS) - 1) + 0.5f;
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    ledcWrite(channel, value);
+#else
+    int8_t slot = FindPwm(channel);
+    if (slot >= 0) {
+      ledcWrite(slot, value);
+    }
+#endif
+  }
+
+private:
+  static const uint8_t NO_PWM_PIN = 0xFF;
+
+  // LEDC channel driving a pin, -1 if none
+  int8_t FindPwm(uint8_t pin) const {
+    for (int i = 0; i < NATIVE_PWM_CHANNELS; i++) {
+      if (pwmPins[i] == pin) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // Hand a pin back to the GPIO matrix after it was a PWM output
+  void ReleasePwm(uint8_t pin) {
+    int8_t slot = FindPwm(pin);
+    if (slot < 0) {
+      return;
+    }
+#if defined(ESP_ARDUINO_VERSION_MAJOR) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    ledcDetach(pin);
+#else
+    ledcDetachPin(pin);
+#endif
+    pwmPins[slot] = NO_PWM_PIN;
+  }
+
+  uint8_t pwmPins[NATIVE_PWM_CHANNELS]; // Pin on each LEDC channel
+};
+
+#endif // IOBACKEND_H
@@ -0,0 +1,154 @@
+#include "OneWireBus.h"
+
+// ROM commands
+#define ONEWIRE_SEARCH_ROM 0xF0
+#define ONEWIRE_MATCH_ROM 0x55
+#define ONEWIRE_SKIP_ROM 0xCC
+
+void OneWireBus::Begin() {
+  // Open drain with the input kept enabled: HIGH releases the line to the
+  // pull-up, LOW drives it, and digitalRead() sees the bus either way
+  pinMode(pin, INPUT | OUTPUT_OPEN_DRAIN);
+  digitalWrite(pin, HIGH);
+}
+
+bool OneWireBus::Reset() {
+  // Holding the line low longer than 480 us is harmless, so only the
+  // presence sample needs interrupts off
+  digitalWrite(pin, LOW);
+  delayMicroseconds(480);
+  portENTER_CRITICAL(&mux);
+  digitalWrite(pin, HIGH);
+  delayMicroseconds(70);
+  bool present = digitalRead(pin) == LOW;
+  portEXIT_CRITICAL(&mux);
+  delayMicroseconds(410);
+  return present;
+}
+
+void OneWireBus::WriteBit(bool bit) {
+  portENTER_CRITICAL(&mux);
+  digitalWrite(pin, LOW);
+  delayMicroseconds(bit ? 6 : 60);
+  digitalWrite(pin, HIGH);
+  portEXIT_CRITICAL(&mux);
+  delayMicroseconds(bit ? 64 : 10);
+}
+
+bool OneWireBus::ReadBit() {
+  portENTER_CRITICAL(&mux);
+  digitalWrite(pin, LOW);
+  delayMicroseconds(3);
+  digitalWrite(pin, HIGH);
+  delayMicroseconds(10);
+  bool bit = digitalRead(pin) == HIGH;
+  portEXIT_CRITICAL(&mux);
+  delayMicroseconds(53);
+  return bit;
+}
+
+void OneWireBus::WriteByte(uint8_t value) {
+  for (uint8_t i = 0; i < 8; i++) {
+    WriteBit(value & (1 << i)); // LSB first
+  }
+}
+
+uint8_t OneWireBus::ReadByte() {
+  uint8_t value = 0;
+  for (uint8_t i = 0; i < 8; i++) {
+    if (ReadBit()) {
+      value |= 1 << i;
+    }
+  }
+  return value;
+}
+
+void OneWireBus::Skip() { WriteByte(ONEWIRE_SKIP_ROM); }
+
+void OneWireBus::Select(const uint8_t rom[ONEWIRE_ROM_SIZE]) {
+  WriteByte(ONEWIRE_MATCH_ROM);
+  for (uint8_t i = 0; i < ONEWIRE_ROM_SIZE; i++) {
+    WriteByte(rom[i]);
+  }
+}
+
+uint8_t OneWireBus::AddressByte(const uint8_t *rom, uint8_t index) {
+  if (rom == nullptr) {
+    return ONEWIRE_SKIP_ROM;
+  }
+  return index == 0 ? ONEWIRE_MATCH_ROM : rom[index - 1];
+}
+
+void OneWireBus::ResetSearch() {
+  lastDiscrepancy = -1;
+  lastDevice = false;
+  memset(searchRom, 0, sizeof(searchRom));
+}
+
+bool OneWireBus::Search(uint8_t rom[ONEWIRE_ROM_SIZE]) {
+  if (lastDevice) {
+    return false;
+  }
+  if (!Reset()) {
+    ResetSearch();
+    return false;
+  }
+  WriteByte(ONEWIRE_SEARCH_ROM);
+
+  // Walk the ROM tree one bit at a time. Where devices disagree, take the 0
+  // branch first and remember the deepest such fork so the next call can
+  // take its 1 branch instead.
+  int8_t discrepancy = -1;
+  for (int8_t bit = 0; bit < ONEWIRE_ROM_SIZE * 8; bit++) {
+    bool idBit = ReadBit();
+    bool complement = ReadBit();
+    if (idBit && complement) {
+      ResetSearch(); // Nobody answered
+      return false;
+    }
+
+    uint8_t &byte = searchRom[bit >> 3];
+    uint8_t mask = 1 << (bit & 7);
+    bool direction;
+    if (idBit != complement) {
+      direction = idBit;
+    } else {
+      if (bit < lastDiscrepancy) {
+        direction = byte & mask; // Same path as last time
+      } else {
+        direction = bit == lastDiscrepancy;
+      }
+      if (!direction) {
+        discrepancy = bit;
+      }
+    }
+
+    if (direction) {
+      byte |= mask;
+    } else {
+      byte &= ~mask;
+    }
+    WriteBit(direction);
+  }
+
+  lastDiscrepancy = discrepancy;
+  lastDevice = discrepancy < 0;
+  memcpy(rom, searchRom, ONEWIRE_ROM_SIZE);
+  return true;
+}
+
+uint8_t OneWireBus::Crc8(const uint8_t *data, uint8_t length) {
+  uint8_t crc = 0;
+  while (length--) {
+    uint8_t byte = *data++;
+    for (uint8_t i = 0; i < 8; i++) {
+      bool mix = (crc ^ byte) & 1;
+      crc >>= 1;
+      if (mix) {
+        crc ^= 0x8C;
+      }
+      byte >>= 1;
+    }
+  }
+  return crc;
+}
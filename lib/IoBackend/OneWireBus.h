@@ -0,0 +1,71 @@
+#ifndef ONEWIREBUS_H
+#define ONEWIREBUS_H
+
+#include <Arduino.h>
+
+#define ONEWIRE_ROM_SIZE 8
+
+/**
+ * @brief Bit-banged 1-Wire master on one open-drain GPIO (external pull-up)
+ * @details Each bit slot is timed inside a short critical section (~70 us),
+ * so interrupts are never held off for longer than one slot. A reset takes
+ * about 1 ms and a byte about 0.6 ms.
+ */
+class OneWireBus {
+public:
+  explicit OneWireBus(uint8_t pin) : pin(pin) {}
+
+  /**
+   * @brief Configure the pin and release the bus
+   */
+  void Begin();
+
+  /**
+   * @brief Reset pulse
+   * @return true if at least one device answered with a presence pulse
+   */
+  bool Reset();
+
+  void WriteByte(uint8_t value);
+  uint8_t ReadByte();
+
+  // Address every device (SKIP ROM) or a single one (MATCH ROM)
+  void Skip();
+  void Select(const uint8_t rom[ONEWIRE_ROM_SIZE]);
+
+  /**
+   * @brief Byte `index` of what Select(rom), or Skip() for a null `rom`,
+   * sends; for callers that spread a transaction over several calls
+   */
+  static uint8_t AddressByte(const uint8_t *rom, uint8_t index);
+  static uint8_t AddressLength(const uint8_t *rom) {
+    return rom ? 1 + ONEWIRE_ROM_SIZE : 1;
+  }
+
+  /**
+   * @brief Find the next device on the bus (SEARCH ROM)
+   * @param rom Filled with the device's ROM code
+   * @return false once every device has been found
+   */
+  bool Search(uint8_t rom[ONEWIRE_ROM_SIZE]);
+  void ResetSearch();
+
+  /**
+   * @brief Dallas/Maxim CRC-8, 0 when run over data followed by its CRC
+   */
+  static uint8_t Crc8(const uint8_t *data, uint8_t length);
+
+private:
+  void WriteBit(bool bit);
+  bool ReadBit();
+
+  const uint8_t pin;
+  portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+  // Search state, kept between Search() calls
+  uint8_t searchRom[ONEWIRE_ROM_SIZE] = {};
+  int8_t lastDiscrepancy = -1;
+  bool lastDevice = false;
+};
+
+#endif // ONEWIREBUS_H
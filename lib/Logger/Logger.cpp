@@ -0,0 +1,142 @@
+#include "Logger.h"
+#include "MpscRing.h"
+
+static MpscRing<LogRecord, LOG_RING_SIZE> ring;
+static std::atomic<uint32_t> droppedRecords{0};
+static std::atomic<Print *> logSink{&Serial};
+static TaskHandle_t logTask = nullptr;
+
+static const char levelLetters[] = "-EWID";
+
+/**
+ * @brief Expand one record into a line: walk the format string and hand
+ * each conversion, with its own flags and width, to snprintf
+ */
+static void FormatRecord(const LogRecord &record, Print &out) {
+  out.printf("[%lu.%03lu] %c ", (unsigned long)(record.timeMs / 1000),
+             (unsigned long)(record.timeMs % 1000),
+             levelLetters[record.level <= LOG_LEVEL_DEBUG ? record.level : 0]);
+
+  const char *p = record.format;
+  uint8_t next = 0;
+  char spec[16];
+  char text[32];
+  while (*p) {
+    if (*p != '%') {
+      const char *start = p;
+      while (*p && *p != '%') {
+        p++;
+      }
+      out.write((const uint8_t *)start, p - start);
+      continue;
+    }
+    if (p[1] == '%') {
+      out.write('%');
+      p += 2;
+      continue;
+    }
+
+    // Flags, width and precision are kept; length modifiers are dropped
+    // since every argument was widened or narrowed to 32 bits anyway
+    size_t length = 0;
+    spec[length++] = *p++;
+    while (*p && !strchr("diouxXcsfFeEgGp", *p)) {
+      if (!strchr("hlLqjzt", *p) && length < sizeof(spec) - 2) {
+        spec[length++] = *p;
+      }
+      p++;
+    }
+    if (!*p) {
+      break;
+    }
+    char conversion = *p++;
+    spec[length++] = conversion;
+    spec[length] = '\0';
+
+    uintptr_t word = next < record.argc ? record.args[next++] : 0;
+    switch (conversion) {
+    case 's': {
+      const char *str = (const char *)word;
+      out.print(str ? str : "(null)");
+      continue;
+    }
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G': {
+      uint32_t bits = word;
+      float value;
+      memcpy(&value, &bits, sizeof(value));
+      snprintf(text, sizeof(text), spec, (double)value);
+      break;
+    }
+    case 'p':
+      snprintf(text, sizeof(text), spec, (void *)word);
+      break;
+    case 'd':
+    case 'i':
+      snprintf(text, sizeof(text), spec, (int)word);
+      break;
+    default:
+      snprintf(text, sizeof(text), spec, (unsigned)word);
+      break;
+    }
+    out.print(text);
+  }
+  out.println();
+}
+
+static void LogTask(void *) {
+  LogRecord record;
+  uint32_t reported = 0;
+  for (;;) {
+    Print &out = *logSink.load(std::memory_order_relaxed);
+    while (ring.Pop(record)) {
+      FormatRecord(record, out);
+    }
+    uint32_t dropped = droppedRecords.load(std::memory_order_relaxed);
+    if (dropped != reported) {
+      out.printf("[log] %lu records dropped\n",
+                 (unsigned long)(dropped - reported));
+      reported = dropped;
+    }
+    vTaskDelay(pdMS_TO_TICKS(LOG_FLUSH_MS));
+  }
+}
+
+bool Logger::Begin(Print &sink) {
+  SetSink(sink);
+  if (logTask) {
+    return true;
+  }
+  return xTaskCreatePinnedToCore(LogTask, "log", LOG_TASK_STACK, nullptr,
+                                 LOG_TASK_PRIORITY, &logTask,
+                                 LOG_TASK_CORE) == pdPASS;
+}
+
+void Logger::SetSink(Print &sink) {
+  logSink.store(&sink, std::memory_order_relaxed);
+}
+
+bool Logger::Write(uint8_t level, const char *format, uint8_t argc,
+                   const uintptr_t *args) {
+  LogRecord record;
+  record.format = format;
+  record.timeMs = millis();
+  record.level = level;
+  record.argc = argc;
+  for (uint8_t i = 0; i < argc; i++) {
+    record.args[i] = args[i];
+  }
+  if (!ring.Push(record)) {
+    droppedRecords.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+uint32_t Logger::GetDropped() {
+  return droppedRecords.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,120 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include <string.h>
+
+/**
+ * @brief Deferred logging: log sites only queue a compact binary record,
+ * a low-priority task formats it and writes it out
+ * @details A record is the format string's address (the literal stays in
+ * flash, so it doubles as the message id), a timestamp and up to
+ * LOG_MAX_ARGS raw 32-bit (pointer-sized) arguments. Queuing one costs a few dozen cycles
+ * and never blocks, where a Serial.println() at 115200 baud stalls the
+ * caller for about 87 us per character once the UART FIFO is full.
+ *
+ * Levels are filtered at compile time: build with -DLOG_LEVEL=LOG_LEVEL_WARN
+ * and the LOG_INFO() / LOG_DEBUG() sites, arguments included, disappear.
+ *
+ * Arguments are printf-style, but `%s` only takes strings that outlive the
+ * record (literals, static tables such as DeserializationError::c_str()):
+ * the string is read when the record is formatted, not when it is logged.
+ */
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_MAX_ARGS 4
+#define LOG_RING_SIZE 64      // Records, power of two (~1.8 kB)
+#define LOG_FLUSH_MS 20       // How often the log task drains the ring
+#define LOG_TASK_STACK 3072
+#define LOG_TASK_PRIORITY 1   // Just above idle
+#define LOG_TASK_CORE 0       // Away from loop(), which runs on core 1
+
+/**
+ * @brief One queued log line
+ */
+struct LogRecord {
+  const char *format; // Literal in flash, also identifies the log site
+  uint32_t timeMs;    // millis() when logged
+  uint8_t level;
+  uint8_t argc;
+  uintptr_t args[LOG_MAX_ARGS]; // Integers, float bits or string pointers
+};
+
+namespace Logger {
+/**
+ * @brief Start the log task (records queued before are kept)
+ * @param sink Where lines are written: Serial, or an open flash File
+ */
+bool Begin(Print &sink = Serial);
+
+/**
+ * @brief Write to a different sink from now on
+ */
+void SetSink(Print &sink);
+
+/**
+ * @brief Queue a record
+ * @return false if the ring was full (the record is counted as dropped)
+ */
+bool Write(uint8_t level, const char *format, uint8_t argc,
+           const uintptr_t *args);
+
+/**
+ * @brief Records lost to a full ring since boot
+ */
+uint32_t GetDropped();
+
+// Arguments as raw words: floats keep their bits, pointers their address
+inline uintptr_t Arg(float value) {
+  uint32_t word;
+  memcpy(&word, &value, sizeof(word));
+  return word;
+}
+inline uintptr_t Arg(double value) { return Arg((float)value); }
+inline uintptr_t Arg(const char *value) { return (uintptr_t)value; }
+inline uintptr_t Arg(char *value) { return (uintptr_t)value; }
+template <typename T> inline uintptr_t Arg(T value) {
+  return (uint32_t)value;
+}
+
+template <typename... Args>
+inline void Emit(uint8_t level, const char *format, Args... args) {
+  static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+  uintptr_t words[sizeof...(Args) + 1] = {Arg(args)...};
+  Write(level, format, sizeof...(Args), words);
+}
+} // namespace Logger
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Logger::Emit(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) Logger::Emit(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) Logger::Emit(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Logger::Emit(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#endif // LOGGER_H
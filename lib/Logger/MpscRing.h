@@ -0,0 +1,82 @@
+#ifndef MPSCRING_H
+#define MPSCRING_H
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @brief Fixed-size multi-producer/single-consumer ring buffer
+ * @details Lock-free (Vyukov's bounded queue): every slot carries a sequence
+ * number telling whether it is free for the producer at a given position or
+ * holds an item for the consumer. Producers claim a position with one
+ * compare-and-swap, so tasks on both cores and ISRs can push concurrently
+ * without a lock or a critical section. A producer never waits: when the
+ * ring is full the item is dropped.
+ * @tparam T Item type (should be trivially copyable)
+ * @tparam N Number of slots, must be a power of two
+ */
+template <typename T, uint32_t N> class MpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+
+public:
+  MpscRing() {
+    for (uint32_t i = 0; i < N; i++) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Push an item (any task or ISR)
+   * @return false if the ring was full and the item was dropped
+   */
+  bool Push(const T &item) {
+    uint32_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell &cell = cells_[pos & (N - 1)];
+      uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+      int32_t diff = (int32_t)(sequence - pos);
+      if (diff == 0) {
+        // Free at this position; claim it unless another producer did
+        if (head_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          cell.item = item;
+          cell.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false; // Still holds an item from a lap ago
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * @brief Pop the oldest item (the single consumer only)
+   * @return false if the ring was empty, or its oldest slot is claimed but
+   * not written yet
+   */
+  bool Pop(T &item) {
+    Cell &cell = cells_[tail_ & (N - 1)];
+    uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+    if ((int32_t)(sequence - (tail_ + 1)) < 0) {
+      return false;
+    }
+    item = cell.item;
+    cell.sequence.store(tail_ + N, std::memory_order_release);
+    tail_++;
+    return true;
+  }
+
+private:
+  struct Cell {
+    std::atomic<uint32_t> sequence;
+    T item;
+  };
+
+  Cell cells_[N];
+  std::atomic<uint32_t> head_{0}; // Next position to claim (producers)
+  uint32_t tail_ = 0;             // Next position to read (consumer owned)
+};
+
+#endif // MPSCRING_H
@@ -0,0 +1,87 @@
+#include "MemoryMonitor.h"
+#include <Logger.h>
+#include <esp_heap_caps.h>
+
+const char *memoryAlarmName(MemoryAlarm alarm) {
+  switch (alarm) {
+  case kMemoryFragmented:
+    return "fragmented";
+  case kMemoryLowBlock:
+    return "lowBlock";
+  case kMemoryLowStack:
+    return "lowStack";
+  }
+  return "";
+}
+
+bool MemoryMonitor::WatchTask(const char *name, TaskHandle_t handle) {
+  if (numTasks >= MEMORY_MAX_TASKS) {
+    return false;
+  }
+  tasks[numTasks++] = {name, handle, 0};
+  return true;
+}
+
+bool MemoryMonitor::Sample() {
+  freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  minFreeHeap = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  if (largestBlock < minLargestBlock) {
+    minLargestBlock = largestBlock;
+  }
+  fragmentation =
+      freeHeap ? 100 - (uint8_t)((uint64_t)largestBlock * 100 / freeHeap) : 0;
+  if (fragmentation > maxFragmentation) {
+    maxFragmentation = fragmentation;
+  }
+  samples++;
+
+  bool lowStack = false;
+  for (uint8_t i = 0; i < numTasks; i++) {
+    TaskWatermark &task = tasks[i];
+    if (!task.handle) {
+      task.handle = xTaskGetHandle(task.name);
+      if (!task.handle) {
+        continue;
+      }
+    }
+    // Bytes on ESP-IDF, where stacks are counted in bytes
+    task.stackFree = uxTaskGetStackHighWaterMark(task.handle);
+    if (task.stackFree < MEMORY_LOW_STACK_BYTES) {
+      lowStack = true;
+    }
+  }
+
+  uint8_t previous = alarms;
+  // Fragmentation swings with every request, so it has to drop well below
+  // the threshold before the alarm clears
+  if (fragmentation >= MEMORY_FRAG_ALARM_PCT) {
+    alarms |= kMemoryFragmented;
+  } else if (fragmentation < MEMORY_FRAG_CLEAR_PCT) {
+    alarms &= ~kMemoryFragmented;
+  }
+  if (largestBlock < MEMORY_LOW_BLOCK_BYTES) {
+    alarms |= kMemoryLowBlock;
+  } else {
+    alarms &= ~kMemoryLowBlock;
+  }
+  if (lowStack) {
+    alarms |= kMemoryLowStack;
+  } else {
+    alarms &= ~kMemoryLowStack;
+  }
+
+  if (alarms == previous) {
+    return false;
+  }
+  for (uint8_t bit = 1; bit; bit <<= 1) {
+    if (alarms & ~previous & bit) {
+      LOG_WARN("Memory alarm %s: %u free, largest block %u, %u%% fragmented",
+               memoryAlarmName((MemoryAlarm)bit), freeHeap, largestBlock,
+               fragmentation);
+    } else if (previous & ~alarms & bit) {
+      LOG_INFO("Memory alarm %s cleared", memoryAlarmName((MemoryAlarm)bit));
+    }
+  }
+  return true;
+}
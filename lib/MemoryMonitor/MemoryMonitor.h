@@ -0,0 +1,96 @@
+#ifndef MEMORYMONITOR_H
+#define MEMORYMONITOR_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Periodic heap and stack watermarks with alarms
+ * @details Each Sample() reads the allocator's counters (free bytes, largest
+ * free block, lowest free since boot) and the stack high-water mark of every
+ * watched task. All of it lives in fixed fields: sampling never allocates,
+ * so it still works when the heap is what is failing.
+ *
+ * Fragmentation is the share of free memory that is not in the largest
+ * block: at 80% a 100 kB free heap can still fail a 20 kB allocation.
+ */
+#define MEMORY_SAMPLE_MS 1000        // How often loop() samples
+#define MEMORY_MAX_TASKS 8           // Tasks whose stacks are watched
+#define MEMORY_FRAG_ALARM_PCT 60     // Fragmentation raising the alarm
+#define MEMORY_FRAG_CLEAR_PCT 50     // ...and clearing it again
+#define MEMORY_LOW_BLOCK_BYTES 8192  // Largest block below this is an alarm
+#define MEMORY_LOW_STACK_BYTES 512   // Stack headroom below this is an alarm
+
+/**
+ * @brief Alarm bits, see MemoryMonitor::GetAlarms()
+ */
+enum MemoryAlarm : uint8_t {
+  kMemoryFragmented = 1 << 0, // Fragmentation above MEMORY_FRAG_ALARM_PCT
+  kMemoryLowBlock = 1 << 1,   // Largest free block below the minimum
+  kMemoryLowStack = 1 << 2,   // A watched task is close to its stack end
+};
+
+/**
+ * @brief Short name of one alarm bit, as used by the API and the OLED
+ */
+const char *memoryAlarmName(MemoryAlarm alarm);
+
+/**
+ * @brief Stack watermark of one task
+ */
+struct TaskWatermark {
+  const char *name;    // FreeRTOS task name (a literal)
+  TaskHandle_t handle; // Resolved from the name once the task exists
+  uint32_t stackFree;  // Lowest free stack ever, in bytes (0 = not seen)
+};
+
+class MemoryMonitor {
+public:
+  /**
+   * @brief Watch a task's stack
+   * @param name Task name, e.g. "loopTask" or "async_tcp"; tasks that do not
+   * exist yet are looked up again on every sample until they do
+   * @return false if MEMORY_MAX_TASKS tasks are already watched
+   */
+  bool WatchTask(const char *name, TaskHandle_t handle = nullptr);
+
+  /**
+   * @brief Take a sample and update the alarms
+   * @return true if the alarms changed
+   */
+  bool Sample();
+
+  uint32_t GetFreeHeap() const { return freeHeap; }
+  uint32_t GetLargestBlock() const { return largestBlock; }
+  uint32_t GetMinFreeHeap() const { return minFreeHeap; }
+  uint32_t GetMinLargestBlock() const { return minLargestBlock; }
+
+  /**
+   * @brief Fragmentation of the last sample in percent (0-100)
+   */
+  uint8_t GetFragmentation() const { return fragmentation; }
+  uint8_t GetMaxFragmentation() const { return maxFragmentation; }
+
+  /**
+   * @brief Active alarms, a mask of MemoryAlarm bits
+   */
+  uint8_t GetAlarms() const { return alarms; }
+  uint32_t GetSamples() const { return samples; }
+
+  uint8_t GetNumTasks() const { return numTasks; }
+  const TaskWatermark &GetTask(uint8_t index) const { return tasks[index]; }
+
+private:
+  TaskWatermark tasks[MEMORY_MAX_TASKS];
+  uint8_t numTasks = 0;
+
+  uint32_t freeHeap = 0;
+  uint32_t largestBlock = 0;
+  uint32_t minFreeHeap = 0;
+  uint32_t minLargestBlock = UINT32_MAX;
+  uint8_t fragmentation = 0;
+  uint8_t maxFragmentation = 0;
+  uint8_t alarms = 0;
+  uint32_t samples = 0;
+};
+
+#endif // MEMORYMONITOR_H
@@ -0,0 +1,112 @@
+#include "Metrics.h"
+
+#if METRICS_ENABLED
+
+static Histogram *firstHistogram = nullptr;
+static Counter *firstCounter = nullptr;
+
+Histogram::Histogram(const char *name, const char *help)
+    : next(firstHistogram), name(name), help(help) {
+  firstHistogram = this;
+}
+
+Counter::Counter(const char *name, const char *help)
+    : next(firstCounter), name(name), help(help) {
+  firstCounter = this;
+}
+
+uint32_t Histogram::UpperBound(uint8_t index) {
+  if (index == 0) {
+    return 1UL << METRICS_MIN_EXP;
+  }
+  if (index >= METRICS_BUCKETS - 1) {
+    return 0;
+  }
+  uint8_t exponent = METRICS_MIN_EXP + ((index - 1) >> METRICS_SUB_BITS);
+  uint8_t sub = (index - 1) & ((1 << METRICS_SUB_BITS) - 1);
+  return (1UL << exponent) + ((uint32_t)(sub + 1)
+                              << (exponent - METRICS_SUB_BITS));
+}
+
+uint32_t Histogram::Percentile(float quantile) const {
+  uint32_t total = count;
+  if (total == 0) {
+    return 0;
+  }
+  uint32_t rank = quantile * total + 0.5f;
+  if (rank < 1) {
+    rank = 1;
+  }
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < METRICS_BUCKETS; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      uint32_t upper = UpperBound(i);
+      return upper == 0 || upper > max ? max : upper;
+    }
+  }
+  return max;
+}
+
+Histogram *Metrics::FirstHistogram() { return firstHistogram; }
+Counter *Metrics::FirstCounter() { return firstCounter; }
+
+void Metrics::WritePrometheus(Print &out) {
+  float secondsPerCycle = 1.0f / (ESP.getCpuFreqMHz() * 1000000.0f);
+
+  for (Histogram *h = firstHistogram; h; h = h->next) {
+    out.printf("# HELP " METRICS_PREFIX "%s_seconds %s\n", h->GetName(),
+               h->GetHelp());
+    out.printf("# TYPE " METRICS_PREFIX "%s_seconds histogram\n",
+               h->GetName());
+
+    // Only the span of buckets that holds samples: the rest would be a
+    // hundred lines of zeros (or of the total) per histogram
+    uint32_t total = h->GetCount();
+    uint32_t cumulative = 0;
+    for (uint8_t i = 0; i < METRICS_BUCKETS - 1 && cumulative < total; i++) {
+      cumulative += h->GetBucket(i);
+      if (cumulative == 0) {
+        continue;
+      }
+      out.printf(METRICS_PREFIX "%s_seconds_bucket{le=\"%.9g\"} %lu\n",
+                 h->GetName(), Histogram::UpperBound(i) * secondsPerCycle,
+                 (unsigned long)cumulative);
+    }
+    out.printf(METRICS_PREFIX "%s_seconds_bucket{le=\"+Inf\"} %lu\n",
+               h->GetName(), (unsigned long)total);
+    out.printf(METRICS_PREFIX "%s_seconds_sum %.9g\n", h->GetName(),
+               (double)h->GetSum() * secondsPerCycle);
+    out.printf(METRICS_PREFIX "%s_seconds_count %lu\n", h->GetName(),
+               (unsigned long)total);
+  }
+
+  for (Counter *c = firstCounter; c; c = c->next) {
+    out.printf("# HELP " METRICS_PREFIX "%s_total %s\n", c->GetName(),
+               c->GetHelp());
+    out.printf("# TYPE " METRICS_PREFIX "%s_total counter\n", c->GetName());
+    out.printf(METRICS_PREFIX "%s_total %lu\n", c->GetName(),
+               (unsigned long)c->GetValue());
+  }
+}
+
+void Metrics::Dump(Print &out) {
+  float usPerCycle = 1.0f / ESP.getCpuFreqMHz();
+
+  out.printf("%-20s %10s %9s %9s %9s %9s %9s\n", "timer (us)", "count",
+             "mean", "p50", "p90", "p99", "max");
+  for (Histogram *h = firstHistogram; h; h = h->next) {
+    uint32_t count = h->GetCount();
+    float mean = count ? (float)h->GetSum() / count : 0.0f;
+    out.printf("%-20s %10lu %9.1f %9.1f %9.1f %9.1f %9.1f\n", h->GetName(),
+               (unsigned long)count, mean * usPerCycle,
+               h->Percentile(0.5f) * usPerCycle,
+               h->Percentile(0.9f) * usPerCycle,
+               h->Percentile(0.99f) * usPerCycle, h->GetMax() * usPerCycle);
+  }
+  for (Counter *c = firstCounter; c; c = c->next) {
+    out.printf("%-20s %10lu\n", c->GetName(), (unsigned long)c->GetValue());
+  }
+}
+
+#endif // METRICS_ENABLED
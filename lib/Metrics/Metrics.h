@@ -0,0 +1,180 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Hot-path instrumentation: scoped cycle timers feeding histograms,
+ * and plain counters
+ * @details Build with -DMETRICS_ENABLED=0 and every METRICS_* macro expands
+ * to nothing, so instrumented code carries no cost at all. When enabled a
+ * timed scope costs two cycle-counter reads and a histogram update, a few
+ * dozen cycles.
+ *
+ * Metrics are declared once, at namespace scope, in the one translation unit
+ * using them:
+ *
+ *     METRICS_HISTOGRAM(renderMetric, "render", "Rendering one OLED frame");
+ *     ...
+ *     { METRICS_TIME(renderMetric); Draw(); }
+ *
+ * and register themselves for /metrics (Prometheus text) and the serial
+ * dump.
+ */
+#ifndef METRICS_ENABLED
+#define METRICS_ENABLED 1
+#endif
+
+#define METRICS_MIN_EXP 6 // Durations below 2^6 cycles share the first bucket
+#define METRICS_MAX_EXP 31 // Durations from 2^31 cycles (~9 s) share the last
+#define METRICS_SUB_BITS 2 // 4 buckets per power of two, within 25%
+#define METRICS_BUCKETS                                                        \
+  (2 + (METRICS_MAX_EXP - METRICS_MIN_EXP) * (1 << METRICS_SUB_BITS))
+#define METRICS_PREFIX "phytolabs_"
+
+#if METRICS_ENABLED
+
+#if defined(ESP_IDF_VERSION_MAJOR) && ESP_IDF_VERSION_MAJOR >= 5
+#include <esp_cpu.h>
+#define METRICS_CYCLES() ((uint32_t)esp_cpu_get_cycle_count())
+#else
+#define METRICS_CYCLES() ESP.getCycleCount()
+#endif
+
+/**
+ * @brief Log-linear histogram of durations in CPU cycles
+ * @details Like HdrHistogram: every power of two is split into
+ * 2^METRICS_SUB_BITS linear buckets, so the relative error is bounded over
+ * the whole range with a fixed ~400 bytes of counts and no allocation.
+ * Record() is meant to be called by one task; readers on other tasks may
+ * see a sample half-recorded, which is harmless for monitoring.
+ */
+class Histogram {
+public:
+  Histogram(const char *name, const char *help);
+
+  void Record(uint32_t cycles) {
+    buckets[BucketOf(cycles)]++;
+    count++;
+    sum += cycles;
+    if (cycles > max) {
+      max = cycles;
+    }
+  }
+
+  const char *GetName() const { return name; }
+  const char *GetHelp() const { return help; }
+  uint32_t GetCount() const { return count; }
+  uint64_t GetSum() const { return sum; }
+  uint32_t GetMax() const { return max; }
+  uint32_t GetBucket(uint8_t index) const { return buckets[index]; }
+
+  /**
+   * @brief Cycles below which a fraction `quantile` (0-1) of the samples
+   * fell, to bucket precision
+   */
+  uint32_t Percentile(float quantile) const;
+
+  /**
+   * @brief Exclusive upper bound of a bucket, in cycles (0 = unbounded)
+   */
+  static uint32_t UpperBound(uint8_t index);
+
+  static uint8_t BucketOf(uint32_t cycles) {
+    if (cycles < (1UL << METRICS_MIN_EXP)) {
+      return 0;
+    }
+    uint8_t exponent = 31 - __builtin_clz(cycles);
+    if (exponent >= METRICS_MAX_EXP) {
+      return METRICS_BUCKETS - 1;
+    }
+    return 1 + ((exponent - METRICS_MIN_EXP) << METRICS_SUB_BITS) +
+           ((cycles >> (exponent - METRICS_SUB_BITS)) &
+            ((1 << METRICS_SUB_BITS) - 1));
+  }
+
+  Histogram *next; // Registry, see Metrics::FirstHistogram()
+
+private:
+  const char *name;
+  const char *help;
+  uint32_t count = 0;
+  uint32_t max = 0;
+  uint64_t sum = 0;
+  uint32_t buckets[METRICS_BUCKETS] = {};
+};
+
+/**
+ * @brief Monotonic event counter
+ */
+class Counter {
+public:
+  Counter(const char *name, const char *help);
+
+  void Increment(uint32_t by = 1) { value += by; }
+
+  const char *GetName() const { return name; }
+  const char *GetHelp() const { return help; }
+  uint32_t GetValue() const { return value; }
+
+  Counter *next; // Registry, see Metrics::FirstCounter()
+
+private:
+  const char *name;
+  const char *help;
+  uint32_t value = 0;
+};
+
+/**
+ * @brief Records the cycles from construction to destruction
+ * @note Both ends read the counter of the core the task runs on; a task
+ * that migrates in between records garbage (usually in the last bucket).
+ * loop() and the web server task are pinned, so their scopes are exact.
+ */
+class ScopedTimer {
+public:
+  explicit ScopedTimer(Histogram &histogram)
+      : histogram(histogram), start(METRICS_CYCLES()) {}
+  ~ScopedTimer() { histogram.Record(METRICS_CYCLES() - start); }
+
+private:
+  Histogram &histogram;
+  uint32_t start;
+};
+
+/**
+ * @brief Export of every registered metric
+ */
+namespace Metrics {
+Histogram *FirstHistogram();
+Counter *FirstCounter();
+
+/**
+ * @brief Prometheus text exposition format, durations in seconds
+ */
+void WritePrometheus(Print &out);
+
+/**
+ * @brief Human-readable table (count, mean, p50/p90/p99, max in us)
+ */
+void Dump(Print &out);
+} // namespace Metrics
+
+#define METRICS_CONCAT_(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_(a, b)
+#define METRICS_HISTOGRAM(var, name, help) Histogram var(name, help)
+#define METRICS_COUNTER(var, name, help) Counter var(name, help)
+#define METRICS_TIME(var)                                                      \
+  ScopedTimer METRICS_CONCAT(metricsTimer, __LINE__)(var)
+#define METRICS_COUNT(var) (var).Increment()
+
+#else // METRICS_ENABLED
+
+#define METRICS_HISTOGRAM(var, name, help)
+#define METRICS_COUNTER(var, name, help)
+#define METRICS_TIME(var)
+#define METRICS_COUNT(var)
+
+#endif // METRICS_ENABLED
+
+#endif // METRICS_H
@@ -3,6 +3,7 @@
 #define RELAY_H
 
 #include "Arduino.h"
+#include <Logger.h>
 
 /**
  * @class Relay
@@ -19,7 +20,7 @@ public:
       : pin(pin), relayState(relayState) {
     // Validate pin (simplified)
     if (pin < 0 || pin > 31) {
-      Serial.println("Error: Invalid pin number");
+      LOG_ERROR("Invalid relay pin %u", pin);
     }
     pinMode(pin, OUTPUT);
     digitalWrite(pin, relayState); // Set the relays state
@@ -0,0 +1,51 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <stdint.h>
+
+#include "TimerWheel.h"
+
+#define SECONDS_PER_DAY 86400UL
+
+/**
+ * @brief Repeating on/off window on the InternalTime clock
+ * @details On for `duration` seconds starting at `start`, repeated every
+ * `period` seconds. Times are seconds since the epoch, which InternalTime
+ * keeps aligned to midnight, so
+ * - "lights 06:00-22:00" is period 86400, start 21600, duration 57600
+ * - "pump 5 min every hour" is period 3600, start 0, duration 300
+ */
+struct Schedule {
+  uint32_t period = 0;   // Repeat interval in seconds, 0 disables
+  uint32_t start = 0;    // Offset of the first on edge
+  uint32_t duration = 0; // On time per period in seconds
+
+  // Seconds into the current period
+  uint32_t Phase(uint32_t now) const {
+    return (now % period + period - start % period) % period;
+  }
+
+  /**
+   * @brief Whether the window is open at `now`
+   */
+  bool IsActive(uint32_t now) const {
+    if (period == 0 || duration == 0) {
+      return false;
+    }
+    return duration >= period || Phase(now) < duration;
+  }
+
+  /**
+   * @brief The next second at which IsActive() changes
+   * @return 0 if it never changes
+   */
+  uint32_t NextEdge(uint32_t now) const {
+    if (period == 0 || duration == 0 || duration >= period) {
+      return 0;
+    }
+    uint32_t phase = Phase(now);
+    return now + (phase < duration ? duration - phase : period - phase);
+  }
+};
+
+#endif // SCHEDULE_H
@@ -0,0 +1,99 @@
+#include "TimerWheel.h"
+
+void TimerWheel::Reset(uint32_t now) {
+  for (uint8_t level = 0; level < WHEEL_LEVELS; level++) {
+    for (uint8_t slot = 0; slot < WHEEL_SLOTS; slot++) {
+      slots[level][slot] = nullptr;
+    }
+  }
+  current = now;
+}
+
+void TimerWheel::Schedule(TimerNode *node, uint32_t expires) {
+  Cancel(node);
+  node->expires = expires;
+  Insert(node, current + 1); // The current second has already been run
+}
+
+void TimerWheel::Cancel(TimerNode *node) {
+  if (!node->IsPending()) {
+    return;
+  }
+  *node->pprev = node->next;
+  if (node->next) {
+    node->next->pprev = node->pprev;
+  }
+  node->next = nullptr;
+  node->pprev = nullptr;
+}
+
+void TimerWheel::Insert(TimerNode *node, uint32_t earliest) {
+  uint32_t at = node->expires;
+  if ((int32_t)(at - earliest) < 0) {
+    at = earliest; // Overdue
+  } else if (at - current >= WHEEL_RANGE) {
+    at = current + WHEEL_RANGE - 1; // Parked; re-inserted when reached
+  }
+
+  // The level is the highest digit where `at` differs from the current
+  // time, so a timer always sits in a slot the clock has yet to reach
+  uint8_t level = 0;
+  while (level + 1 < WHEEL_LEVELS &&
+         (at >> (WHEEL_BITS * (level + 1))) !=
+             (current >> (WHEEL_BITS * (level + 1)))) {
+    level++;
+  }
+
+  TimerNode **head =
+      &slots[level][(at >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)];
+  node->next = *head;
+  if (node->next) {
+    node->next->pprev = &node->next;
+  }
+  *head = node;
+  node->pprev = head;
+}
+
+void TimerWheel::Cascade(uint8_t level) {
+  TimerNode **head =
+      &slots[level][(current >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)];
+  TimerNode *node = *head;
+  *head = nullptr;
+
+  while (node) {
+    TimerNode *next = node->next;
+    node->pprev = nullptr;
+    Insert(node, current); // Timers due now land in the slot about to run
+    node = next;
+  }
+}
+
+size_t TimerWheel::Advance(uint32_t now) {
+  size_t fired = 0;
+
+  while ((int32_t)(now - current) > 0) {
+    current++;
+
+    // Refill the lower levels from the top down whenever they wrap
+    for (uint8_t level = WHEEL_LEVELS - 1; level > 0; level--) {
+      uint32_t mask = (1UL << (WHEEL_BITS * level)) - 1;
+      if ((current & mask) == 0) {
+        Cascade(level);
+      }
+    }
+
+    TimerNode **head = &slots[0][current & (WHEEL_SLOTS - 1)];
+    while (*head) {
+      TimerNode *node = *head;
+      Cancel(node);
+      if ((int32_t)(node->expires - current) > 0) {
+        Insert(node, current + 1); // Was parked beyond the wheel's range
+      } else {
+        fired++;
+        node->callback(*this, node, current);
+      }
+    }
+  }
+
+  return fired;
+}
@@ -0,0 +1,82 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define WHEEL_BITS 6                    // log2 of the slots per level
+#define WHEEL_SLOTS (1 << WHEEL_BITS)   // Slots per level
+#define WHEEL_LEVELS 4                  // 64 s, 68 min, 3 days, 194 days
+#define WHEEL_RANGE (1UL << (WHEEL_BITS * WHEEL_LEVELS)) // Seconds covered
+
+class TimerWheel;
+struct TimerNode;
+
+typedef void (*TimerCallback)(TimerWheel &wheel, TimerNode *node,
+                              uint32_t now);
+
+/**
+ * @brief Timer embedded in whatever it belongs to, so scheduling never
+ * allocates
+ */
+struct TimerNode {
+  TimerCallback callback = nullptr; // Called once the timer expires
+  void *context = nullptr;          // Owner, for the callback
+  uint32_t expires = 0;             // Second the timer fires at
+
+  TimerNode *next = nullptr;   // Next timer in the same slot
+  TimerNode **pprev = nullptr; // Link pointing at this node, null if idle
+
+  bool IsPending() const { return pprev != nullptr; }
+};
+
+/**
+ * @brief Hierarchical timing wheel with one second resolution
+ * @details Level 0 has one slot per second for the next 64 s. Each level
+ * above covers 64 times the span of the one below, and its timers cascade
+ * down a level whenever the level below wraps. Scheduling and cancelling are
+ * O(1), and advancing by one second touches a single slot plus an occasional
+ * cascade, no matter how many timers are pending.
+ */
+class TimerWheel {
+public:
+  /**
+   * @brief Drop every timer and restart the clock at `now`
+   * @note Nodes still linked in are just forgotten, so only call this when
+   * their owners are reset too
+   */
+  void Reset(uint32_t now);
+
+  /**
+   * @brief Arm (or re-arm) a timer
+   * @param node Timer to arm, with callback and context already set
+   * @param expires Second to fire at; anything not after the current time
+   * fires on the next second
+   */
+  void Schedule(TimerNode *node, uint32_t expires);
+
+  /**
+   * @brief Disarm a timer (no-op if it isn't pending)
+   */
+  void Cancel(TimerNode *node);
+
+  /**
+   * @brief Move the clock forward to `now`, firing timers on the way
+   * @return Number of timers fired
+   * @note Costs one slot per elapsed second, so callers should Reset() and
+   * re-arm after large jumps instead
+   */
+  size_t Advance(uint32_t now);
+
+  // Second the wheel has been advanced to
+  uint32_t GetTime() const { return current; }
+
+private:
+  void Insert(TimerNode *node, uint32_t earliest);
+  void Cascade(uint8_t level);
+
+  TimerNode *slots[WHEEL_LEVELS][WHEEL_SLOTS] = {};
+  uint32_t current = 0;
+};
+
+#endif // TIMERWHEEL_H
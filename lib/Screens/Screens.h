@@ -9,8 +9,24 @@
 #define SCREENS_H
 
 #include <Helpers.h>
+#include <MemoryMonitor.h>
+#include <Sensors.h>
 #include <UiKit.h>
 
+#define DASHBOARD_REFRESH_MS 250 // Default dashboard redraw interval
+#define DASHBOARD_ROWS 3         // Sensor rows visible at once
+#define DASHBOARD_ROW_HEIGHT 10  // Height of one sensor row in pixels
+#define DASHBOARD_TOP 12         // Y of the first sensor row
+#define DASHBOARD_RELAY_Y 44     // Y of the relay indicator row
+
+#define MEMORY_SCREEN_TASK_ROWS 2 // Task stack rows visible at once
+
+#define SPARKLINE_WIDTH 48     // Columns (pixels) of history per sparkline
+#define SPARKLINE_HEIGHT 8     // Height of a sparkline in pixels
+#define SPARKLINE_DECIMATION 5 // Samples folded into each column
+#define SPARKLINE_ROW_BYTES ((SPARKLINE_WIDTH + 7) / 8)
+#define SPARKLINE_LEVELS 256   // Steps a column's extremes are stored with
+
 /**
  * @class TimeMenu
  * @brief Class representing a time settings menu
@@ -58,10 +74,19 @@ public:
     u8g2.drawStr(85, 32, seconds_str);
   };
 
+  /**
+   * @brief Start editing from the current time each time the menu opens
+   */
+  void OnEnter() override {
+    current_setting_unit = 0;
+    updated_hour = time->GetHour();
+    updated_minute = time->GetMinute();
+  }
+
   /**
    * @brief Handle user input for the time menu
    * @param input Input value from the user (SELECT, UP, DOWN)
-   * @return 1 if the screen should be redrawn, 0 otherwise
+   * @return NAV_BACK once the new time is saved, 0 otherwise
    */
   uint8_t HandleInput(uint8_t input) override {
     if (input == SELECT) {
@@ -89,9 +114,7 @@ public:
       // reset the counter
       current_setting_unit = 0;
 
-      // HACK: temp
-      Serial.println("Time menu: Third input");
-      return 1;
+      return NAV_BACK;
     }
 
     return 0;
@@ -119,7 +142,8 @@ public:
    * @param max Maximum value for slider (default 100)
    */
   SliderMenu(NavInfo *nav_info, uint8_t screen_id, int min = 0, int max = 100)
-      : Screen(screen_id), nav_info(nav_info), min(min), max(max) {}
+      : Screen(screen_id), nav_info(nav_info), smallValue(min), bigValue(max),
+        min(min), max(max) {}
 
   /**
    * @brief Draw the slider menu on the display
@@ -245,7 +269,7 @@ public:
    * @param nav_info Navigation information pointer
    * @param new_current_item Initial selected item index (default: 0)
    */
-  SettingsList(uint8_t screen_id, uint8_t num_items, MenuItem *items,
+  SettingsList(uint8_t screen_id, uint8_t num_items, const MenuItem *items,
                NavInfo *nav_info,
                uint8_t new_current_item = 0)
       : Screen(screen_id),                  // Initialize the base class
@@ -297,10 +321,382 @@ public:
   }
 
 private:
-  MenuItem *items;      /**< Pointer to the array of menu items */
-  NavInfo *nav_info;    /**< Navigation information object */
-  size_t num_items;     /**< Number of items in the menu */
-  uint8_t current_item; /**< Index of the currently selected item */
+  const MenuItem *items; /**< Pointer to the array of menu items */
+  NavInfo *nav_info;     /**< Navigation information object */
+  size_t num_items;      /**< Number of items in the menu */
+  uint8_t current_item;  /**< Index of the currently selected item */
+};
+
+/**
+ * @brief Scrolling min/max plot of a value over time
+ * @details Every SPARKLINE_DECIMATION samples are folded into one column that
+ * keeps their min and max, so spikes survive decimation. Columns are stored
+ * as one byte per extreme, quantized to SPARKLINE_LEVELS steps of the
+ * current range, next to the XBM bitmap Draw() blits as is: a new column
+ * scrolls the bitmap one pixel left and sets only its own pixels, so the
+ * page-buffered display redrawing it once per page costs nothing extra.
+ * When the range has to change the stored levels are mapped onto the new
+ * one and the bitmap is rebuilt from them; the steps are fine enough for
+ * the plot to tighten again once a spike scrolls out. About 150 bytes per
+ * sensor slot.
+ */
+class Sparkline {
+public:
+  /**
+   * @brief Constructor
+   * @param decimation Samples per column
+   */
+  Sparkline(uint8_t decimation = SPARKLINE_DECIMATION)
+      : decimation(decimation ? decimation : 1) {
+    Reset(0);
+  }
+
+  /**
+   * @brief Clear the history and hand the sparkline to a new owner
+   * @param new_owner ID of the sensor the samples come from
+   */
+  void Reset(uint8_t new_owner) {
+    owner = new_owner;
+    count = 0;
+    head = 0;
+    pending = 0;
+    low = 0.0f;
+    high = 0.0f;
+    memset(bitmap, 0, sizeof(bitmap));
+  }
+
+  /**
+   * @brief Add a sample
+   * @param value The newest sensor value
+   */
+  void Push(float value) {
+    if (pending == 0 || value < pending_min) {
+      pending_min = value;
+    }
+    if (pending == 0 || value > pending_max) {
+      pending_max = value;
+    }
+    if (++pending < decimation) {
+      return;
+    }
+    pending = 0;
+    AppendColumn(pending_min, pending_max);
+  }
+
+  /**
+   * @brief Draw the sparkline with its top-left corner at (x, y)
+   */
+  void Draw(int x, int y) const {
+    u8g2.drawXBM(x, y, SPARKLINE_WIDTH, SPARKLINE_HEIGHT, bitmap);
+  }
+
+  uint8_t GetOwner() const { return owner; }
+  float GetLow() const { return low; }
+  float GetHigh() const { return high; }
+
+private:
+  uint8_t Row(uint8_t level) const {
+    if (high == low) {
+      return SPARKLINE_HEIGHT / 2; // Flat history, draw through the middle
+    }
+    return ((SPARKLINE_LEVELS - 1 - level) * (SPARKLINE_HEIGHT - 1) +
+            (SPARKLINE_LEVELS - 1) / 2) /
+           (SPARKLINE_LEVELS - 1);
+  }
+
+  // Level of `value` on a plot spanning [range_low, range_high]
+  static uint8_t Level(float value, float range_low, float range_high) {
+    if (range_high == range_low) {
+      return 0;
+    }
+    int level = (int)((value - range_low) * (SPARKLINE_LEVELS - 1) /
+                          (range_high - range_low) +
+                      0.5f);
+    return Clamp(level, 0, SPARKLINE_LEVELS - 1);
+  }
+
+  // Value stored as `level`, the inverse of Level()
+  static float Value(uint8_t level, float range_low, float range_high) {
+    if (level == SPARKLINE_LEVELS - 1) {
+      return range_high;
+    }
+    return range_low +
+           level * (range_high - range_low) / (SPARKLINE_LEVELS - 1);
+  }
+
+  uint8_t Oldest() const {
+    return (head + SPARKLINE_WIDTH - count) % SPARKLINE_WIDTH;
+  }
+
+  // Set the pixels of stored `column` at bitmap column `pixel_x`; XBM keeps
+  // the leftmost pixel in the lowest bit
+  void PlotColumn(uint8_t column, uint8_t pixel_x) {
+    uint8_t mask = 1 << (pixel_x % 8);
+    for (uint8_t row = Row(maxs[column]); row <= Row(mins[column]); row++) {
+      bitmap[row * SPARKLINE_ROW_BYTES + pixel_x / 8] |= mask;
+    }
+  }
+
+  // Move every row one pixel left, dropping the oldest column
+  void ScrollLeft() {
+    for (uint8_t row = 0; row < SPARKLINE_HEIGHT; row++) {
+      uint8_t *bytes = &bitmap[row * SPARKLINE_ROW_BYTES];
+      for (uint8_t i = 0; i + 1 < SPARKLINE_ROW_BYTES; i++) {
+        bytes[i] = bytes[i] >> 1 | bytes[i + 1] << 7;
+      }
+      bytes[SPARKLINE_ROW_BYTES - 1] >>= 1;
+    }
+  }
+
+  void AppendColumn(float column_min, float column_max) {
+    // Dropping the oldest column may take the current extreme with it
+    bool evicts_extreme =
+        count == SPARKLINE_WIDTH && high > low &&
+        (mins[head] == 0 || maxs[head] == SPARKLINE_LEVELS - 1);
+    if (count == SPARKLINE_WIDTH) {
+      count--;
+    }
+
+    if (count == 0) {
+      low = column_min;
+      high = column_max;
+    } else if (evicts_extreme || column_min < low || column_max > high) {
+      Rescale(column_min, column_max);
+    }
+
+    mins[head] = Level(column_min, low, high);
+    maxs[head] = Level(column_max, low, high);
+    ScrollLeft();
+    PlotColumn(head, SPARKLINE_WIDTH - 1);
+    head = (head + 1) % SPARKLINE_WIDTH;
+    count++;
+  }
+
+  // Fit the range to the history plus the new column, move the stored
+  // levels onto it and redraw them, right-aligned
+  void Rescale(float column_min, float column_max) {
+    float new_low = column_min;
+    float new_high = column_max;
+    uint8_t oldest = Oldest();
+    for (uint8_t i = 0; i < count; i++) {
+      uint8_t column = (oldest + i) % SPARKLINE_WIDTH;
+      new_low = min(new_low, Value(mins[column], low, high));
+      new_high = max(new_high, Value(maxs[column], low, high));
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+      uint8_t column = (oldest + i) % SPARKLINE_WIDTH;
+      mins[column] = Level(Value(mins[column], low, high), new_low, new_high);
+      maxs[column] = Level(Value(maxs[column], low, high), new_low, new_high);
+    }
+    low = new_low;
+    high = new_high;
+
+    memset(bitmap, 0, sizeof(bitmap));
+    for (uint8_t i = 0; i < count; i++) {
+      PlotColumn((oldest + i) % SPARKLINE_WIDTH, SPARKLINE_WIDTH - count + i);
+    }
+  }
+
+  const uint8_t decimation; // Samples per column
+  uint8_t owner;            // Sensor ID the history belongs to
+  uint8_t count;            // Columns of history so far
+  uint8_t head;             // Next column slot to write
+  uint8_t pending;          // Samples folded into the open column
+  float pending_min;        // Min of the open column
+  float pending_max;        // Max of the open column
+  float low;                // Value at the bottom row
+  float high;               // Value at the top row
+  uint8_t mins[SPARKLINE_WIDTH]; // Column extremes as levels of [low, high]
+  uint8_t maxs[SPARKLINE_WIDTH];
+  uint8_t bitmap[SPARKLINE_ROW_BYTES * SPARKLINE_HEIGHT]; // What Draw() blits
+};
+
+/**
+ * @class DashboardScreen
+ * @brief Live view of sensor values and relay states
+ * @details Each row shows a sensor's name, current value and a sparkline of
+ * its recent history, or the fault instead of the value while the sensor is
+ * faulted; the bottom row has one box per relay, filled while the relay is
+ * on (or as far as its duty for PID outputs) and crossed while it is in its
+ * fail-safe state. UP/DOWN scroll when
+ * there are more sensors than rows.
+ */
+class DashboardScreen : public Screen {
+public:
+  /**
+   * @brief Constructor for DashboardScreen
+   * @param screen_id Unique identifier for the screen
+   * @param manager Sensors and relays to show
+   * @param sparklines One sparkline per sensor slot of `manager`
+   * @param refresh_ms Redraw interval while the dashboard is open
+   */
+  DashboardScreen(uint8_t screen_id, SensorRelayManager *manager,
+                  const Sparkline *sparklines,
+                  uint16_t refresh_ms = DASHBOARD_REFRESH_MS)
+      : Screen(screen_id), manager(manager), sparklines(sparklines),
+        refresh_ms(refresh_ms) {}
+
+  /**
+   * @brief Draw the visible sensor rows and the relay indicators
+   */
+  void Draw() override {
+    u8g2.setFont(u8g_font_baby);
+
+    uint8_t num_sensors = manager->GetNumSensors();
+    if (num_sensors == 0) {
+      u8g2.drawStr(0, DASHBOARD_TOP + 7, "No sensors set up");
+    }
+
+    for (uint8_t row = 0; row < DASHBOARD_ROWS; row++) {
+      uint8_t index = first_row + row;
+      if (index >= num_sensors || manager->sensors[index] == nullptr) {
+        break;
+      }
+      Sensor *sensor = manager->sensors[index];
+      int y = DASHBOARD_TOP + row * DASHBOARD_ROW_HEIGHT;
+
+      char text[10];
+      snprintf(text, sizeof(text), "%s", sensor->GetName());
+      u8g2.drawStr(0, y + 7, text);
+      SensorFault fault = manager->GetSensorFault(index);
+      if (fault != kSensorOk) {
+        snprintf(text, sizeof(text), "!%s", sensorFaultName(fault));
+      } else {
+        snprintf(text, sizeof(text), "%.2f", manager->GetSensorValue(index));
+      }
+      u8g2.drawStr(42, y + 7, text);
+      sparklines[index].Draw(SCREEN_WIDTH - SPARKLINE_WIDTH, y);
+    }
+
+    // As many relays as fit across the screen
+    for (uint8_t i = 0; i < manager->GetNumRelays() && i * 9 + 7 <= SCREEN_WIDTH;
+         i++) {
+      if (manager->relays[i] && manager->relays[i]->IsProportional()) {
+        // PID outputs fill from the bottom with their duty
+        uint8_t height = manager->GetRelayDuty(i) * 7 + 0.5f;
+        u8g2.drawFrame(i * 9, DASHBOARD_RELAY_Y, 7, 7);
+        u8g2.drawBox(i * 9, DASHBOARD_RELAY_Y + 7 - height, 7, height);
+      } else if (manager->GetRelayStatus(i)) {
+        u8g2.drawBox(i * 9, DASHBOARD_RELAY_Y, 7, 7);
+      } else {
+        u8g2.drawFrame(i * 9, DASHBOARD_RELAY_Y, 7, 7);
+      }
+      if (manager->IsRelayFailSafe(i)) {
+        u8g2.setDrawColor(2); // XOR, so the cross shows on a filled box too
+        u8g2.drawLine(i * 9 + 1, DASHBOARD_RELAY_Y + 1, i * 9 + 5,
+                      DASHBOARD_RELAY_Y + 5);
+        u8g2.drawLine(i * 9 + 5, DASHBOARD_RELAY_Y + 1, i * 9 + 1,
+                      DASHBOARD_RELAY_Y + 5);
+        u8g2.setDrawColor(1);
+      }
+    }
+  }
+
+  /**
+   * @brief Handle user input for the dashboard
+   * @param input Input value from the user (UP, DOWN, SELECT)
+   * @return NAV_BACK on SELECT, NO_INPUT otherwise
+   */
+  uint8_t HandleInput(uint8_t input) override {
+    uint8_t num_sensors = manager->GetNumSensors();
+    if (input == UP && first_row + DASHBOARD_ROWS < num_sensors) {
+      first_row++;
+    } else if (input == DOWN && first_row > 0) {
+      first_row--;
+    } else if (input == SELECT) {
+      return NAV_BACK;
+    }
+    return NO_INPUT;
+  }
+
+  uint16_t GetRefreshInterval() const override { return refresh_ms; }
+
+private:
+  SensorRelayManager *manager;  /**< Source of sensor and relay state */
+  const Sparkline *sparklines;  /**< History, indexed like manager->sensors */
+  const uint16_t refresh_ms;    /**< Redraw interval in milliseconds */
+  uint8_t first_row = 0;        /**< Index of the topmost visible sensor */
+};
+
+/**
+ * @class MemoryScreen
+ * @brief Heap and stack watermarks from a MemoryMonitor
+ * @details Three heap rows (free, largest block, fragmentation, each with
+ * its worst value since boot) and the stack headroom of the watched tasks.
+ * Values in alarm are marked with '!'. UP/DOWN scroll the task rows.
+ */
+class MemoryScreen : public Screen {
+public:
+  /**
+   * @brief Constructor for MemoryScreen
+   * @param screen_id Unique identifier for the screen
+   * @param monitor Source of the watermarks, sampled by loop()
+   */
+  MemoryScreen(uint8_t screen_id, const MemoryMonitor *monitor)
+      : Screen(screen_id), monitor(monitor) {}
+
+  /**
+   * @brief Draw the heap rows and the visible task rows
+   */
+  void Draw() override {
+    u8g2.setFont(u8g_font_baby);
+    uint8_t alarms = monitor->GetAlarms();
+    char text[32];
+
+    snprintf(text, sizeof(text), "Free %luk  min %luk",
+             (unsigned long)monitor->GetFreeHeap() / 1024,
+             (unsigned long)monitor->GetMinFreeHeap() / 1024);
+    u8g2.drawStr(0, 18, text);
+    snprintf(text, sizeof(text), "Block %luk  min %luk%s",
+             (unsigned long)monitor->GetLargestBlock() / 1024,
+             (unsigned long)monitor->GetMinLargestBlock() / 1024,
+             alarms & kMemoryLowBlock ? " !" : "");
+    u8g2.drawStr(0, 26, text);
+    snprintf(text, sizeof(text), "Frag %u%%  max %u%%%s",
+             monitor->GetFragmentation(), monitor->GetMaxFragmentation(),
+             alarms & kMemoryFragmented ? " !" : "");
+    u8g2.drawStr(0, 34, text);
+
+    for (uint8_t row = 0; row < MEMORY_SCREEN_TASK_ROWS; row++) {
+      uint8_t index = first_task + row;
+      if (index >= monitor->GetNumTasks()) {
+        break;
+      }
+      const TaskWatermark &task = monitor->GetTask(index);
+      if (task.stackFree == 0) {
+        snprintf(text, sizeof(text), "%-10s  -", task.name);
+      } else {
+        snprintf(text, sizeof(text), "%-10s %lu%s", task.name,
+                 (unsigned long)task.stackFree,
+                 task.stackFree < MEMORY_LOW_STACK_BYTES ? " !" : "");
+      }
+      u8g2.drawStr(0, 42 + row * 8, text);
+    }
+  }
+
+  /**
+   * @brief Handle user input for the memory screen
+   * @param input Input value from the user (UP, DOWN, SELECT)
+   * @return NAV_BACK on SELECT, NO_INPUT otherwise
+   */
+  uint8_t HandleInput(uint8_t input) override {
+    if (input == UP &&
+        first_task + MEMORY_SCREEN_TASK_ROWS < monitor->GetNumTasks()) {
+      first_task++;
+    } else if (input == DOWN && first_task > 0) {
+      first_task--;
+    } else if (input == SELECT) {
+      return NAV_BACK;
+    }
+    return NO_INPUT;
+  }
+
+  uint16_t GetRefreshInterval() const override { return MEMORY_SAMPLE_MS; }
+
+private:
+  const MemoryMonitor *monitor; /**< Watermarks to show */
+  uint8_t first_task = 0;       /**< Index of the topmost visible task */
 };
 
 /**
@@ -316,8 +712,10 @@ public:
    * @param t Title string
    * @param d Description string
    * @param c InternalTime object
+   * @param m Memory monitor whose alarms are flagged in the title bar
    */
-  BaseUi(char *t, char *d, InternalTime *c) : title(t), desc(d), time(c) {}
+  BaseUi(char *t, char *d, InternalTime *c, const MemoryMonitor *m = nullptr)
+      : title(t), desc(d), time(c), memory(m) {}
 
   /**
    * @brief Update the title and description
@@ -348,6 +746,11 @@ public:
       u8g2.drawStr(103, 7, time_str);
     }
 
+    // Memory trouble shows on every screen, details on the Memory screen
+    if (memory != NULL && memory->GetAlarms()) {
+      u8g2.drawStr(84, 7, "MEM!");
+    }
+
     u8g2.drawLine(0, SCREEN_HEIGHT - 10, SCREEN_WIDTH, SCREEN_HEIGHT - 10);
     u8g2.drawStr(0, SCREEN_HEIGHT - 2, desc);
   }
@@ -356,5 +759,6 @@ private:
   char *title;        /**< Pointer to the title string */
   char *desc;         /**< Pointer to the description string */
   InternalTime *time; /**< Pointer to the internal time object */
+  const MemoryMonitor *memory; /**< Alarm source, may be NULL */
 };
 #endif // SCREENS_H
\ No newline at end of file
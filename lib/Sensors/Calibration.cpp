@@ -0,0 +1,153 @@
+#include "Calibration.h"
+
+#include <math.h>
+#include <string.h>
+
+#define FIXED_ONE (1L << CALIBRATION_FRAC_BITS)
+#define FIXED_MAX 0x7FFFFFFFL
+#define FIXED_MIN (-FIXED_MAX - 1)
+
+static int32_t saturate(int64_t value) {
+  return value > FIXED_MAX ? FIXED_MAX
+                           : (value < FIXED_MIN ? FIXED_MIN : (int32_t)value);
+}
+
+static int32_t toFixed(float value) {
+  return saturate(llroundf(value * (float)FIXED_ONE));
+}
+
+static float fromFixed(int64_t value) {
+  return value * (1.0f / FIXED_ONE);
+}
+
+CalibrationKind parseCalibrationKind(const char *kind) {
+  if (kind == nullptr) {
+    return kCalibrationNone;
+  }
+  if (strcmp(kind, "linear") == 0) {
+    return kCalibrationLinear;
+  }
+  if (strcmp(kind, "poly") == 0) {
+    return kCalibrationPolynomial;
+  }
+  if (strcmp(kind, "table") == 0) {
+    return kCalibrationTable;
+  }
+  return kCalibrationNone;
+}
+
+const char *calibrationKindName(CalibrationKind kind) {
+  switch (kind) {
+  case kCalibrationLinear:
+    return "linear";
+  case kCalibrationPolynomial:
+    return "poly";
+  case kCalibrationTable:
+    return "table";
+  default:
+    return "none";
+  }
+}
+
+void Calibration::GetPoint(uint8_t index, float &raw, float &value) const {
+  raw = kind == kCalibrationPolynomial ? 0.0f : fromFixed(xs[index]);
+  value = fromFixed(ys[index]);
+}
+
+void Calibration::SetNone() {
+  kind = kCalibrationNone;
+  count = 0;
+}
+
+bool Calibration::SetLinear(float raw1, float value1, float raw2,
+                            float value2) {
+  float raw[2] = {raw1, raw2};
+  float values[2] = {value1, value2};
+  if (raw1 > raw2) {
+    raw[0] = raw2, raw[1] = raw1;
+    values[0] = value2, values[1] = value1;
+  }
+  if (!SetTable(raw, values, 2)) {
+    return false;
+  }
+  kind = kCalibrationLinear;
+  return true;
+}
+
+bool Calibration::SetPolynomial(const float *coefficients,
+                                uint8_t numCoefficients) {
+  SetNone();
+  if (numCoefficients == 0 || numCoefficients > CALIBRATION_MAX_DEGREE + 1) {
+    return false;
+  }
+  for (uint8_t i = 0; i < numCoefficients; i++) {
+    ys[i] = toFixed(coefficients[i]);
+  }
+  count = numCoefficients;
+  kind = kCalibrationPolynomial;
+  return true;
+}
+
+bool Calibration::SetTable(const float *raw, const float *values,
+                           uint8_t numPoints) {
+  SetNone();
+  if (numPoints < 2 || numPoints > CALIBRATION_MAX_POINTS) {
+    return false;
+  }
+  for (uint8_t i = 0; i < numPoints; i++) {
+    xs[i] = toFixed(raw[i]);
+    ys[i] = toFixed(values[i]);
+    if (i > 0 && xs[i] <= xs[i - 1]) {
+      return false;
+    }
+  }
+  // The only divisions: one per segment, here rather than per sample
+  for (uint8_t i = 0; i + 1 < numPoints; i++) {
+    slopes[i] = toFixed((values[i + 1] - values[i]) / (raw[i + 1] - raw[i]));
+  }
+  count = numPoints;
+  kind = kCalibrationTable;
+  return true;
+}
+
+int32_t Calibration::Segment(uint8_t index, int32_t x) const {
+  int64_t offset = (int64_t)x - xs[index];
+  return saturate(ys[index] +
+                  (((int64_t)slopes[index] * offset) >> CALIBRATION_FRAC_BITS));
+}
+
+float Calibration::Apply(float raw) const {
+  if (kind == kCalibrationNone) {
+    return raw;
+  }
+
+  int32_t x = toFixed(raw);
+  int32_t y;
+  switch (kind) {
+  case kCalibrationLinear:
+    y = Segment(0, x);
+    break;
+
+  case kCalibrationTable:
+    if (x <= xs[0]) {
+      y = ys[0];
+    } else if (x >= xs[count - 1]) {
+      y = ys[count - 1];
+    } else {
+      uint8_t i = 0;
+      while (x >= xs[i + 1]) {
+        i++;
+      }
+      y = Segment(i, x);
+    }
+    break;
+
+  default: // Horner's rule, highest coefficient first
+    y = ys[count - 1];
+    for (int8_t i = count - 2; i >= 0; i--) {
+      y = saturate((((int64_t)y * x) >> CALIBRATION_FRAC_BITS) + ys[i]);
+    }
+    break;
+  }
+  return fromFixed(y);
+}
@@ -0,0 +1,86 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <stdint.h>
+
+#define CALIBRATION_MAX_POINTS 8 // Table points, or polynomial coefficients
+#define CALIBRATION_MAX_DEGREE 3
+#define CALIBRATION_FRAC_BITS 16 // Q16.16: +/-32767 with ~0.00002 steps
+
+/**
+ * @brief How a sensor's raw backend reading is turned into its value
+ */
+enum CalibrationKind : uint8_t {
+  kCalibrationNone,       // Raw reading as is
+  kCalibrationLinear,     // Line through two (raw, value) points
+  kCalibrationPolynomial, // c0 + c1*x + c2*x^2 + c3*x^3
+  kCalibrationTable,      // Piecewise linear through up to 8 points
+};
+
+/**
+ * @brief Parse a calibration kind ("none", "linear", "poly", "table")
+ * @return kCalibrationNone for anything unknown
+ */
+CalibrationKind parseCalibrationKind(const char *kind);
+
+/**
+ * @brief Name of a calibration kind, the inverse of parseCalibrationKind()
+ */
+const char *calibrationKindName(CalibrationKind kind);
+
+/**
+ * @brief Per-sensor calibration curve, evaluated in Q16.16 fixed point
+ * @details The Set*() calls do all the float maths and division once, when
+ * the config is loaded: points and coefficients are converted to Q16.16 and
+ * table slopes are precomputed. Apply() runs on every sample and only
+ * multiplies, adds and shifts.
+ */
+class Calibration {
+public:
+  CalibrationKind GetKind() const { return kind; }
+  uint8_t GetCount() const { return count; }
+
+  /**
+   * @brief Point `index` of a linear or table calibration, or coefficient
+   * `index` (as `value`) of a polynomial one
+   */
+  void GetPoint(uint8_t index, float &raw, float &value) const;
+
+  void SetNone();
+
+  /**
+   * @brief Map raw1 to value1 and raw2 to value2, extrapolating beyond
+   * @return false (and no calibration) if raw1 == raw2
+   */
+  bool SetLinear(float raw1, float value1, float raw2, float value2);
+
+  /**
+   * @brief Polynomial in the raw reading, coefficients lowest power first
+   * @return false (and no calibration) for more than 4 coefficients
+   */
+  bool SetPolynomial(const float *coefficients, uint8_t numCoefficients);
+
+  /**
+   * @brief Interpolate between (raw, value) points, clamped at both ends
+   * @param raw Raw readings, strictly increasing
+   * @return false (and no calibration) for fewer than 2 or more than 8
+   * points, or raw readings out of order
+   */
+  bool SetTable(const float *raw, const float *values, uint8_t numPoints);
+
+  /**
+   * @brief Calibrated value of a raw reading
+   */
+  float Apply(float raw) const;
+
+private:
+  int32_t Segment(uint8_t index, int32_t x) const;
+
+  CalibrationKind kind = kCalibrationNone;
+  uint8_t count = 0;
+  int32_t xs[CALIBRATION_MAX_POINTS];    // Raw readings (unused for poly)
+  int32_t ys[CALIBRATION_MAX_POINTS];    // Values, or coefficients for poly
+  int32_t slopes[CALIBRATION_MAX_POINTS]; // Slope of the segment from point i
+};
+
+#endif // CALIBRATION_H
@@ -0,0 +1,45 @@
+#include "PidController.h"
+
+static inline float clampDuty(float value) {
+  return value > 1.0f ? 1.0f : (value < 0.0f ? 0.0f : value);
+}
+
+void PidController::SetGains(float newKp, float newKi, float newKd,
+                             bool newReverse) {
+  kp = newKp;
+  ki = newKi;
+  kd = newKd;
+  if (newReverse != reverse) {
+    reverse = newReverse;
+    Reset();
+  }
+}
+
+void PidController::Reset() {
+  integral = 0.0f;
+  primed = false;
+}
+
+float PidController::Update(float measurement, float dtSeconds) {
+  float error = setpoint - measurement;
+  float change = primed ? measurement - lastMeasurement : 0.0f;
+  if (reverse) {
+    error = -error;
+    change = -change;
+  }
+  lastMeasurement = measurement;
+  primed = true;
+
+  float proportional = kp * error;
+  float derivative =
+      dtSeconds > 0.0f && kd != 0.0f ? -kd * change / dtSeconds : 0.0f;
+
+  float step = ki * error * dtSeconds;
+  float output = proportional + integral + step + derivative;
+  // Only integrate when it doesn't push further into saturation
+  if (!(output > 1.0f && step > 0.0f) && !(output < 0.0f && step < 0.0f)) {
+    integral = clampDuty(integral + step);
+  }
+
+  return clampDuty(proportional + integral + derivative);
+}
@@ -0,0 +1,67 @@
+#ifndef PIDCONTROLLER_H
+#define PIDCONTROLLER_H
+
+#include <stdint.h>
+
+#define PID_INTERVAL_MS 100 // Control rate of proportional outputs
+
+/**
+ * @brief PID loop turning a sensor value into an output duty of 0-1
+ * @details Gains are per second (ki per second of error, kd per unit of
+ * change per second), so retuning isn't needed if the control rate changes.
+ * The derivative acts on the measurement rather than the error, so a new
+ * setpoint doesn't kick the output. Anti-windup is conditional integration:
+ * while the output is saturated the integral only moves back towards the
+ * range, and it is kept within 0-1 itself.
+ */
+class PidController {
+public:
+  /**
+   * @brief Set the gains, keeping the loop's state so tuning is bumpless
+   * @param reverse Raise the output when the value is above the setpoint
+   * (cooling, dehumidifying) instead of below it
+   */
+  void SetGains(float kp, float ki, float kd, bool reverse = false);
+
+  void SetSetpoint(float value) { setpoint = value; }
+  void SetSensorId(uint8_t id) { sensorId = id; }
+
+  float GetKp() const { return kp; }
+  float GetKi() const { return ki; }
+  float GetKd() const { return kd; }
+  bool IsReverse() const { return reverse; }
+  float GetSetpoint() const { return setpoint; }
+  uint8_t GetSensorId() const { return sensorId; }
+
+  // Slot of the sensor, resolved by SensorRelayManager, -1 if missing
+  int8_t GetSensorSlot() const { return sensorSlot; }
+  void SetSensorSlot(int8_t slot) { sensorSlot = slot; }
+
+  /**
+   * @brief Forget the integral and the last measurement
+   */
+  void Reset();
+
+  /**
+   * @brief Run one step of the loop
+   * @param measurement Current sensor value
+   * @param dtSeconds Time since the previous step, 0 on the first
+   * @return Output duty, 0-1
+   */
+  float Update(float measurement, float dtSeconds);
+
+private:
+  float kp = 0.0f;
+  float ki = 0.0f;
+  float kd = 0.0f;
+  bool reverse = false;
+  float setpoint = 0.0f;
+  uint8_t sensorId = 0;
+  int8_t sensorSlot = -1;
+
+  float integral = 0.0f; // Integral term, in output units
+  float lastMeasurement = 0.0f;
+  bool primed = false; // lastMeasurement is valid
+};
+
+#endif // PIDCONTROLLER_H
@@ -0,0 +1,120 @@
+#include "RelayCheckpoint.h"
+#include <Preferences.h>
+#include <esp_attr.h>
+
+// Not touched by the startup code, so it still holds the last run's states
+RTC_NOINIT_ATTR static RelayCheckpointData rtcCheckpoint;
+
+RelayCheckpoint::RelayCheckpoint() : data(rtcCheckpoint) {}
+
+const char *checkpointSourceName(RelayCheckpointSource source) {
+  switch (source) {
+  case kCheckpointRtc:
+    return "RTC memory";
+  case kCheckpointNvs:
+    return "NVS";
+  default:
+    return "none";
+  }
+}
+
+uint32_t RelayCheckpoint::Checksum() const {
+  // FNV-1a over the parts that only change with the config
+  uint32_t hash = 2166136261u;
+  auto mix = [&hash](uint8_t byte) {
+    hash ^= byte;
+    hash *= 16777619u;
+  };
+  mix(data.count);
+  for (uint8_t i = 0; i < data.count; i++) {
+    mix(data.entries[i].id);
+    mix(data.entries[i].io);
+    mix(data.entries[i].pin);
+  }
+  return hash;
+}
+
+RelayCheckpointSource RelayCheckpoint::Begin() {
+  if (data.magic == RELAY_CHECKPOINT_MAGIC && data.count <= MAX_RELAYS &&
+      data.check == Checksum()) {
+    return kCheckpointRtc;
+  }
+
+  Preferences prefs;
+  prefs.begin("relays", true);
+  bool loaded = prefs.getBytesLength("state") == sizeof(data) &&
+                prefs.getBytes("state", &data, sizeof(data)) == sizeof(data);
+  prefs.end();
+  if (loaded && data.magic == RELAY_CHECKPOINT_MAGIC &&
+      data.count <= MAX_RELAYS && data.check == Checksum()) {
+    // The clock restarted with the power, so the switch times are void
+    for (uint8_t i = 0; i < data.count; i++) {
+      data.entries[i].switchedAt = 0;
+    }
+    return kCheckpointNvs;
+  }
+
+  data.magic = 0;
+  data.count = 0;
+  return kCheckpointNone;
+}
+
+bool RelayCheckpoint::Find(uint8_t id, uint8_t io, uint8_t pin, bool &on,
+                           uint32_t &elapsedSeconds) const {
+  if (data.magic != RELAY_CHECKPOINT_MAGIC) {
+    return false;
+  }
+  for (uint8_t i = 0; i < data.count; i++) {
+    const RelayCheckpointEntry &entry = data.entries[i];
+    if (entry.id == id && entry.io == io && entry.pin == pin) {
+      on = entry.on;
+      uint32_t now = time(nullptr);
+      elapsedSeconds = entry.switchedAt && now >= entry.switchedAt
+                           ? now - entry.switchedAt
+                           : 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+void RelayCheckpoint::Set(uint8_t slot, uint8_t id, uint8_t io, uint8_t pin,
+                          bool on, uint32_t elapsedSeconds) {
+  if (slot >= MAX_RELAYS) {
+    return;
+  }
+  data.magic = 0; // A reset before Arm() must not restore a mixed set
+  uint32_t now = time(nullptr);
+  data.entries[slot] = {id, io, pin, on,
+                        now > elapsedSeconds ? now - elapsedSeconds : 0};
+}
+
+void RelayCheckpoint::Arm(uint8_t count) {
+  data.count = count;
+  data.check = Checksum();
+  data.magic = RELAY_CHECKPOINT_MAGIC;
+  armed = true;
+  dirty = true;
+}
+
+bool RelayCheckpoint::SaveIfDue(uint32_t nowMs) {
+  if (!armed || !dirty ||
+      (saved && nowMs - lastSaveMs < RELAY_CHECKPOINT_NVS_MS)) {
+    return false;
+  }
+  Save(nowMs);
+  return true;
+}
+
+void RelayCheckpoint::Save(uint32_t nowMs) {
+  if (!armed) {
+    return;
+  }
+  Preferences prefs;
+  prefs.begin("relays", false);
+  prefs.putBytes("state", &data, sizeof(data));
+  prefs.end();
+  dirty = false;
+  saved = true;
+  lastSaveMs = nowMs;
+}
@@ -0,0 +1,120 @@
+#ifndef RELAYCHECKPOINT_H
+#define RELAYCHECKPOINT_H
+
+#include <stdint.h>
+#include <time.h>
+#include "SensorConfig.h" // MAX_RELAYS
+
+#define RELAY_CHECKPOINT_MAGIC 0x524C5953 // "RLYS"
+#define RELAY_CHECKPOINT_NVS_MS 60000     // Shortest interval between NVS copies
+
+/**
+ * @brief Saved state of one relay slot
+ */
+struct RelayCheckpointEntry {
+  uint8_t id;          // Identify the relay, so a changed config never
+  uint8_t io;          // restores a state onto the wrong output
+  uint8_t pin;
+  uint8_t on;
+  uint32_t switchedAt; // time() of the last switch, 0 if unknown
+};
+
+/**
+ * @brief Layout shared by RTC memory and the NVS copy
+ */
+struct RelayCheckpointData {
+  uint32_t magic;
+  uint32_t check; // Over count and the identity of every entry
+  uint8_t count;
+  RelayCheckpointEntry entries[MAX_RELAYS];
+};
+
+enum RelayCheckpointSource : uint8_t {
+  kCheckpointNone,
+  kCheckpointRtc, // Soft, panic or watchdog reset: states and dwell timers
+  kCheckpointNvs, // Power loss: last throttled copy, dwell timers restart
+};
+
+/**
+ * @brief Relay states kept across resets
+ * @details The live copy is in RTC slow memory, which keeps its contents
+ * through every reset but power loss; a switch only writes its entry's two
+ * words there. The identity part is written and checksummed once per
+ * config, so a reset in the middle of a switch can at worst lose that one
+ * switch. A copy goes to NVS at most every RELAY_CHECKPOINT_NVS_MS for
+ * power cycles.
+ */
+class RelayCheckpoint {
+public:
+  RelayCheckpoint();
+
+  /**
+   * @brief Validate what the previous run left, falling back to NVS
+   * @return Where the states that Find() returns come from
+   */
+  RelayCheckpointSource Begin();
+
+  /**
+   * @brief Saved state of a relay
+   * @param elapsedSeconds Time since it last switched, 0 if unknown
+   * @return false if the checkpoint has no such relay
+   */
+  bool Find(uint8_t id, uint8_t io, uint8_t pin, bool &on,
+            uint32_t &elapsedSeconds) const;
+
+  /**
+   * @brief Stop recording while the relay set changes; what was saved
+   * stays readable by Find() until the first Set()
+   */
+  void Disarm() { armed = false; }
+
+  /**
+   * @brief Describe a slot of the new relay set (invalidates the old one
+   * until Arm())
+   */
+  void Set(uint8_t slot, uint8_t id, uint8_t io, uint8_t pin, bool on,
+           uint32_t elapsedSeconds);
+
+  /**
+   * @brief Start recording the `count` slots given to Set()
+   */
+  void Arm(uint8_t count);
+
+  /**
+   * @brief Record a switch (control path: two word writes)
+   */
+  void Record(uint8_t slot, bool on) {
+    if (armed && slot < data.count) {
+      data.entries[slot].on = on;
+      data.entries[slot].switchedAt = time(nullptr);
+      dirty = true;
+    }
+  }
+
+  /**
+   * @brief Copy to NVS if something changed and the last copy is old enough
+   * @return true if it wrote
+   */
+  bool SaveIfDue(uint32_t nowMs);
+
+  /**
+   * @brief Copy to NVS now, e.g. before a planned reboot
+   */
+  void Save(uint32_t nowMs);
+
+private:
+  uint32_t Checksum() const;
+
+  RelayCheckpointData &data; // In RTC memory
+  bool armed = false;
+  bool dirty = false;
+  bool saved = false;        // lastSaveMs is valid
+  uint32_t lastSaveMs = 0;
+};
+
+/**
+ * @brief Human-readable name of a checkpoint source
+ */
+const char *checkpointSourceName(RelayCheckpointSource source);
+
+#endif // RELAYCHECKPOINT_H
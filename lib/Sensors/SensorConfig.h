@@ -0,0 +1,44 @@
+#ifndef SENSORCONFIG_H
+#define SENSORCONFIG_H
+
+#include <stdint.h>
+
+/**
+ * @brief Capacities of SensorRelayManager
+ * @details Everything is sized at compile time from these. Override them from
+ * build_flags (see the esp32dev-large environment in platformio.ini) to build
+ * a bigger controller without touching the code.
+ */
+#ifndef MAX_SENSORS
+#define MAX_SENSORS 10
+#endif
+
+#ifndef MAX_RELAYS
+#define MAX_RELAYS 10
+#endif
+
+#ifndef MAX_CONDITIONS
+#define MAX_CONDITIONS 12 // Per relay, sensor conditions and groups together
+#endif
+
+#define MAX_CONDITION_OPS (2 * MAX_CONDITIONS + 1)
+
+// Condition::sensorSlot is an int8_t
+static_assert(MAX_SENSORS <= 127, "MAX_SENSORS must fit a sensor slot");
+// RelayMask has one bit per relay
+static_assert(MAX_RELAYS <= 64, "MAX_RELAYS must fit a RelayMask");
+// Program jump targets and leaf indices are uint8_t
+static_assert(MAX_CONDITION_OPS <= 255, "MAX_CONDITIONS is too large");
+
+/**
+ * @brief One bit per relay slot, used by the sensor-to-relay index
+ */
+#if MAX_RELAYS <= 32
+typedef uint32_t RelayMask;
+#define RELAY_MASK_LOWEST_BIT(mask) __builtin_ctz(mask)
+#else
+typedef uint64_t RelayMask;
+#define RELAY_MASK_LOWEST_BIT(mask) __builtin_ctzll(mask)
+#endif
+
+#endif // SENSORCONFIG_H
@@ -0,0 +1,80 @@
+#include "SensorFilter.h"
+
+void SensorFilter::SetMedian(uint8_t newWindow) {
+  if (newWindow > FILTER_MAX_WINDOW) {
+    newWindow = FILTER_MAX_WINDOW;
+  }
+  window = newWindow > 1 ? newWindow | 1 : 0;
+  Reset();
+}
+
+void SensorFilter::SetEma(float newAlpha) {
+  alpha = newAlpha > 0.0f && newAlpha < 1.0f ? newAlpha : 0.0f;
+  Reset();
+}
+
+void SensorFilter::SetKalman(float newProcessNoise, float newMeasurementNoise) {
+  if (newMeasurementNoise > 0.0f && newProcessNoise >= 0.0f) {
+    processNoise = newProcessNoise;
+    measurementNoise = newMeasurementNoise;
+  } else {
+    processNoise = measurementNoise = 0.0f;
+  }
+  Reset();
+}
+
+void SensorFilter::Reset() {
+  count = 0;
+  head = 0;
+  primed = false;
+}
+
+float SensorFilter::Median(float sample) {
+  samples[head] = sample;
+  head = head + 1 == window ? 0 : head + 1;
+  if (count < window) {
+    count++;
+  }
+
+  // Rank selection: the median is the sample with as many others below it as
+  // above. Branch-free counting over at most 9 samples beats keeping a
+  // sorted copy up to date.
+  uint8_t middle = count / 2;
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t below = 0;
+    uint8_t equal = 0;
+    for (uint8_t j = 0; j < count; j++) {
+      below += samples[j] < samples[i];
+      equal += samples[j] == samples[i];
+    }
+    if (below <= middle && middle < below + equal) {
+      return samples[i];
+    }
+  }
+  return sample; // Only reached with NaN in the window
+}
+
+float SensorFilter::Apply(float sample) {
+  float value = window > 1 ? Median(sample) : sample;
+
+  if (!primed) {
+    average = estimate = value;
+    variance = measurementNoise;
+    primed = true;
+    return value;
+  }
+
+  if (alpha > 0.0f) {
+    average += alpha * (value - average);
+    value = average;
+  }
+
+  if (measurementNoise > 0.0f) {
+    variance += processNoise;
+    float gain = variance / (variance + measurementNoise);
+    estimate += gain * (value - estimate);
+    variance *= 1.0f - gain;
+    value = estimate;
+  }
+  return value;
+}
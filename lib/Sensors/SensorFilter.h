@@ -0,0 +1,78 @@
+#ifndef SENSORFILTER_H
+#define SENSORFILTER_H
+
+#include <stdint.h>
+
+#define FILTER_MAX_WINDOW 9 // Longest moving median, odd
+
+/**
+ * @brief Per-sensor smoothing: moving median -> EMA -> 1-D Kalman
+ * @details Every stage is optional and off by default. The median rejects
+ * spikes before they can drag the averages, the EMA smooths, and the Kalman
+ * stage tracks a slowly drifting value given its process and measurement
+ * noise. Memory is fixed (one window of samples) and the median's inner loop
+ * is branch-free so the compiler can unroll and pipeline it.
+ */
+class SensorFilter {
+public:
+  /**
+   * @brief Moving median over `window` samples (0 or 1 = off, even sizes
+   * are rounded up, capped at FILTER_MAX_WINDOW)
+   */
+  void SetMedian(uint8_t window);
+
+  /**
+   * @brief Exponential moving average, y += alpha * (x - y)
+   * @param alpha Weight of a new sample, 0 or >= 1 = off
+   */
+  void SetEma(float alpha);
+
+  /**
+   * @brief 1-D Kalman filter for a random-walk value
+   * @param processNoise Variance the true value drifts by per sample (q)
+   * @param measurementNoise Variance of a sample (r), <= 0 = off
+   */
+  void SetKalman(float processNoise, float measurementNoise);
+
+  uint8_t GetMedianWindow() const { return window; }
+  float GetEmaAlpha() const { return alpha; }
+  float GetProcessNoise() const { return processNoise; }
+  float GetMeasurementNoise() const { return measurementNoise; }
+  bool IsEnabled() const {
+    return window > 1 || alpha > 0.0f || measurementNoise > 0.0f;
+  }
+
+  /**
+   * @brief Forget the history, the next sample passes straight through
+   */
+  void Reset();
+
+  /**
+   * @brief Filter one new sample
+   * @return The filtered value
+   */
+  float Apply(float sample);
+
+private:
+  float Median(float sample);
+
+  // Moving median
+  uint8_t window = 0;
+  uint8_t count = 0; // Samples in the window so far
+  uint8_t head = 0;  // Slot the next sample goes in
+  float samples[FILTER_MAX_WINDOW];
+
+  // EMA
+  float alpha = 0.0f;
+  float average = 0.0f;
+
+  // Kalman
+  float processNoise = 0.0f;
+  float measurementNoise = 0.0f;
+  float estimate = 0.0f;
+  float variance = 0.0f;
+
+  bool primed = false; // EMA and Kalman have a starting value
+};
+
+#endif // SENSORFILTER_H
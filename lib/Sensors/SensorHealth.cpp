@@ -0,0 +1,144 @@
+#include "SensorHealth.h"
+
+#include <math.h>
+
+const char *sensorFaultName(SensorFault fault) {
+  switch (fault) {
+  case kSensorStale:
+    return "stale";
+  case kSensorClipped:
+    return "clipped";
+  case kSensorOutOfRange:
+    return "range";
+  case kSensorRateLimit:
+    return "rate";
+  case kSensorStuck:
+    return "stuck";
+  default:
+    return "ok";
+  }
+}
+
+void SensorHealth::SetRange(float newMin, float newMax) {
+  if (newMin < newMax) {
+    min = newMin;
+    max = newMax;
+  } else {
+    min = max = 0.0f;
+  }
+}
+
+void SensorHealth::SetMaxRate(float perSecond) {
+  maxRate = perSecond > 0.0f ? perSecond : 0.0f;
+}
+
+void SensorHealth::SetStuckSeconds(uint16_t seconds) {
+  stuckSeconds = seconds;
+  stuck = false;
+  windowSamples = 0;
+}
+
+void SensorHealth::SetStaleSeconds(uint16_t seconds) {
+  staleSeconds = seconds;
+}
+
+void SensorHealth::SetClipDetection(bool enabled) {
+  clipDetection = enabled;
+  railSamples = 0;
+}
+
+void SensorHealth::Reset() {
+  fault = kSensorOk;
+  cleanSamples = 0;
+  railSamples = 0;
+  started = false;
+  hasValue = false;
+  stuck = false;
+  windowSamples = 0;
+}
+
+bool SensorHealth::Report(SensorFault detected) {
+  if (detected != kSensorOk) {
+    cleanSamples = 0;
+    if (fault == detected) {
+      return false;
+    }
+    fault = detected;
+    return true;
+  }
+
+  if (fault == kSensorOk || ++cleanSamples < HEALTH_RECOVERY_SAMPLES) {
+    return false;
+  }
+  fault = kSensorOk;
+  cleanSamples = 0;
+  return true;
+}
+
+bool SensorHealth::Sample(float raw, float value, bool atRail, uint32_t nowMs) {
+  SensorFault detected = kSensorOk;
+
+  if (clipDetection) {
+    railSamples = atRail ? (railSamples < HEALTH_CLIP_SAMPLES ? railSamples + 1
+                                                              : railSamples)
+                         : 0;
+    if (railSamples >= HEALTH_CLIP_SAMPLES) {
+      detected = kSensorClipped;
+    }
+  }
+
+  if (detected == kSensorOk && min < max && !(value >= min && value <= max)) {
+    detected = kSensorOutOfRange; // Written so NaN lands here too
+  }
+
+  // Compare against rate * dt instead of dividing by dt
+  if (detected == kSensorOk && maxRate > 0.0f && hasValue &&
+      nowMs != lastSampleMs &&
+      fabsf(value - lastValue) > maxRate * (nowMs - lastSampleMs) * 0.001f) {
+    detected = kSensorRateLimit;
+  }
+
+  if (stuckSeconds > 0) {
+    if (windowSamples == 0) {
+      windowStartMs = nowMs;
+      windowOrigin = raw;
+      windowSum = windowSumSquares = 0.0f;
+    }
+    float offset = raw - windowOrigin;
+    windowSum += offset;
+    windowSumSquares += offset * offset;
+    windowSamples++;
+
+    if (nowMs - windowStartMs >= stuckSeconds * 1000UL) {
+      float mean = windowSum / windowSamples;
+      stuck = windowSamples > 1 &&
+              windowSumSquares / windowSamples - mean * mean <=
+                  HEALTH_STUCK_VARIANCE;
+      windowSamples = 0;
+    }
+    if (detected == kSensorOk && stuck) {
+      detected = kSensorStuck;
+    }
+  }
+
+  started = hasValue = true;
+  lastSampleMs = nowMs;
+  lastValue = value;
+  return Report(detected);
+}
+
+bool SensorHealth::Check(uint32_t nowMs) {
+  if (staleSeconds == 0) {
+    return false;
+  }
+  if (!started) {
+    // Give a sensor that never reported the same grace period from now
+    started = true;
+    lastSampleMs = nowMs;
+    return false;
+  }
+  if (nowMs - lastSampleMs < staleSeconds * 1000UL) {
+    return false;
+  }
+  return Report(kSensorStale);
+}
@@ -0,0 +1,124 @@
+#ifndef SENSORHEALTH_H
+#define SENSORHEALTH_H
+
+#include <stdint.h>
+
+#define HEALTH_RECOVERY_SAMPLES 5 // Clean samples before a fault clears
+#define HEALTH_CLIP_SAMPLES 5     // Samples at a rail before it's a fault
+#define HEALTH_STUCK_VARIANCE 1e-9f // Raw variance this low counts as stuck
+#define HEALTH_DEFAULT_STALE_S 30
+
+/**
+ * @brief Why a sensor isn't trusted, most severe first where it matters
+ */
+enum SensorFault : uint8_t {
+  kSensorOk,
+  kSensorStale,      // No new sample for too long (disconnected / dead bus)
+  kSensorClipped,    // Raw reading pinned at the backend's rail
+  kSensorOutOfRange, // Value outside the plausible range
+  kSensorRateLimit,  // Value changed faster than physically possible
+  kSensorStuck,      // Raw reading hasn't moved at all for too long
+};
+
+/**
+ * @brief Short name of a fault ("ok", "stale", ...), for the API and OLED
+ */
+const char *sensorFaultName(SensorFault fault);
+
+/**
+ * @brief Per-sensor plausibility checks, run on every sample
+ * @details Each check is optional. Sample() costs a handful of compares and
+ * multiply-adds: the stuck check keeps a running sum and sum of squares over
+ * a time window instead of a sample history. A fault is raised on the first
+ * bad sample and only cleared after HEALTH_RECOVERY_SAMPLES clean ones, so a
+ * flaky sensor can't toggle relays in and out of their fail-safe state.
+ */
+class SensorHealth {
+public:
+  /**
+   * @brief Plausible values (after calibration); min >= max = off
+   */
+  void SetRange(float min, float max);
+
+  /**
+   * @brief Largest believable change of the value per second, 0 = off
+   */
+  void SetMaxRate(float perSecond);
+
+  /**
+   * @brief Flag a raw reading that hasn't moved for this long, 0 = off
+   * @note Only for signals that always carry some noise, like analog inputs
+   */
+  void SetStuckSeconds(uint16_t seconds);
+
+  /**
+   * @brief Flag a sensor without a new sample for this long, 0 = off
+   */
+  void SetStaleSeconds(uint16_t seconds);
+
+  /**
+   * @brief Flag raw readings pinned at the backend's rail
+   */
+  void SetClipDetection(bool enabled);
+
+  float GetMin() const { return min; }
+  float GetMax() const { return max; }
+  float GetMaxRate() const { return maxRate; }
+  uint16_t GetStuckSeconds() const { return stuckSeconds; }
+  uint16_t GetStaleSeconds() const { return staleSeconds; }
+  bool GetClipDetection() const { return clipDetection; }
+
+  SensorFault GetFault() const { return fault; }
+  bool IsFaulted() const { return fault != kSensorOk; }
+
+  /**
+   * @brief Forget all history (the sensor starts out healthy)
+   */
+  void Reset();
+
+  /**
+   * @brief Check a new sample
+   * @param raw Reading from the backend
+   * @param value Calibrated value
+   * @param atRail Whether the backend reports `raw` at its rail
+   * @param nowMs Current millis()
+   * @return true if the fault state changed
+   */
+  bool Sample(float raw, float value, bool atRail, uint32_t nowMs);
+
+  /**
+   * @brief Check for staleness when there was no new sample
+   * @return true if the fault state changed
+   */
+  bool Check(uint32_t nowMs);
+
+private:
+  bool Report(SensorFault detected);
+
+  // Configuration
+  float min = 0.0f;
+  float max = 0.0f;
+  float maxRate = 0.0f;
+  uint16_t stuckSeconds = 0;
+  uint16_t staleSeconds = HEALTH_DEFAULT_STALE_S;
+  bool clipDetection = false;
+
+  // State
+  SensorFault fault = kSensorOk;
+  uint8_t cleanSamples = 0;
+  uint8_t railSamples = 0;
+  bool started = false; // lastSampleMs is valid
+  bool hasValue = false; // lastValue is valid
+  bool stuck = false;
+  uint32_t lastSampleMs = 0;
+  float lastValue = 0.0f;
+
+  // Stuck window, accumulated relative to its first sample for precision
+  uint32_t windowStartMs = 0;
+  uint16_t windowSamples = 0;
+  float windowOrigin = 0.0f;
+  float windowSum = 0.0f;
+  float windowSumSquares = 0.0f;
+};
+
+#endif // SENSORHEALTH_H
@@ -4,13 +4,57 @@
 #include <Arduino.h>
 #include <ArduinoJson.h> // Ensure ArduinoJson.h is included
 #include <Preferences.h> // Ensure Preferences.h is included for SaveToPreferences
+#include <IoBackend.h>
+#include <Logger.h>
+#include <Metrics.h>
+#include <Schedule.h>
+#include <atomic>
+#include <mutex>
+
+#include "Calibration.h"
+#include "PidController.h"
+#include "RelayCheckpoint.h"
+#include "SensorFilter.h"
+#include "SensorHealth.h"
+
+#include "SensorConfig.h" // MAX_SENSORS, MAX_RELAYS, MAX_CONDITIONS
+
+#define MAX_GROUP_DEPTH 4 // Deeper (or circular) groups evaluate to false
+#define SCHEDULE_MAX_CATCHUP_S 600 // Bigger clock jumps re-arm every schedule
+
+/**
+ * @brief Comparison operators, parsed once from the operator string
+ */
+enum CompareOp : uint8_t {
+  kGreater,
+  kLess,
+  kGreaterEqual,
+  kLessEqual,
+  kEqual,
+  kNotEqual,
+  kInvalidOp
+};
 
 /**
- * @brief Maximum number of sensors, relays, and conditions
+ * @brief What a condition is, taken from its type string
+ * @details "sensor" compares a sensor value and "schedule" is true inside a
+ * time window; "and", "or" and "not" are groups whose members point at them
+ * through their parent id. Top level conditions (parent 0) are ANDed
+ * together.
  */
-#define MAX_SENSORS 10
-#define MAX_RELAYS 10
-#define MAX_CONDITIONS 5
+enum ConditionKind : uint8_t {
+  kSensorCondition,
+  kScheduleCondition,
+  kAndGroup,
+  kOrGroup,
+  kNotGroup
+};
+
+CompareOp parseCompareOp(const char *op);
+ConditionKind parseConditionKind(const char *type);
+bool compareValues(CompareOp op, float sensorValue, float conditionValue);
+bool evaluateCondition(const char *op, float sensorValue, float conditionValue);
+void onScheduleEdge(TimerWheel &wheel, TimerNode *node, uint32_t now);
 
 /**
  * @brief Class representing a condition for a relay
@@ -18,9 +62,16 @@
 class Condition {
 public:
   Condition(uint8_t sensor, uint8_t sensorId, const char *op, float value,
-            uint8_t id, const char *type)
+            uint8_t id, const char *type, float hysteresis = 0.0f,
+            uint16_t holdSeconds = 0, uint8_t parent = 0)
       : sensor(sensor), sensorId(sensorId), operator_(op ? op : ""),
-        value(value), id(id), type_(type ? type : "") {}
+        value(value), id(id), type_(type ? type : ""),
+        hysteresis(hysteresis), holdSeconds(holdSeconds), parent(parent),
+        compare(parseCompareOp(op ? op : "")),
+        kind(parseConditionKind(type ? type : "")) {
+    timer.callback = onScheduleEdge;
+    timer.context = this;
+  }
 
   uint8_t GetSensor() const { return sensor; }
   uint8_t GetSensorId() const { return sensorId; }
@@ -28,6 +79,58 @@ public:
   float GetValue() const { return value; }
   uint8_t GetId() const { return id; }
   const char *GetType() const { return type_.c_str(); }
+  float GetHysteresis() const { return hysteresis; }
+  uint16_t GetHoldSeconds() const { return holdSeconds; }
+  uint8_t GetParent() const { return parent; }
+  ConditionKind GetKind() const { return kind; }
+  bool IsGroup() const { return kind >= kAndGroup; }
+  bool IsSchedule() const { return kind == kScheduleCondition; }
+  const Schedule &GetSchedule() const { return schedule; }
+
+  void SetSchedule(uint32_t period, uint32_t start, uint32_t duration) {
+    schedule.period = period;
+    schedule.start = start;
+    schedule.duration = duration;
+  }
+
+  /**
+   * @brief Set the schedule state for `now` and arm the timer for its next
+   * edge, after which the timer keeps re-arming itself
+   */
+  void ArmSchedule(TimerWheel &wheel, uint32_t now) {
+    state = schedule.IsActive(now);
+    uint32_t edge = schedule.NextEdge(now);
+    if (edge) {
+      wheel.Schedule(&timer, edge);
+    } else {
+      wheel.Cancel(&timer);
+    }
+  }
+
+  // Hysteresis and hold times need every sample, so these can't be skipped
+  bool IsStateful() const { return hysteresis > 0.0f || holdSeconds > 0; }
+
+  // Result of the last Evaluate() call
+  bool GetState() const { return state; }
+
+  // True while the comparison holds but the hold time hasn't passed yet
+  bool IsHolding() const { return rawState && !state; }
+
+  // Slot of the sensor in SensorRelayManager::sensors, -1 if missing
+  int8_t GetSensorSlot() const { return sensorSlot; }
+  void SetSensorSlot(int8_t slot) { sensorSlot = slot; }
+
+  // Forget the latch and hold timer, e.g. while the sensor is missing
+  void Invalidate() { rawState = state = false; }
+
+  /**
+   * @brief Evaluate the condition with hysteresis and hold time applied
+   * @param sensorValue The current sensor value
+   * @param nowMs Current millis()
+   * @return bool True once the comparison has held for GetHoldSeconds()
+   * @note Must be called every tick so the hold timer sees every sample
+   */
+  bool Evaluate(float sensorValue, uint32_t nowMs);
 
 private:
   uint8_t sensor;
@@ -36,46 +139,157 @@ private:
   float value;
   uint8_t id;
   String type_;
+  float hysteresis;     // Band the value must move back through to release
+  uint16_t holdSeconds; // How long the comparison must stay true
+  uint8_t parent;       // Id of the enclosing group, 0 for top level
+  CompareOp compare;
+  ConditionKind kind;
+
+  Schedule schedule;       // Window for schedule conditions
+  TimerNode timer;         // Fires at the schedule's next edge
+  int8_t sensorSlot = -1;  // Resolved sensorId, see SensorRelayManager
+
+  bool rawState = false;  // Comparison result (with hysteresis) last tick
+  bool state = false;     // Final result last tick
+  uint32_t trueSince = 0; // millis() when the comparison became true
+};
+
+enum ConditionOpCode : uint8_t {
+  kOpLeaf,        // acc = condition[arg]
+  kOpConst,       // acc = arg
+  kOpNot,         // acc = !acc
+  kOpJumpIfFalse, // if (!acc) pc = arg
+  kOpJumpIfTrue   // if (acc) pc = arg
 };
 
 /**
- * @brief Class representing a sensor
+ * @brief One instruction of a compiled condition tree
+ * @details Members are evaluated one after another into a single
+ * accumulator, and a group jumps past its remaining members as soon as the
+ * result is decided, so no value stack is needed.
+ */
+struct ConditionOp {
+  ConditionOpCode code;
+  uint8_t arg;
+};
+
+/**
+ * @brief Class representing a sensor's configuration
+ * @note The live value is kept by SensorRelayManager (sensorValues)
  */
 class Sensor {
 public:
-  Sensor(uint8_t id, const char *name, uint8_t pin, float value,
-         bool folded = true)
-      : id(id), name(name ? name : ""), pin(pin), value(value), folded(folded) {
-  }
+  Sensor(uint8_t id, const char *name, uint8_t pin, bool folded = true,
+         uint8_t io = IO_NATIVE)
+      : id(id), name(name ? name : ""), pin(pin), folded(folded), io(io) {}
 
-  void SetValue(float newValue) { value = newValue; }
   uint8_t GetId() const { return id; }
   const char *GetName() const { return name.c_str(); }
   uint8_t GetPin() const { return pin; }
-  float GetValue() const { return value; }
   bool GetFolded() const { return folded; }
+  uint8_t GetIo() const { return io; }
+  Calibration &GetCalibration() { return calibration; }
+  const Calibration &GetCalibration() const { return calibration; }
+  SensorFilter &GetFilter() { return filter; }
+  const SensorFilter &GetFilter() const { return filter; }
+  SensorHealth &GetHealth() { return health; }
+  const SensorHealth &GetHealth() const { return health; }
 
 private:
   uint8_t id;
   String name;
-  uint8_t pin;
-  float value;
+  uint8_t pin; // Pin or channel on the backend
   bool folded;
+  uint8_t io;  // IoBackend id (IO_NATIVE, IO_ADS1115, ...)
+  Calibration calibration; // Raw backend reading -> value
+  SensorFilter filter;     // Applied to the calibrated value
+  SensorHealth health;     // Fault checks on every sample
+};
+
+/**
+ * @brief What a relay does while a sensor its conditions read is faulted
+ */
+enum FailSafeMode : uint8_t {
+  kFailSafeOff,  // Switch off (the default)
+  kFailSafeOn,   // Switch on, e.g. a cooling fan
+  kFailSafeHold, // Stay in the current state
 };
 
 /**
- * @brief Class representing a relay
+ * @brief Parse a fail-safe mode ("off", "on", "hold")
+ * @return kFailSafeOff for anything unknown
+ */
+FailSafeMode parseFailSafeMode(const char *mode) {
+  if (mode && strcmp(mode, "on") == 0) {
+    return kFailSafeOn;
+  }
+  if (mode && strcmp(mode, "hold") == 0) {
+    return kFailSafeHold;
+  }
+  return kFailSafeOff;
+}
+
+/**
+ * @brief Name of a fail-safe mode, the inverse of parseFailSafeMode()
+ */
+const char *failSafeModeName(FailSafeMode mode) {
+  return mode == kFailSafeOn ? "on" : (mode == kFailSafeHold ? "hold" : "off");
+}
+
+/**
+ * @brief How a relay is driven
+ */
+enum RelayOutput : uint8_t {
+  kOutputSwitch,           // On/off from its conditions
+  kOutputPwm,              // PID duty on a hardware PWM output
+  kOutputTimeProportional, // PID duty as on-time per window, for relays
+};
+
+#define DEFAULT_PWM_FREQUENCY 1000 // Hz
+#define DEFAULT_PWM_WINDOW_S 10
+
+/**
+ * @brief Class representing a relay's configuration and conditions
+ * @note The on/off state is kept by SensorRelayManager (relayStatuses)
  */
 class Relay {
 public:
-  Relay(uint8_t id, const char *name, uint8_t pin, bool status = false,
-        bool folded = false)
-      : id(id), name(name ? name : ""), pin(pin), status(status),
-        folded(folded) {
+  Relay(uint8_t id, const char *name, uint8_t pin, bool folded = false,
+        uint16_t minOnSeconds = 0, uint16_t minOffSeconds = 0,
+        uint8_t io = IO_NATIVE)
+      : id(id), name(name ? name : ""), pin(pin), folded(folded), io(io),
+        minOnSeconds(minOnSeconds),
+        minOffSeconds(minOffSeconds) {
     for (int i = 0; i < MAX_CONDITIONS; i++) {
       conditions[i] = nullptr;
     }
   }
+  Relay(const Relay &) = delete;
+  Relay &operator=(const Relay &) = delete;
+
+  ~Relay() {
+    for (int i = 0; i < MAX_CONDITIONS; i++) {
+      delete conditions[i];
+    }
+  }
+
+  /**
+   * @brief Rebuild the condition program (call after changing conditions)
+   * @details Walks the group tree from the top level, putting the cheapest
+   * members of every group first so short-circuiting skips the most work.
+   */
+  void Compile();
+
+  const ConditionOp *GetProgram() const { return program; }
+  uint8_t GetProgramLength() const { return programLength; }
+
+  /**
+   * @brief Whether the relay has to be looked at again without any input
+   * changing: a hold time is running, or a switch is waiting out the
+   * minimum on/off time
+   */
+  bool IsPending() const { return pending; }
+  void SetPending(bool isPending) { pending = isPending; }
 
   void AddCondition(Condition *condition) {
     for (int i = 0; i < MAX_CONDITIONS; i++) {
@@ -86,9 +300,20 @@ public:
     }
   }
 
-  void SetStatus(bool newStatus) { status = newStatus; }
-  void ToggleStatus() { status = !status; }
-  bool IsOn() const { return status; }
+  /**
+   * @brief Check whether the relay has dwelt long enough in its state
+   * @param isOn The relay's current state
+   * @param nowMs Current millis()
+   * @return bool True once the minimum on (or off) time has passed
+   */
+  bool CanSwitch(bool isOn, uint32_t nowMs) const {
+    uint32_t dwell = (isOn ? minOnSeconds : minOffSeconds) * 1000UL;
+    return nowMs - lastChangeMs >= dwell;
+  }
+
+  // Restart the dwell timer after the relay switched
+  void MarkSwitched(uint32_t nowMs) { lastChangeMs = nowMs; }
+  uint32_t GetLastChangeMs() const { return lastChangeMs; }
   void MoveCondition(uint8_t conditionId, const char *direction) {
     int currentIndex = -1;
     for (int i = 0; i < MAX_CONDITIONS; i++) {
@@ -115,13 +340,51 @@ public:
       conditions[currentIndex] = conditions[currentIndex + 1];
       conditions[currentIndex + 1] = temp;
     }
+    Compile();
   }
 
   uint8_t GetId() const { return id; }
   const char *GetName() const { return name.c_str(); }
   uint8_t GetPin() const { return pin; }
-  bool GetStatus() const { return status; }
   bool GetFolded() const { return folded; }
+  uint8_t GetIo() const { return io; }
+  uint16_t GetMinOnSeconds() const { return minOnSeconds; }
+  uint16_t GetMinOffSeconds() const { return minOffSeconds; }
+  FailSafeMode GetFailSafe() const { return failSafe; }
+  void SetFailSafe(FailSafeMode mode) { failSafe = mode; }
+
+  /**
+   * @brief Drive the relay from its PID loop instead of its conditions
+   * @param mode kOutputPwm or kOutputTimeProportional, kOutputSwitch to go
+   * back to conditions
+   * @param frequency PWM frequency in Hz (kOutputPwm)
+   * @param windowSeconds Length of one on/off cycle (kOutputTimeProportional)
+   */
+  void SetOutput(RelayOutput mode, uint32_t frequency = DEFAULT_PWM_FREQUENCY,
+                 uint16_t windowSeconds = DEFAULT_PWM_WINDOW_S) {
+    output = mode;
+    pwmFrequency = frequency ? frequency : DEFAULT_PWM_FREQUENCY;
+    pwmWindowSeconds = windowSeconds ? windowSeconds : DEFAULT_PWM_WINDOW_S;
+  }
+  RelayOutput GetOutput() const { return output; }
+  bool IsProportional() const { return output != kOutputSwitch; }
+  uint32_t GetPwmFrequency() const { return pwmFrequency; }
+  uint16_t GetPwmWindowSeconds() const { return pwmWindowSeconds; }
+  PidController &GetPid() { return pid; }
+  const PidController &GetPid() const { return pid; }
+
+  /**
+   * @brief How far into its time-proportioning window the relay is, 0-1
+   */
+  float WindowPhase(uint32_t nowMs) {
+    uint32_t period = pwmWindowSeconds * 1000UL;
+    uint32_t elapsed = nowMs - windowStartMs;
+    if (elapsed >= period) {
+      windowStartMs += elapsed - elapsed % period;
+      elapsed %= period;
+    }
+    return (float)elapsed / period;
+  }
   Condition *GetCondition(uint8_t index) const {
     return (index < MAX_CONDITIONS) ? conditions[index] : nullptr;
   }
@@ -131,9 +394,79 @@ public:
 private:
   uint8_t id;
   String name;
-  uint8_t pin;
-  bool status;
+  uint8_t pin; // Pin or channel on the backend
   bool folded;
+  uint8_t io;  // IoBackend id (IO_NATIVE, IO_MCP23017, ...)
+  uint16_t minOnSeconds;     // Shortest time to stay on once switched on
+  uint16_t minOffSeconds;    // Shortest time to stay off once switched off
+  uint32_t lastChangeMs = 0; // millis() of the last switch
+  bool pending = false;      // See IsPending()
+  FailSafeMode failSafe = kFailSafeOff;
+
+  // Proportional control, see SetOutput()
+  RelayOutput output = kOutputSwitch;
+  uint32_t pwmFrequency = DEFAULT_PWM_FREQUENCY;
+  uint16_t pwmWindowSeconds = DEFAULT_PWM_WINDOW_S;
+  uint32_t windowStartMs = 0;
+  PidController pid;
+
+  ConditionOp program[MAX_CONDITION_OPS];
+  uint8_t programLength = 0;
+
+  int FindGroup(uint8_t groupId) const;
+  uint8_t ParentOf(uint8_t index) const;
+  bool IsCircular(uint8_t index) const;
+  uint8_t Cost(uint8_t index, uint8_t depth) const;
+  void CompileNode(uint8_t index, uint8_t depth);
+  void CompileGroup(uint8_t groupId, ConditionKind kind, uint8_t depth);
+  uint8_t Emit(ConditionOpCode code, uint8_t arg = 0);
+};
+
+/**
+ * @brief Sensors and relays parsed from a config, not in use yet
+ * @details Built wherever a config comes from (NVS at boot, the settings
+ * page) and handed to SensorRelayManager::ApplyConfig(), which takes the
+ * objects over. Whatever is still in it is deleted with it.
+ */
+struct SensorRelayConfig {
+  Sensor *sensors[MAX_SENSORS] = {};
+  Relay *relays[MAX_RELAYS] = {};
+  uint8_t numSensors = 0;
+  uint8_t numRelays = 0;
+
+  SensorRelayConfig() = default;
+  SensorRelayConfig(const SensorRelayConfig &) = delete;
+  SensorRelayConfig &operator=(const SensorRelayConfig &) = delete;
+
+  ~SensorRelayConfig() {
+    for (uint8_t i = 0; i < numSensors; i++) {
+      delete sensors[i];
+    }
+    for (uint8_t i = 0; i < numRelays; i++) {
+      delete relays[i];
+    }
+  }
+};
+
+/**
+ * @brief State a relay keeps when a new config still has it on the same
+ * output
+ */
+struct RelayCarryOver {
+  bool on;
+  float duty;
+  uint32_t lastChangeMs;
+};
+
+/**
+ * @brief New PID settings for one relay, NAN for a value that stays
+ */
+struct PidTuning {
+  uint8_t relayId;
+  float setpoint;
+  float kp;
+  float ki;
+  float kd;
 };
 
 /**
@@ -150,61 +483,270 @@ public:
     }
   }
 
-  ~SensorRelayManager() { Clear(); }
+  ~SensorRelayManager() {
+    Clear();
+    delete queuedConfig.load();
+    delete queuedPidTuning.load();
+  }
 
+  /**
+   * @brief Switch every relay off and drop all sensors and relays
+   */
   void Clear() {
-    for (int i = 0; i < MAX_SENSORS; i++) {
-      delete sensors[i];
-      sensors[i] = nullptr;
-    }
-    num_sensors = 0;
-
-    for (int i = 0; i < MAX_RELAYS; i++) {
-      if (relays[i]) {
-        for (int j = 0; j < MAX_CONDITIONS; j++) {
-          delete relays[i]->GetCondition(j);
-        }
-        delete relays[i];
-        relays[i] = nullptr;
-      }
+    // Relays that disappear from the config shouldn't stay stuck on
+    for (int i = 0; i < num_relays; i++) {
+      SwitchOff(i);
     }
-    num_relays = 0;
+    FlushOutputs();
+    DeleteAll();
   }
 
   void RegisterSensor(Sensor *sensor) {
     if (num_sensors < MAX_SENSORS) {
       sensors[num_sensors] = sensor;
-      pinMode(sensor->GetPin(), INPUT);
+      sensorIds[num_sensors] = sensor->GetId();
+      sensorPins[num_sensors] = sensor->GetPin();
+      sensorIo[num_sensors] = sensor->GetIo();
+      sensorRaw[num_sensors] = 0.0f;
+      sensorValues[num_sensors] = 0.0f;
+      sensorFaults[num_sensors] = kSensorOk;
+      sensor->GetFilter().Reset();
+      sensor->GetHealth().Reset();
+      if (IoBackend *backend = GetBackend(sensor->GetIo())) {
+        backend->ConfigureInput(sensor->GetPin());
+      }
       num_sensors++;
+      indexBuilt = false;
     }
   }
 
-  void RegisterRelay(Relay *relay) {
+  /**
+   * @param carry State to continue from when the relay was already driving
+   * its output, which is then left as it is; nullptr configures the output
+   * and starts off
+   */
+  void RegisterRelay(Relay *relay, const RelayCarryOver *carry = nullptr) {
     if (num_relays < MAX_RELAYS) {
       relays[num_relays] = relay;
-      pinMode(relay->GetPin(), OUTPUT);
+      relayIds[num_relays] = relay->GetId();
+      relayPins[num_relays] = relay->GetPin();
+      relayIo[num_relays] = relay->GetIo();
+      relayStatuses[num_relays] = carry ? carry->on : false;
+      relayDuty[num_relays] = carry ? carry->duty : 0.0f;
+      if (carry) {
+        relay->MarkSwitched(carry->lastChangeMs);
+      }
+      checkpoint.Disarm(); // Re-armed for the new set by BuildIndex()
+      relay->Compile();
+      relay->GetPid().Reset();
+      IoBackend *backend = GetBackend(relay->GetIo());
+      if (backend && !carry) {
+        if (relay->GetOutput() == kOutputPwm &&
+            !backend->ConfigurePwm(relay->GetPin(), relay->GetPwmFrequency())) {
+          LOG_WARN("No PWM for relay %u, using time-proportioned output",
+                   relay->GetId());
+          relay->SetOutput(kOutputTimeProportional, relay->GetPwmFrequency(),
+                           relay->GetPwmWindowSeconds());
+        }
+        if (relay->GetOutput() != kOutputPwm) {
+          backend->ConfigureOutput(relay->GetPin());
+        }
+      }
       num_relays++;
+      schedulesArmed = false;
+      indexBuilt = false;
     }
   }
 
-  Sensor *GetSensorById(uint8_t id) const {
+  /**
+   * @brief Replace the sensors and relays with those of `config`, taking
+   * its objects over
+   * @details Relays that stay (same id, io, pin and output mode) keep their
+   * state, duty and dwell timer, and their outputs are left alone; relays
+   * that are gone are switched off. Sensors that stay keep their last
+   * reading until the next poll.
+   * @note Call from loop(). Other tasks reading the sensors or relays hold
+   * GetConfigLock() meanwhile.
+   */
+  void ApplyConfig(SensorRelayConfig &config);
+
+  /**
+   * @brief Hand a config over to loop() (call from any task)
+   * @details A config still waiting is replaced and deleted
+   */
+  void QueueConfig(SensorRelayConfig *config) {
+    delete queuedConfig.exchange(config);
+  }
+
+  /**
+   * @brief Apply and save the config from QueueConfig(), if there is one
+   * (call from loop())
+   * @return bool True if a config was applied
+   */
+  bool ApplyQueuedConfig();
+
+  /**
+   * @brief Hand new PID settings over to loop() (call from the web server
+   * task)
+   * @details Replaces a tuning that hasn't been applied yet: the UI sends
+   * every value each time, so the latest one is all that matters.
+   */
+  void QueuePidTuning(const PidTuning &tuning) {
+    delete queuedPidTuning.exchange(new PidTuning(tuning));
+  }
+
+  /**
+   * @brief Apply the settings from QueuePidTuning(), if there are any
+   * (call from loop())
+   * @return bool True if a relay's loop was retuned
+   */
+  bool ApplyQueuedPidTuning();
+
+  /**
+   * @brief Held by ApplyConfig() while it swaps the sensors and relays
+   */
+  std::mutex &GetConfigLock() { return configLock; }
+
+  /**
+   * @brief Bring schedule conditions up to date with the clock
+   * @param now Current time in seconds (time(), as kept by InternalTime)
+   * @return bool True if any schedule condition changed state
+   * @note Only the timing wheel is touched, so this is cheap to call every
+   * tick: schedules are only looked at when one of their edges is due.
+   */
+  bool UpdateSchedules(uint32_t now);
+
+  /**
+   * @brief Recompute every schedule condition and re-arm its timer
+   * @param now Current time in seconds
+   */
+  void ArmSchedules(uint32_t now);
+
+  /**
+   * @brief Store a new sensor reading
+   * @param slot Index into sensors
+   * @param value The new value
+   * @note Relays depending on the sensor are queued for UpdateRelays() only
+   * if the value actually changed
+   */
+  void UpdateSensorValue(uint8_t slot, float value);
+
+  /**
+   * @brief Re-evaluate the relays whose inputs changed or that have a timer
+   * running, switching them as needed
+   * @param nowMs Current millis()
+   * @return bool True if any relay changed state
+   */
+  bool UpdateRelays(uint32_t nowMs);
+
+  /**
+   * @brief Run one step of every PID-driven relay and drive its output
+   * @param nowMs Current millis()
+   * @return bool True if a time-proportioned relay switched
+   * @note Call at a fixed rate (PID_INTERVAL_MS); the rate also sets the
+   * resolution of time-proportioned outputs
+   */
+  bool UpdateControllers(uint32_t nowMs);
+
+  /**
+   * @brief Queue every relay for the next UpdateRelays()
+   */
+  void MarkAllRelaysDirty() { dirtyRelays = AllRelays(); }
+
+  /**
+   * @brief Re-evaluate one relay and switch it if its minimum dwell allows
+   * @param slot Index into relays
+   * @param nowMs Current millis()
+   * @return bool True if the relay changed state
+   */
+  bool UpdateRelay(uint8_t slot, uint32_t nowMs);
+
+  /**
+   * @brief Change a relay's state, drive its output and restart its dwell
+   * timer
+   */
+  void SwitchRelay(uint8_t slot, bool on, uint32_t nowMs);
+
+  /**
+   * @brief Slot of the sensor with the given id
+   * @return int8_t -1 if there is no such sensor
+   */
+  int8_t FindSensorSlot(uint8_t id) const {
     for (int i = 0; i < num_sensors; i++) {
-      if (sensors[i] && sensors[i]->GetId() == id) {
-        return sensors[i];
+      if (sensorIds[i] == id) {
+        return i;
       }
     }
-    return nullptr;
+    return -1;
+  }
+
+  Sensor *GetSensorById(uint8_t id) const {
+    int8_t slot = FindSensorSlot(id);
+    return slot >= 0 ? sensors[slot] : nullptr;
   }
 
   Relay *GetRelayById(uint8_t id) const {
     for (int i = 0; i < num_relays; i++) {
-      if (relays[i] && relays[i]->GetId() == id) {
+      if (relayIds[i] == id) {
         return relays[i];
       }
     }
     return nullptr;
   }
 
+  float GetSensorValue(uint8_t slot) const { return sensorValues[slot]; }
+  // Reading before calibration, for calibrating against a reference
+  float GetSensorRaw(uint8_t slot) const { return sensorRaw[slot]; }
+  bool GetRelayStatus(uint8_t slot) const { return relayStatuses[slot]; }
+  // Output of a PID-driven relay, 0-1
+  float GetRelayDuty(uint8_t slot) const { return relayDuty[slot]; }
+  SensorFault GetSensorFault(uint8_t slot) const { return sensorFaults[slot]; }
+
+  /**
+   * @brief Whether a relay is in its fail-safe state because a sensor its
+   * conditions read is faulted or missing
+   */
+  bool IsRelayFailSafe(uint8_t slot) const {
+    return (failSafeRelays >> slot) & 1;
+  }
+
+  /**
+   * @brief Attach the hardware behind an io id (call before loading the
+   * config so sensors and relays get configured on it)
+   * @param id IO_NATIVE, IO_ADS1115, IO_MCP23017 or IO_PCF8574
+   */
+  void SetBackend(uint8_t id, IoBackend *backend) {
+    if (id < MAX_IO_BACKENDS) {
+      backends[id] = backend;
+    }
+  }
+
+  // Backend for an io id, nullptr if that hardware isn't fitted
+  IoBackend *GetBackend(uint8_t id) const {
+    return id < MAX_IO_BACKENDS ? backends[id] : nullptr;
+  }
+
+  // Unit of a sensor's value ("V", "°C", ...), "" if unknown
+  const char *GetSensorUnit(uint8_t slot) const {
+    IoBackend *backend = GetBackend(sensorIo[slot]);
+    return backend ? backend->GetUnit(sensorPins[slot]) : "";
+  }
+
+  /**
+   * @brief Refresh every backend once, then take a reading for every sensor
+   * and run its health checks
+   * @param nowMs Current millis()
+   * @note Relays reading a sensor whose fault state changed are queued for
+   * UpdateRelays()
+   */
+  void PollInputs(uint32_t nowMs);
+
+  /**
+   * @brief Push buffered relay outputs, one transfer per backend at most
+   * @note Nothing is sent for backends with nothing pending
+   */
+  void FlushOutputs();
+
   Relay *GetRelayArray() const { return *relays; }
 
   Sensor *GetSensorArray() const { return *sensors; }
@@ -215,14 +757,373 @@ public:
   void SaveToPreferences();
   void LoadFromPreferences();
 
+  /**
+   * @brief Put the relays back in the state they had before the reset
+   * @param nowMs Current millis()
+   * @details Call after LoadFromPreferences(), before the first
+   * UpdateRelays(). After a soft reset the dwell timers resume where they
+   * were; after a power cycle (states from NVS) they restart.
+   * @return Where the states came from
+   */
+  RelayCheckpointSource RestoreRelayStates(uint32_t nowMs);
+
+  /**
+   * @brief Copy the relay states to NVS, throttled (call periodically)
+   * @param force Skip the throttle, before a planned reboot
+   */
+  void SaveRelayStates(uint32_t nowMs, bool force = false) {
+    if (force) {
+      checkpoint.Save(nowMs);
+    } else {
+      checkpoint.SaveIfDue(nowMs);
+    }
+  }
+
+  // Hot per-slot state, kept as struct-of-arrays so the control loop and
+  // lookups walk contiguous memory instead of chasing object pointers
+  uint8_t sensorIds[MAX_SENSORS];
+  uint8_t sensorPins[MAX_SENSORS];
+  uint8_t sensorIo[MAX_SENSORS];
+  float sensorRaw[MAX_SENSORS];
+  float sensorValues[MAX_SENSORS];
+  SensorFault sensorFaults[MAX_SENSORS];
+  uint8_t relayIds[MAX_RELAYS];
+  uint8_t relayPins[MAX_RELAYS];
+  uint8_t relayIo[MAX_RELAYS];
+  bool relayStatuses[MAX_RELAYS];
+  float relayDuty[MAX_RELAYS];
+
+  // Cold per-slot configuration: names, UI state, conditions and timers
   Sensor *sensors[MAX_SENSORS];
   Relay *relays[MAX_RELAYS];
 
 private:
   uint8_t num_sensors;
   uint8_t num_relays;
+
+  IoBackend *backends[MAX_IO_BACKENDS] = {};
+
+  RelayCheckpoint checkpoint;  // Relay states kept across resets
+  TimerWheel scheduleWheel;    // Pending schedule edges
+  bool schedulesArmed = false; // False until ArmSchedules() after a change
+
+  /**
+   * @brief Turn a relay's output off, whatever drives it
+   */
+  void SwitchOff(uint8_t slot) {
+    if (relays[slot]->GetOutput() == kOutputPwm) {
+      if (IoBackend *backend = GetBackend(relayIo[slot])) {
+        backend->WriteDuty(relayPins[slot], 0.0f);
+      }
+      relayStatuses[slot] = false;
+    } else if (relayStatuses[slot]) {
+      SwitchRelay(slot, false, 0);
+    }
+  }
+
+  /**
+   * @brief Delete every sensor and relay, leaving the outputs as they are
+   */
+  void DeleteAll() {
+    // Forget the timers before the conditions holding them are deleted
+    scheduleWheel.Reset(0);
+    schedulesArmed = false;
+    indexBuilt = false;
+    missingSensorRelays = failSafeRelays = 0;
+
+    for (int i = 0; i < MAX_SENSORS; i++) {
+      delete sensors[i];
+      sensors[i] = nullptr;
+    }
+    num_sensors = 0;
+
+    for (int i = 0; i < MAX_RELAYS; i++) {
+      delete relays[i];
+      relays[i] = nullptr;
+    }
+    num_relays = 0;
+  }
+
+  RelayMask AllRelays() const {
+    return num_relays >= sizeof(RelayMask) * 8
+               ? ~(RelayMask)0
+               : ((RelayMask)1 << num_relays) - 1;
+  }
+
+  /**
+   * @brief Resolve condition sensor ids to slots and rebuild the reverse
+   * index, after the sensors or relays changed
+   */
+  void BuildIndex();
+
+  /**
+   * @brief Rebuild failSafeRelays, after a sensor's fault state changed
+   */
+  void UpdateFailSafe();
+
+  RelayMask sensorDependents[MAX_SENSORS] = {}; // Relays reading each sensor
+  RelayMask scheduleDependents = 0; // Relays with schedule conditions
+  RelayMask dirtyRelays = 0;        // Inputs changed since the last update
+  RelayMask pendingRelays = 0;      // Hold or dwell timer still running
+  RelayMask missingSensorRelays = 0; // Conditions on a sensor that's gone
+  RelayMask failSafeRelays = 0;     // Reading a faulted or missing sensor
+  RelayMask pidRelays = 0;          // Driven by UpdateControllers()
+  uint32_t lastControlMs = 0;       // Previous UpdateControllers() call
+  bool controllersRunning = false;  // lastControlMs is valid
+  bool indexBuilt = false;
+
+  std::atomic<SensorRelayConfig *> queuedConfig{nullptr};
+  std::mutex configLock;
+  std::atomic<PidTuning *> queuedPidTuning{nullptr};
 };
 
+/**
+ * @brief Add a sensor's calibration to its JSON object as "cal" (nothing for
+ * an uncalibrated sensor)
+ * @details {"type": "linear"|"table", "points": [[raw, value], ...]} or
+ * {"type": "poly", "coef": [c0, c1, ...]}
+ */
+void calibrationToJson(const Calibration &calibration, JsonObject obj) {
+  if (calibration.GetKind() == kCalibrationNone) {
+    return;
+  }
+  JsonObject cal = obj["cal"].to<JsonObject>();
+  cal["type"] = calibrationKindName(calibration.GetKind());
+  bool polynomial = calibration.GetKind() == kCalibrationPolynomial;
+  JsonArray values = cal[polynomial ? "coef" : "points"].to<JsonArray>();
+  for (uint8_t i = 0; i < calibration.GetCount(); i++) {
+    float raw, value;
+    calibration.GetPoint(i, raw, value);
+    if (polynomial) {
+      values.add(value);
+    } else {
+      JsonArray point = values.add<JsonArray>();
+      point.add(raw);
+      point.add(value);
+    }
+  }
+}
+
+/**
+ * @brief Set a calibration from a sensor's JSON object, the inverse of
+ * calibrationToJson()
+ * @return false if "cal" was present but invalid (the sensor is left
+ * uncalibrated)
+ */
+bool calibrationFromJson(Calibration &calibration, JsonObject obj) {
+  JsonObject cal = obj["cal"];
+  CalibrationKind kind = parseCalibrationKind(cal["type"] | "none");
+  float raw[CALIBRATION_MAX_POINTS];
+  float values[CALIBRATION_MAX_POINTS];
+  uint8_t count = 0;
+
+  if (kind == kCalibrationPolynomial) {
+    for (JsonVariant coefficient : cal["coef"].as<JsonArray>()) {
+      if (count == CALIBRATION_MAX_POINTS) {
+        break;
+      }
+      values[count++] = coefficient.as<float>();
+    }
+    return calibration.SetPolynomial(values, count);
+  }
+
+  // Points sorted by raw reading as they are read in
+  for (JsonArray point : cal["points"].as<JsonArray>()) {
+    if (count == CALIBRATION_MAX_POINTS) {
+      break;
+    }
+    float x = point[0].as<float>();
+    uint8_t i = count++;
+    for (; i > 0 && raw[i - 1] > x; i--) {
+      raw[i] = raw[i - 1];
+      values[i] = values[i - 1];
+    }
+    raw[i] = x;
+    values[i] = point[1].as<float>();
+  }
+
+  switch (kind) {
+  case kCalibrationLinear:
+    return count == 2 &&
+           calibration.SetLinear(raw[0], values[0], raw[1], values[1]);
+  case kCalibrationTable:
+    return calibration.SetTable(raw, values, count);
+  default:
+    calibration.SetNone();
+    return cal.isNull();
+  }
+}
+
+/**
+ * @brief Add a sensor's filter settings to its JSON object as "filter"
+ * (nothing when every stage is off)
+ * @details {"median": window, "ema": alpha, "q": process noise,
+ * "r": measurement noise}
+ */
+void filterToJson(const SensorFilter &filter, JsonObject obj) {
+  if (!filter.IsEnabled()) {
+    return;
+  }
+  JsonObject filterObj = obj["filter"].to<JsonObject>();
+  filterObj["median"] = filter.GetMedianWindow();
+  filterObj["ema"] = filter.GetEmaAlpha();
+  filterObj["q"] = filter.GetProcessNoise();
+  filterObj["r"] = filter.GetMeasurementNoise();
+}
+
+/**
+ * @brief Set a sensor's filter from its JSON object, the inverse of
+ * filterToJson()
+ */
+void filterFromJson(SensorFilter &filter, JsonObject obj) {
+  JsonObject filterObj = obj["filter"];
+  filter.SetMedian(filterObj["median"] | 0);
+  filter.SetEma(filterObj["ema"] | 0.0f);
+  filter.SetKalman(filterObj["q"] | 0.0f, filterObj["r"] | 0.0f);
+}
+
+/**
+ * @brief Add a sensor's health checks to its JSON object as "health"
+ * (nothing when they are at the defaults)
+ * @details {"min": value, "max": value, "rate": per second, "stuck": seconds,
+ * "stale": seconds, "clip": bool}
+ */
+void healthToJson(const SensorHealth &health, JsonObject obj) {
+  if (health.GetMin() >= health.GetMax() && health.GetMaxRate() == 0.0f &&
+      health.GetStuckSeconds() == 0 &&
+      health.GetStaleSeconds() == HEALTH_DEFAULT_STALE_S &&
+      !health.GetClipDetection()) {
+    return;
+  }
+  JsonObject healthObj = obj["health"].to<JsonObject>();
+  healthObj["min"] = health.GetMin();
+  healthObj["max"] = health.GetMax();
+  healthObj["rate"] = health.GetMaxRate();
+  healthObj["stuck"] = health.GetStuckSeconds();
+  healthObj["stale"] = health.GetStaleSeconds();
+  healthObj["clip"] = health.GetClipDetection();
+}
+
+/**
+ * @brief Set a sensor's health checks from its JSON object, the inverse of
+ * healthToJson()
+ */
+void healthFromJson(SensorHealth &health, JsonObject obj) {
+  JsonObject healthObj = obj["health"];
+  health.SetRange(healthObj["min"] | 0.0f, healthObj["max"] | 0.0f);
+  health.SetMaxRate(healthObj["rate"] | 0.0f);
+  health.SetStuckSeconds(healthObj["stuck"] | 0);
+  health.SetStaleSeconds(healthObj["stale"] | HEALTH_DEFAULT_STALE_S);
+  health.SetClipDetection(healthObj["clip"] | false);
+}
+
+/**
+ * @brief Add a relay's PID loop to its JSON object as "pid" (nothing for a
+ * relay driven by its conditions)
+ * @details {"sensorId": id, "setpoint": value, "kp", "ki", "kd": gains,
+ * "reverse": bool, "output": "pwm"|"slow", "freq": Hz, "period": seconds}
+ */
+void pidToJson(const Relay &relay, JsonObject obj) {
+  if (!relay.IsProportional()) {
+    return;
+  }
+  const PidController &pid = relay.GetPid();
+  JsonObject pidObj = obj["pid"].to<JsonObject>();
+  pidObj["sensorId"] = pid.GetSensorId();
+  pidObj["setpoint"] = pid.GetSetpoint();
+  pidObj["kp"] = pid.GetKp();
+  pidObj["ki"] = pid.GetKi();
+  pidObj["kd"] = pid.GetKd();
+  pidObj["reverse"] = pid.IsReverse();
+  pidObj["output"] = relay.GetOutput() == kOutputPwm ? "pwm" : "slow";
+  pidObj["freq"] = relay.GetPwmFrequency();
+  pidObj["period"] = relay.GetPwmWindowSeconds();
+}
+
+/**
+ * @brief Set a relay's PID loop from its JSON object, the inverse of
+ * pidToJson(); without "pid" the relay is driven by its conditions
+ */
+void pidFromJson(Relay &relay, JsonObject obj) {
+  JsonObject pidObj = obj["pid"];
+  if (pidObj.isNull()) {
+    relay.SetOutput(kOutputSwitch);
+    return;
+  }
+  PidController &pid = relay.GetPid();
+  pid.SetSensorId(pidObj["sensorId"] | 0);
+  pid.SetSetpoint(pidObj["setpoint"] | 0.0f);
+  pid.SetGains(pidObj["kp"] | 0.0f, pidObj["ki"] | 0.0f, pidObj["kd"] | 0.0f,
+               pidObj["reverse"] | false);
+  bool pwm = strcmp(pidObj["output"] | "pwm", "slow") != 0;
+  relay.SetOutput(pwm ? kOutputPwm : kOutputTimeProportional,
+                  pidObj["freq"] | DEFAULT_PWM_FREQUENCY,
+                  pidObj["period"] | DEFAULT_PWM_WINDOW_S);
+}
+
+/**
+ * @brief Build the sensors and relays of a config, as saved by
+ * SaveToPreferences() or posted by the settings page
+ * @details Entries beyond MAX_SENSORS or MAX_RELAYS are dropped
+ */
+void configFromJson(SensorRelayConfig &config, JsonObject root) {
+  for (JsonObject obj : root["sensors"].as<JsonArray>()) {
+    if (config.numSensors == MAX_SENSORS) {
+      LOG_WARN("Config has more than %u sensors", MAX_SENSORS);
+      break;
+    }
+    uint8_t id = obj["id"];
+    const char *name = obj["name"];
+    uint8_t pin = obj["pin"];
+    bool folded = obj["folded"] | true;
+    uint8_t io = obj["io"] | IO_NATIVE;
+
+    Sensor *sensor = new Sensor(id, name, pin, folded, io);
+    if (!calibrationFromJson(sensor->GetCalibration(), obj)) {
+      LOG_WARN("Invalid calibration for sensor %u", id);
+    }
+    filterFromJson(sensor->GetFilter(), obj);
+    healthFromJson(sensor->GetHealth(), obj);
+    config.sensors[config.numSensors++] = sensor;
+  }
+
+  for (JsonObject obj : root["relays"].as<JsonArray>()) {
+    if (config.numRelays == MAX_RELAYS) {
+      LOG_WARN("Config has more than %u relays", MAX_RELAYS);
+      break;
+    }
+    uint8_t id = obj["id"];
+    const char *name = obj["name"];
+    uint8_t pin = obj["pin"];
+    bool folded = obj["folded"] | false;
+    uint16_t minOn = obj["minOn"] | 0;
+    uint16_t minOff = obj["minOff"] | 0;
+    uint8_t io = obj["io"] | IO_NATIVE;
+
+    Relay *relay = new Relay(id, name, pin, folded, minOn, minOff, io);
+    relay->SetFailSafe(parseFailSafeMode(obj["failSafe"] | "off"));
+    pidFromJson(*relay, obj);
+    for (JsonObject condObj : obj["conditions"].as<JsonArray>()) {
+      uint8_t sensor = condObj["sensor"];
+      uint8_t sensorId = condObj["sensorId"];
+      const char *op = condObj["operator"];
+      float value = condObj["value"];
+      uint8_t condId = condObj["id"];
+      const char *type = condObj["type"];
+      float hysteresis = condObj["hysteresis"] | 0.0f;
+      uint16_t hold = condObj["hold"] | 0;
+      uint8_t parent = condObj["parent"] | 0;
+
+      Condition *condition = new Condition(sensor, sensorId, op, value, condId,
+                                           type, hysteresis, hold, parent);
+      condition->SetSchedule(condObj["period"] | 0, condObj["start"] | 0,
+                             condObj["duration"] | 0);
+      relay->AddCondition(condition);
+    }
+    config.relays[config.numRelays++] = relay;
+  }
+}
+
 void SensorRelayManager::SaveToPreferences() {
   Preferences prefs;
   prefs.begin("sensor_relay", false);
@@ -236,7 +1137,11 @@ void SensorRelayManager::SaveToPreferences() {
       obj["id"] = sensors[i]->GetId();
       obj["name"] = sensors[i]->GetName();
       obj["pin"] = sensors[i]->GetPin();
+      obj["io"] = sensors[i]->GetIo();
       obj["folded"] = sensors[i]->GetFolded();
+      calibrationToJson(sensors[i]->GetCalibration(), obj);
+      filterToJson(sensors[i]->GetFilter(), obj);
+      healthToJson(sensors[i]->GetHealth(), obj);
     }
   }
 
@@ -247,7 +1152,12 @@ void SensorRelayManager::SaveToPreferences() {
       obj["id"] = relays[i]->GetId();
       obj["name"] = relays[i]->GetName();
       obj["pin"] = relays[i]->GetPin();
+      obj["io"] = relays[i]->GetIo();
       obj["folded"] = relays[i]->GetFolded();
+      obj["minOn"] = relays[i]->GetMinOnSeconds();
+      obj["minOff"] = relays[i]->GetMinOffSeconds();
+      obj["failSafe"] = failSafeModeName(relays[i]->GetFailSafe());
+      pidToJson(*relays[i], obj);
 
       JsonArray conds = obj["conditions"].to<JsonArray>(); // Updated
       for (int j = 0; j < MAX_CONDITIONS; j++) {
@@ -260,6 +1170,14 @@ void SensorRelayManager::SaveToPreferences() {
           condObj["value"] = c->GetValue();
           condObj["id"] = c->GetId();
           condObj["type"] = c->GetType();
+          condObj["hysteresis"] = c->GetHysteresis();
+          condObj["hold"] = c->GetHoldSeconds();
+          condObj["parent"] = c->GetParent();
+          if (c->IsSchedule()) {
+            condObj["period"] = c->GetSchedule().period;
+            condObj["start"] = c->GetSchedule().start;
+            condObj["duration"] = c->GetSchedule().duration;
+          }
         } else {
           break;
         }
@@ -267,12 +1185,17 @@ void SensorRelayManager::SaveToPreferences() {
     }
   }
 
+  // Stored as a blob: NVS strings stop at 4000 bytes, which a large build's
+  // config easily exceeds
   String jsonStr;
   serializeJson(doc, jsonStr);
-  if (prefs.putString("config", jsonStr) == 0) {
-    Serial.println("Failed to save config to Preferences");
+  if (prefs.getType("config") == PT_STR) {
+    prefs.remove("config"); // Saved by older firmware, once
+  }
+  if (prefs.putBytes("config", jsonStr.c_str(), jsonStr.length()) == 0) {
+    LOG_ERROR("Failed to save config to Preferences");
   } else {
-    Serial.println("Config saved successfully");
+    LOG_INFO("Config saved (%u bytes)", jsonStr.length());
   }
 
   prefs.end();
@@ -282,9 +1205,19 @@ void SensorRelayManager::LoadFromPreferences() {
   Preferences prefs;
   prefs.begin("sensor_relay", true);
 
-  String jsonStr = prefs.getString("config", "");
+  String jsonStr;
+  size_t length = prefs.getBytesLength("config");
+  if (length > 0) {
+    char *buffer = new char[length + 1];
+    prefs.getBytes("config", buffer, length);
+    buffer[length] = '\0';
+    jsonStr = buffer;
+    delete[] buffer;
+  } else {
+    jsonStr = prefs.getString("config", ""); // Saved by older firmware
+  }
   if (jsonStr.isEmpty()) {
-    Serial.println("No saved config found");
+    LOG_INFO("No saved config found");
     prefs.end();
     return;
   }
@@ -292,101 +1225,545 @@ void SensorRelayManager::LoadFromPreferences() {
   JsonDocument doc;
   DeserializationError error = deserializeJson(doc, jsonStr);
   if (error) {
-    Serial.print("Failed to parse saved JSON: ");
-    Serial.println(error.c_str());
+    LOG_ERROR("Failed to parse saved JSON: %s", error.c_str());
     prefs.end();
     return;
   }
 
-  JsonArray sensorsArray = doc["sensors"];
-  for (JsonObject obj : sensorsArray) {
-    uint8_t id = obj["id"];
-    const char *name = obj["name"];
-    uint8_t pin = obj["pin"];
-    bool folded = obj["folded"] | true;
+  SensorRelayConfig config;
+  configFromJson(config, doc.as<JsonObject>());
+  ApplyConfig(config);
 
-    Sensor *sensor = new Sensor(id, name, pin, 0.0f, folded);
-    RegisterSensor(sensor);
-  }
+  LOG_INFO("Config loaded: %u sensors, %u relays", num_sensors, num_relays);
+  prefs.end();
+}
 
-  JsonArray relaysArray = doc["relays"];
-  for (JsonObject obj : relaysArray) {
-    uint8_t id = obj["id"];
-    const char *name = obj["name"];
-    uint8_t pin = obj["pin"];
-    bool folded = obj["folded"] | false;
+void SensorRelayManager::ApplyConfig(SensorRelayConfig &config) {
+  std::lock_guard<std::mutex> lock(configLock);
 
-    Relay *relay = new Relay(id, name, pin, false, folded);
-    JsonArray conditionsArray = obj["conditions"];
-    for (JsonObject condObj : conditionsArray) {
-      uint8_t sensor = condObj["sensor"];
-      uint8_t sensorId = condObj["sensorId"];
-      const char *op = condObj["operator"];
-      float value = condObj["value"];
-      uint8_t condId = condObj["id"];
-      const char *type = condObj["type"];
+  // Relays on the same output as before carry on from their current state,
+  // so saving the settings neither blips them nor restarts their dwell
+  RelayCarryOver carried[MAX_RELAYS];
+  bool isCarried[MAX_RELAYS] = {};
+  bool kept[MAX_RELAYS] = {};
+  for (uint8_t i = 0; i < config.numRelays; i++) {
+    const Relay &relay = *config.relays[i];
+    for (uint8_t j = 0; j < num_relays; j++) {
+      const Relay &old = *relays[j];
+      if (kept[j] || old.GetId() != relay.GetId() ||
+          old.GetIo() != relay.GetIo() || old.GetPin() != relay.GetPin() ||
+          old.GetOutput() != relay.GetOutput() ||
+          (relay.GetOutput() == kOutputPwm &&
+           old.GetPwmFrequency() != relay.GetPwmFrequency())) {
+        continue;
+      }
+      carried[i] = {relayStatuses[j], relayDuty[j], old.GetLastChangeMs()};
+      isCarried[i] = kept[j] = true;
+      break;
+    }
+  }
+  // Relays that disappear from the config shouldn't stay stuck on
+  for (uint8_t j = 0; j < num_relays; j++) {
+    if (!kept[j]) {
+      SwitchOff(j);
+    }
+  }
 
-      Condition *condition =
-          new Condition(sensor, sensorId, op, value, condId, type);
-      relay->AddCondition(condition);
+  // Sensors that stay keep their reading, so relays don't act on a zero
+  // until the next poll
+  struct {
+    float raw;
+    float value;
+    SensorFault fault;
+  } readings[MAX_SENSORS];
+  int8_t readingSlot[MAX_SENSORS];
+  for (uint8_t i = 0; i < config.numSensors; i++) {
+    const Sensor &sensor = *config.sensors[i];
+    readingSlot[i] = -1;
+    for (uint8_t j = 0; j < num_sensors; j++) {
+      if (sensorIds[j] == sensor.GetId() && sensorIo[j] == sensor.GetIo() &&
+          sensorPins[j] == sensor.GetPin()) {
+        readings[i] = {sensorRaw[j], sensorValues[j], sensorFaults[j]};
+        readingSlot[i] = j;
+        break;
+      }
     }
-    RegisterRelay(relay);
+  }
 
-    pinMode(pin, OUTPUT);
-    digitalWrite(pin, LOW);
+  DeleteAll();
+  for (uint8_t i = 0; i < config.numSensors; i++) {
+    RegisterSensor(config.sensors[i]);
+    if (readingSlot[i] >= 0) {
+      sensorRaw[i] = readings[i].raw;
+      sensorValues[i] = readings[i].value;
+      sensorFaults[i] = readings[i].fault;
+    }
   }
+  for (uint8_t i = 0; i < config.numRelays; i++) {
+    RegisterRelay(config.relays[i], isCarried[i] ? &carried[i] : nullptr);
+  }
+  config.numSensors = config.numRelays = 0; // Ours now
+  FlushOutputs();
+}
 
-  Serial.println("Config loaded successfully");
-  prefs.end();
+bool SensorRelayManager::ApplyQueuedConfig() {
+  SensorRelayConfig *config = queuedConfig.exchange(nullptr);
+  if (config == nullptr) {
+    return false;
+  }
+  ApplyConfig(*config);
+  delete config;
+  LOG_INFO("Config applied: %u sensors, %u relays", num_sensors, num_relays);
+  SaveToPreferences();
+  return true;
+}
+
+bool SensorRelayManager::ApplyQueuedPidTuning() {
+  PidTuning *queued = queuedPidTuning.exchange(nullptr);
+  if (queued == nullptr) {
+    return false;
+  }
+  PidTuning tuning = *queued;
+  delete queued;
+
+  // The relay may have gone with a config applied since it was queued
+  Relay *relay = GetRelayById(tuning.relayId);
+  if (relay == nullptr || !relay->IsProportional()) {
+    LOG_WARN("PID tuning dropped, relay %u is gone", tuning.relayId);
+    return false;
+  }
+  PidController &pid = relay->GetPid();
+  auto keep = [](float value, float current) {
+    return isnan(value) ? current : value;
+  };
+  pid.SetSetpoint(keep(tuning.setpoint, pid.GetSetpoint()));
+  pid.SetGains(keep(tuning.kp, pid.GetKp()), keep(tuning.ki, pid.GetKi()),
+               keep(tuning.kd, pid.GetKd()), pid.IsReverse());
+  return true;
 }
 
 /**
  * @brief Reads the current value of a sensor
  * @param sensor Pointer to the Sensor object
- * @return float The current sensor value
+ * @param manager The SensorRelayManager holding the sensor
+ * @return float The latest calibrated and filtered value from PollInputs(),
+ * 0 if the sensor isn't registered
+ */
+float readSensorValue(Sensor *sensor, SensorRelayManager &manager) {
+  int8_t slot = manager.FindSensorSlot(sensor->GetId());
+  return slot < 0 ? 0.0f : manager.GetSensorValue(slot);
+}
+
+// Control path timings, exported with the other metrics on /metrics
+METRICS_HISTOGRAM(relayEvalMetric, "relay_eval",
+                  "Evaluating one relay's conditions");
+METRICS_HISTOGRAM(relayUpdateMetric, "relay_update",
+                  "Re-evaluating and switching the queued relays");
+METRICS_HISTOGRAM(pollMetric, "poll_inputs",
+                  "Polling the backends and checking every sensor");
+METRICS_HISTOGRAM(controlMetric, "pid_step", "One step of every PID loop");
+
+void SensorRelayManager::PollInputs(uint32_t nowMs) {
+  METRICS_TIME(pollMetric);
+  for (int i = 0; i < MAX_IO_BACKENDS; i++) {
+    if (backends[i]) {
+      backends[i]->Poll(nowMs);
+    }
+  }
+
+  bool faultsChanged = false;
+  for (int i = 0; i < num_sensors; i++) {
+    IoBackend *backend = GetBackend(sensorIo[i]);
+    SensorHealth &health = sensors[i]->GetHealth();
+    float raw;
+    bool healthChanged;
+    if (backend && backend->ReadInput(sensorPins[i], raw)) {
+      sensorRaw[i] = raw;
+      Sensor *sensor = sensors[i];
+      float value = sensor->GetCalibration().Apply(raw);
+      // Checked before filtering, which would hide spikes and stuck inputs
+      healthChanged = health.Sample(
+          raw, value, backend->IsAtRail(sensorPins[i], raw), nowMs);
+      UpdateSensorValue(i, sensor->GetFilter().Apply(value));
+    } else {
+      healthChanged = health.Check(nowMs);
+    }
+
+    if (healthChanged) {
+      sensorFaults[i] = health.GetFault();
+      dirtyRelays |= sensorDependents[i];
+      faultsChanged = true;
+    }
+  }
+  if (faultsChanged) {
+    UpdateFailSafe();
+  }
+}
+
+void SensorRelayManager::FlushOutputs() {
+  for (int i = 0; i < MAX_IO_BACKENDS; i++) {
+    if (backends[i]) {
+      backends[i]->Flush();
+    }
+  }
+}
+
+/**
+ * @brief Parses an operator string (e.g. ">", "!=")
+ * @param op The operator string
+ * @return CompareOp kInvalidOp if the operator is unknown
+ */
+CompareOp parseCompareOp(const char *op) {
+  static const char *const kNames[] = {">", "<", ">=", "<=", "=", "!="};
+  for (uint8_t i = 0; i < kInvalidOp; i++) {
+    if (strcmp(op, kNames[i]) == 0) {
+      return (CompareOp)i;
+    }
+  }
+  return kInvalidOp;
+}
+
+/**
+ * @brief Parses a condition type string
+ * @param type "sensor", "schedule", "and", "or" or "not"
+ * @return ConditionKind kSensorCondition for anything unknown
  */
-float readSensorValue(Sensor *sensor) {
-  int rawValue = analogRead(sensor->GetPin());
-  return rawValue * 0.0048828125;
+ConditionKind parseConditionKind(const char *type) {
+  if (strcmp(type, "schedule") == 0) {
+    return kScheduleCondition;
+  } else if (strcmp(type, "and") == 0) {
+    return kAndGroup;
+  } else if (strcmp(type, "or") == 0) {
+    return kOrGroup;
+  } else if (strcmp(type, "not") == 0) {
+    return kNotGroup;
+  }
+  return kSensorCondition;
 }
 
 /**
- * @brief Evaluates a single condition
- * @param op The operator (e.g., ">", "<")
+ * @brief Compares a sensor value against a threshold
+ * @param op The comparison
  * @param sensorValue The current sensor value
  * @param conditionValue The condition threshold
- * @return bool True if the condition is met
+ * @return bool True if the comparison holds
  */
-bool evaluateCondition(const char *op, float sensorValue,
-                       float conditionValue) {
-  if (strcmp(op, ">") == 0) {
-    // Serial.println("Sensor Value: " + String(sensorValue));
-    // Serial.println("Condition Threshold: " + String(conditionValue));
+bool compareValues(CompareOp op, float sensorValue, float conditionValue) {
+  switch (op) {
+  case kGreater:
     return sensorValue > conditionValue;
-  } else if (strcmp(op, "<") == 0) {
-    // Serial.println("Sensor Value: " + String(sensorValue));
-    // Serial.println("Condition Threshold: " + String(conditionValue));
+  case kLess:
     return sensorValue < conditionValue;
-  } else if (strcmp(op, "=") == 0) {
-    // Serial.println("Sensor Value: " + String(sensorValue));
-    // Serial.println("Condition Threshold: " + String(conditionValue));
-    return sensorValue == conditionValue;
-  } else if (strcmp(op, ">=") == 0) {
-    // Serial.println("Sensor Value: " + String(sensorValue));
-    // Serial.println("Condition Threshold: " + String(conditionValue));
+  case kGreaterEqual:
     return sensorValue >= conditionValue;
-  } else if (strcmp(op, "<=") == 0) {
-    // Serial.println("Sensor Value: " + String(sensorValue));
-    // Serial.println("Condition Threshold: " + String(conditionValue));
+  case kLessEqual:
     return sensorValue <= conditionValue;
-    // } else if (strcmp(op, "!=") == 0) {
-    //   Serial.println("Sensor Value: " + String(sensorValue));
-    //   Serial.println("Condition Threshold: " + String(conditionValue));
+  case kEqual:
+    return sensorValue == conditionValue;
+  case kNotEqual:
     return sensorValue != conditionValue;
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief Evaluates a single condition
+ * @param op The operator (e.g., ">", "<")
+ * @param sensorValue The current sensor value
+ * @param conditionValue The condition threshold
+ * @return bool True if the condition is met
+ */
+bool evaluateCondition(const char *op, float sensorValue,
+                       float conditionValue) {
+  CompareOp compare = parseCompareOp(op);
+  if (compare == kInvalidOp) {
+    LOG_WARN("Invalid operator");
+    return false;
+  }
+  return compareValues(compare, sensorValue, conditionValue);
+}
+
+bool Condition::Evaluate(float sensorValue, uint32_t nowMs) {
+  bool result;
+
+  if (hysteresis > 0.0f && (compare == kEqual || compare == kNotEqual)) {
+    // Equality gets a tolerance band instead
+    bool inBand = fabsf(sensorValue - value) <= hysteresis;
+    result = (compare == kEqual) ? inBand : !inBand;
   } else {
-    Serial.println("Invalid operator");
+    // Once true, the threshold moves back by the band so noise around it
+    // can't flip the result every tick
+    float threshold = value;
+    if (rawState && (compare == kGreater || compare == kGreaterEqual)) {
+      threshold -= hysteresis;
+    } else if (rawState && (compare == kLess || compare == kLessEqual)) {
+      threshold += hysteresis;
+    }
+    result = compareValues(compare, sensorValue, threshold);
+  }
+
+  if (result && !rawState) {
+    trueSince = nowMs;
+  }
+  rawState = result;
+
+  state = result && (nowMs - trueSince >= holdSeconds * 1000UL);
+  return state;
+}
+
+/**
+ * @brief Timer callback for schedule conditions, run by the wheel at an edge
+ */
+void onScheduleEdge(TimerWheel &wheel, TimerNode *node, uint32_t now) {
+  static_cast<Condition *>(node->context)->ArmSchedule(wheel, now);
+}
+
+bool SensorRelayManager::UpdateSchedules(uint32_t now) {
+  uint32_t elapsed = now - scheduleWheel.GetTime();
+  if (!schedulesArmed || (int32_t)elapsed < 0 ||
+      elapsed > SCHEDULE_MAX_CATCHUP_S) {
+    // Config changed or the clock was set: cheaper to start over than to
+    // step the wheel through the gap
+    ArmSchedules(now);
+    dirtyRelays |= scheduleDependents;
+    return true;
+  }
+  if (scheduleWheel.Advance(now) == 0) {
+    return false;
+  }
+  // Edges are rare, so don't bother tracking which schedule fired
+  dirtyRelays |= scheduleDependents;
+  return true;
+}
+
+void SensorRelayManager::ArmSchedules(uint32_t now) {
+  scheduleWheel.Reset(now);
+  for (int i = 0; i < num_relays; i++) {
+    for (int j = 0; j < MAX_CONDITIONS; j++) {
+      Condition *condition = relays[i]->GetCondition(j);
+      if (condition && condition->IsSchedule()) {
+        condition->ArmSchedule(scheduleWheel, now);
+      }
+    }
+  }
+  schedulesArmed = true;
+}
+
+void SensorRelayManager::BuildIndex() {
+  for (int i = 0; i < MAX_SENSORS; i++) {
+    sensorDependents[i] = 0;
+  }
+  scheduleDependents = 0;
+  missingSensorRelays = 0;
+  pidRelays = 0;
+
+  for (int i = 0; i < num_relays; i++) {
+    RelayMask bit = (RelayMask)1 << i;
+    if (relays[i]->IsProportional()) {
+      // The PID's sensor is all that matters, conditions are ignored
+      PidController &pid = relays[i]->GetPid();
+      int8_t slot = FindSensorSlot(pid.GetSensorId());
+      pid.SetSensorSlot(slot);
+      if (slot >= 0) {
+        sensorDependents[slot] |= bit;
+      } else {
+        missingSensorRelays |= bit;
+      }
+      pidRelays |= bit;
+      continue;
+    }
+    for (int j = 0; j < MAX_CONDITIONS; j++) {
+      Condition *condition = relays[i]->GetCondition(j);
+      if (condition == nullptr) {
+        continue;
+      }
+      if (condition->IsSchedule()) {
+        scheduleDependents |= bit;
+      } else if (!condition->IsGroup()) {
+        int8_t slot = FindSensorSlot(condition->GetSensorId());
+        condition->SetSensorSlot(slot);
+        if (slot >= 0) {
+          sensorDependents[slot] |= bit;
+        } else {
+          missingSensorRelays |= bit;
+        }
+      }
+    }
+  }
+
+  // The checkpoint follows the new relay set from here on
+  uint32_t nowMs = millis();
+  for (int i = 0; i < num_relays; i++) {
+    checkpoint.Set(i, relayIds[i], relayIo[i], relayPins[i], relayStatuses[i],
+                   (nowMs - relays[i]->GetLastChangeMs()) / 1000);
+  }
+  checkpoint.Arm(num_relays);
+
+  // Everything is new, so everything needs a first look
+  dirtyRelays = AllRelays();
+  pendingRelays = 0;
+  indexBuilt = true;
+  UpdateFailSafe();
+}
+
+void SensorRelayManager::UpdateFailSafe() {
+  RelayMask mask = missingSensorRelays;
+  for (int i = 0; i < num_sensors; i++) {
+    if (sensorFaults[i] != kSensorOk) {
+      mask |= sensorDependents[i];
+    }
+  }
+  failSafeRelays = mask;
+}
+
+void SensorRelayManager::UpdateSensorValue(uint8_t slot, float value) {
+  if (slot >= num_sensors || sensorValues[slot] == value) {
+    return;
+  }
+  sensorValues[slot] = value;
+  dirtyRelays |= sensorDependents[slot];
+}
+
+int Relay::FindGroup(uint8_t groupId) const {
+  for (int i = 0; i < MAX_CONDITIONS; i++) {
+    if (conditions[i] && conditions[i]->IsGroup() &&
+        conditions[i]->GetId() == groupId) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+uint8_t Relay::ParentOf(uint8_t index) const {
+  uint8_t parent = conditions[index]->GetParent();
+  // Members of a missing group (or of themselves) fall back to top level
+  if (parent == conditions[index]->GetId() || FindGroup(parent) < 0) {
+    return 0;
+  }
+  // So do groups that are their own ancestor, where they compile to false
+  if (IsCircular(index)) {
+    return 0;
+  }
+  return parent;
+}
+
+bool Relay::IsCircular(uint8_t index) const {
+  if (!conditions[index]->IsGroup()) {
     return false;
   }
+  int current = index;
+  // Any loop is found within MAX_CONDITIONS steps up the tree
+  for (uint8_t step = 0; step < MAX_CONDITIONS; step++) {
+    const Condition *condition = conditions[current];
+    if (condition->GetParent() == condition->GetId()) {
+      return false;
+    }
+    current = FindGroup(condition->GetParent());
+    if (current < 0) {
+      return false;
+    }
+    if (current == index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint8_t Relay::Cost(uint8_t index, uint8_t depth) const {
+  const Condition *condition = conditions[index];
+  if (condition->IsSchedule()) {
+    return 0; // Kept up to date by the timing wheel
+  }
+  if (!condition->IsGroup()) {
+    // Stateful conditions are updated before the program runs, so reading
+    // them is free
+    return condition->IsStateful() ? 0 : 1;
+  }
+  if (depth >= MAX_GROUP_DEPTH) {
+    return 0;
+  }
+
+  uint8_t cost = 0;
+  for (uint8_t i = 0; i < MAX_CONDITIONS; i++) {
+    if (conditions[i] && i != index &&
+        ParentOf(i) == condition->GetId()) {
+      cost += Cost(i, depth + 1);
+    }
+  }
+  return cost;
+}
+
+uint8_t Relay::Emit(ConditionOpCode code, uint8_t arg) {
+  // The size bound holds for any tree, this only guards against bugs
+  if (programLength >= MAX_CONDITION_OPS) {
+    return programLength - 1;
+  }
+  program[programLength] = {code, arg};
+  return programLength++;
+}
+
+void Relay::CompileNode(uint8_t index, uint8_t depth) {
+  const Condition *condition = conditions[index];
+  if (!condition->IsGroup()) {
+    Emit(kOpLeaf, index);
+  } else if (depth >= MAX_GROUP_DEPTH || IsCircular(index)) {
+    Emit(kOpConst, false);
+  } else {
+    CompileGroup(condition->GetId(), condition->GetKind(), depth + 1);
+  }
+}
+
+void Relay::CompileGroup(uint8_t groupId, ConditionKind kind, uint8_t depth) {
+  // Collect the members, cheapest first (insertion sort keeps ties in the
+  // order the user gave them)
+  uint8_t members[MAX_CONDITIONS];
+  uint8_t costs[MAX_CONDITIONS];
+  uint8_t numMembers = 0;
+  for (uint8_t i = 0; i < MAX_CONDITIONS; i++) {
+    if (!conditions[i] || ParentOf(i) != groupId ||
+        conditions[i]->GetId() == groupId) {
+      continue;
+    }
+    uint8_t cost = Cost(i, depth);
+    uint8_t j = numMembers++;
+    for (; j > 0 && costs[j - 1] > cost; j--) {
+      members[j] = members[j - 1];
+      costs[j] = costs[j - 1];
+    }
+    members[j] = i;
+    costs[j] = cost;
+  }
+
+  if (numMembers == 0) {
+    // Nothing to test never switches the relay on, whatever the group kind;
+    // that includes a relay without conditions and a top level left empty
+    // by a broken tree
+    Emit(kOpConst, false);
+    return;
+  }
+
+  // NOT applies to the AND of its members
+  ConditionOpCode exit = (kind == kOrGroup) ? kOpJumpIfTrue : kOpJumpIfFalse;
+  uint8_t jumps[MAX_CONDITIONS];
+  for (uint8_t i = 0; i < numMembers; i++) {
+    CompileNode(members[i], depth);
+    if (i + 1 < numMembers) {
+      jumps[i] = Emit(exit);
+    }
+  }
+  for (uint8_t i = 0; i + 1 < numMembers; i++) {
+    program[jumps[i]].arg = programLength;
+  }
+
+  if (kind == kNotGroup) {
+    Emit(kOpNot);
+  }
+}
+
+void Relay::Compile() {
+  programLength = 0;
+  CompileGroup(0, kAndGroup, 0);
 }
 
 /**
@@ -399,41 +1776,230 @@ Sensor *findSensorById(uint8_t id, SensorRelayManager &manager) {
 }
 
 /**
- * @brief Evaluates all conditions for a relay
+ * @brief Evaluates a sensor condition against its sensor's current value
+ * @return bool False if the sensor no longer exists
+ */
+bool evaluateLeaf(Condition &condition, SensorRelayManager &manager,
+                  uint32_t nowMs) {
+  int8_t slot = condition.GetSensorSlot();
+  if (slot < 0) {
+    condition.Invalidate();
+    return false;
+  }
+  return condition.Evaluate(manager.GetSensorValue(slot), nowMs);
+}
+
+/**
+ * @brief Evaluates the condition tree of a relay
  * @param relay The Relay object to evaluate
  * @param manager The SensorRelayManager containing sensor data
+ * @param nowMs Current millis(), drives condition hold times
  * @return bool True if the relay should be on
+ * @note Conditions with hysteresis or a hold time are updated first on every
+ * call so their timers see every sample, and schedule conditions are kept up
+ * to date by SensorRelayManager::UpdateSchedules(); the compiled program then
+ * only evaluates the stateless conditions it can't skip.
  */
-bool evaluateRelayConditions(Relay &relay, SensorRelayManager &manager) {
-  bool hasConditions = false;
-  bool allConditionsTrue = true;
+bool evaluateRelayConditions(Relay &relay, SensorRelayManager &manager,
+                             uint32_t nowMs) {
+  for (int i = 0; i < MAX_CONDITIONS; i++) {
+    Condition *condition = relay.GetCondition(i);
+    if (condition && condition->GetKind() == kSensorCondition &&
+        condition->IsStateful()) {
+      evaluateLeaf(*condition, manager, nowMs);
+    }
+  }
 
-  for (int j = 0; j < MAX_CONDITIONS; j++) {
-    Condition *condition = relay.GetCondition(j);
-    if (condition == nullptr)
+  const ConditionOp *program = relay.GetProgram();
+  uint8_t length = relay.GetProgramLength();
+  bool acc = false;
+
+  // Jumps only go forward, so this always terminates
+  for (uint8_t pc = 0; pc < length;) {
+    const ConditionOp &op = program[pc++];
+    switch (op.code) {
+    case kOpLeaf: {
+      Condition &condition = *relay.GetCondition(op.arg);
+      acc = (condition.IsSchedule() || condition.IsStateful())
+                ? condition.GetState()
+                : evaluateLeaf(condition, manager, nowMs);
       break;
+    }
+    case kOpConst:
+      acc = op.arg;
+      break;
+    case kOpNot:
+      acc = !acc;
+      break;
+    case kOpJumpIfFalse:
+      if (!acc)
+        pc = op.arg;
+      break;
+    case kOpJumpIfTrue:
+      if (acc)
+        pc = op.arg;
+      break;
+    }
+  }
+  return acc;
+}
 
-    hasConditions = true;
-    Sensor *sensor = findSensorById(condition->GetSensorId(), manager);
+void SensorRelayManager::SwitchRelay(uint8_t slot, bool on, uint32_t nowMs) {
+  relayStatuses[slot] = on;
+  relays[slot]->MarkSwitched(nowMs);
+  checkpoint.Record(slot, on);
+  // Bus backends buffer this until FlushOutputs()
+  if (IoBackend *backend = GetBackend(relayIo[slot])) {
+    backend->WriteOutput(relayPins[slot], on);
+  }
+}
 
-    if (sensor == nullptr) {
-      allConditionsTrue = false;
-      break;
+RelayCheckpointSource SensorRelayManager::RestoreRelayStates(uint32_t nowMs) {
+  RelayCheckpointSource source = checkpoint.Begin();
+  if (source == kCheckpointNone) {
+    return source;
+  }
+
+  uint8_t restored = 0;
+  for (int i = 0; i < num_relays; i++) {
+    Relay &relay = *relays[i];
+    bool on;
+    uint32_t elapsedSeconds;
+    // PWM duty comes from the PID loop, which starts over anyway
+    if (relay.GetOutput() == kOutputPwm ||
+        !checkpoint.Find(relayIds[i], relayIo[i], relayPins[i], on,
+                         elapsedSeconds)) {
+      continue;
+    }
+    // Back-date the switch so the dwell timer resumes, but never further
+    // than the longest dwell (millis() restarted at 0)
+    uint16_t longest = relay.GetMinOnSeconds() > relay.GetMinOffSeconds()
+                           ? relay.GetMinOnSeconds()
+                           : relay.GetMinOffSeconds();
+    uint32_t elapsedMs =
+        elapsedSeconds >= longest ? longest * 1000UL : elapsedSeconds * 1000UL;
+    SwitchRelay(i, on, nowMs - elapsedMs);
+    restored++;
+  }
+  FlushOutputs();
+
+  LOG_INFO("Restored %u relay states from %s", restored,
+           checkpointSourceName(source));
+  return source;
+}
+
+bool SensorRelayManager::UpdateRelay(uint8_t slot, uint32_t nowMs) {
+  Relay &relay = *relays[slot];
+  bool shouldBeOn;
+  bool holding = false;
+
+  if (IsRelayFailSafe(slot)) {
+    // Conditions on a bad reading mean nothing; the minimum dwell still
+    // protects the load
+    FailSafeMode mode = relay.GetFailSafe();
+    shouldBeOn =
+        mode == kFailSafeHold ? relayStatuses[slot] : mode == kFailSafeOn;
+  } else {
+    METRICS_TIME(relayEvalMetric);
+    shouldBeOn = evaluateRelayConditions(relay, *this, nowMs);
+    for (int i = 0; i < MAX_CONDITIONS && relay.GetCondition(i); i++) {
+      holding |= relay.GetCondition(i)->IsHolding();
     }
+  }
+
+  if (shouldBeOn == relayStatuses[slot]) {
+    relay.SetPending(holding);
+    return false;
+  }
+  if (!relay.CanSwitch(relayStatuses[slot], nowMs)) {
+    relay.SetPending(true); // Retry once the dwell time is up
+    return false;
+  }
+  SwitchRelay(slot, shouldBeOn, nowMs);
+  relay.SetPending(holding);
+  return true;
+}
 
-    float sensorValue = sensor->GetValue();
-    float conditionValue = condition->GetValue();
-    const char *op = condition->GetOperator();
+bool SensorRelayManager::UpdateRelays(uint32_t nowMs) {
+  METRICS_TIME(relayUpdateMetric);
+  if (!indexBuilt) {
+    BuildIndex();
+  }
 
-    Serial.println(sensorValue);
-    Serial.println(conditionValue);
+  RelayMask work = (dirtyRelays | pendingRelays) & ~pidRelays;
+  dirtyRelays = 0;
+  pendingRelays = 0;
 
-    if (!evaluateCondition(op, sensorValue, conditionValue)) {
-      allConditionsTrue = false;
-      break;
+  bool changed = false;
+  while (work) {
+    uint8_t i = RELAY_MASK_LOWEST_BIT(work);
+    work &= work - 1;
+
+    if (UpdateRelay(i, nowMs)) {
+      changed = true;
+    }
+    if (relays[i]->IsPending()) {
+      pendingRelays |= (RelayMask)1 << i;
     }
   }
-  return hasConditions && allConditionsTrue;
+
+  // Every tick, not only on a switch: a write the bus NACKed stays dirty in
+  // its backend and is retried here
+  FlushOutputs();
+  return changed;
+}
+
+bool SensorRelayManager::UpdateControllers(uint32_t nowMs) {
+  METRICS_TIME(controlMetric);
+  if (!indexBuilt) {
+    BuildIndex();
+  }
+  float dtSeconds =
+      controllersRunning ? (nowMs - lastControlMs) * 0.001f : 0.0f;
+  lastControlMs = nowMs;
+  controllersRunning = true;
+
+  bool changed = false;
+  RelayMask work = pidRelays;
+  while (work) {
+    uint8_t i = RELAY_MASK_LOWEST_BIT(work);
+    work &= work - 1;
+
+    Relay &relay = *relays[i];
+    PidController &pid = relay.GetPid();
+    float duty;
+    if (IsRelayFailSafe(i)) {
+      FailSafeMode mode = relay.GetFailSafe();
+      duty = mode == kFailSafeHold ? relayDuty[i]
+                                   : (mode == kFailSafeOn ? 1.0f : 0.0f);
+      pid.Reset(); // Start afresh once the sensor is back
+    } else {
+      duty = pid.Update(sensorValues[pid.GetSensorSlot()], dtSeconds);
+    }
+
+    if (relay.GetOutput() == kOutputPwm) {
+      if (duty != relayDuty[i]) {
+        if (IoBackend *backend = GetBackend(relayIo[i])) {
+          backend->WriteDuty(relayPins[i], duty);
+        }
+      }
+      relayDuty[i] = duty;
+      relayStatuses[i] = duty > 0.0f;
+      continue;
+    }
+
+    // Time-proportioned: on for the first `duty` of every window, with the
+    // minimum on/off times as the shortest pulse
+    relayDuty[i] = duty;
+    bool on = relay.WindowPhase(nowMs) < duty;
+    if (on != relayStatuses[i] && relay.CanSwitch(relayStatuses[i], nowMs)) {
+      SwitchRelay(i, on, nowMs);
+      changed = true;
+    }
+  }
+
+  FlushOutputs(); // Also retries a failed write, as in UpdateRelays()
+  return changed;
 }
 
 #endif // SENSORS_H
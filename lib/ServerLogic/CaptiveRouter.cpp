@@ -0,0 +1,108 @@
+#include "CaptiveRouter.h"
+#include <Metrics.h>
+#include <WiFi.h>
+#include <ctype.h>
+
+// Connectivity checks of the common OSes, kept in flash
+static const CaptiveProbe kProbes[] = {
+    {"/generate_204", 302, nullptr},              // Android
+    {"/gen_204", 302, nullptr},                   // Android, Chrome
+    {"/mobile/status.php", 302, nullptr},         // Android (some vendors)
+    {"/hotspot-detect.html", 302, nullptr},       // iOS, macOS
+    {"/library/test/success.html", 302, nullptr}, // Older iOS
+    {"/ncsi.txt", 302, nullptr},                  // Windows
+    {"/connecttest.txt", 302, "http://logout.net"}, // Windows 10+
+    {"/redirect", 302, nullptr},                  // Windows 10+
+    {"/canonical.html", 302, nullptr},            // Firefox
+    {"/success.txt", 200, nullptr},               // Firefox
+    {"/wpad.dat", 404, nullptr},                  // Proxy auto-discovery
+    {"/favicon.ico", 404, nullptr},
+};
+static const uint8_t kNumProbes = sizeof(kProbes) / sizeof(kProbes[0]);
+static_assert(kNumProbes < CAPTIVE_ROUTER_SLOTS, "Too many probes");
+static_assert((CAPTIVE_ROUTER_SLOTS & (CAPTIVE_ROUTER_SLOTS - 1)) == 0,
+              "CAPTIVE_ROUTER_SLOTS must be a power of two");
+
+METRICS_COUNTER(captiveProbeMetric, "http_captive_probes",
+                "Probes and foreign-host requests answered by the portal");
+
+CaptiveRouter::CaptiveRouter(const char *portalUrl) : portalUrl(portalUrl) {
+  const char *scheme = strstr(portalUrl, "://");
+  portalHost = scheme ? scheme + 3 : portalUrl;
+
+  // Try seeds until every probe gets its own slot; with 12 probes in 32
+  // slots about one seed in eight works
+  for (seed = 0;; seed++) {
+    memset(slots, 0xFF, sizeof(slots));
+    uint8_t i = 0;
+    for (; i < kNumProbes; i++) {
+      uint8_t slot = Slot(kProbes[i].path);
+      if (slots[slot] != 0xFF) {
+        break;
+      }
+      slots[slot] = i;
+    }
+    if (i == kNumProbes) {
+      break;
+    }
+  }
+}
+
+uint8_t CaptiveRouter::Slot(const char *path) const {
+  // FNV-1a seeded through its offset basis, folded by a multiplicative hash
+  uint32_t hash = 2166136261u ^ seed;
+  for (; *path; path++) {
+    hash ^= (uint8_t)*path;
+    hash *= 16777619u;
+  }
+  return (hash * 2654435761u) >> 27 & (CAPTIVE_ROUTER_SLOTS - 1);
+}
+
+const CaptiveProbe *CaptiveRouter::Find(const char *path) const {
+  uint8_t index = slots[Slot(path)];
+  if (index == 0xFF || strcmp(kProbes[index].path, path) != 0) {
+    return nullptr;
+  }
+  return &kProbes[index];
+}
+
+bool CaptiveRouter::IsPortalHost(const char *host) const {
+  if (host[0] == '[') {
+    return true; // IPv6 literal, its colons aren't a port
+  }
+  size_t length = strcspn(host, ":"); // Without the port
+  if (length == 0) {
+    return true;
+  }
+  if (length == strlen(portalHost) &&
+      strncasecmp(host, portalHost, length) == 0) {
+    return true;
+  }
+  bool literal = true;
+  for (size_t i = 0; i < length && literal; i++) {
+    literal = isdigit((unsigned char)host[i]) || host[i] == '.';
+  }
+  return literal ||
+         (length > 6 && strncasecmp(host + length - 6, ".local", 6) == 0);
+}
+
+bool CaptiveRouter::canHandle(AsyncWebServerRequest *request) {
+  if (Find(request->url().c_str())) {
+    return true;
+  }
+  // Only clients of our access point were sent here by the captive DNS; on
+  // someone else's network a foreign Host is a proxy or a DNS alias
+  return (WiFi.getMode() & WIFI_AP) && !IsPortalHost(request->host().c_str());
+}
+
+void CaptiveRouter::handleRequest(AsyncWebServerRequest *request) {
+  METRICS_COUNT(captiveProbeMetric);
+  const CaptiveProbe *probe = Find(request->url().c_str());
+  if (!probe) {
+    request->redirect(portalUrl); // Foreign host
+  } else if (probe->status == 302) {
+    request->redirect(probe->location ? probe->location : portalUrl);
+  } else {
+    request->send(probe->status);
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef CAPTIVEROUTER_H
+#define CAPTIVEROUTER_H
+
+#include <ESPAsyncWebServer.h>
+
+/**
+ * @brief Answers OS connectivity probes and requests for foreign hosts
+ * @details Phones and laptops fire a burst of probes (/generate_204,
+ * /hotspot-detect.html, /ncsi.txt, ...) as soon as they join the access
+ * point. Instead of one server.on() handler per probe, all of them sit in
+ * a const table behind a perfect hash: a lookup is one hash of the path and
+ * one string compare, whatever the number of probes. While the access
+ * point is up, anything else asked of a host that is not the portal's is
+ * redirected to the portal. Register it first, so it is asked before the
+ * linear list of routes.
+ */
+#define CAPTIVE_ROUTER_SLOTS 32 // Power of two, well above the probe count
+
+/**
+ * @brief Fixed reply to one probe path
+ */
+struct CaptiveProbe {
+  const char *path;
+  uint16_t status;      // 302 redirects, anything else is sent as is
+  const char *location; // Redirect target, nullptr for the portal
+};
+
+class CaptiveRouter : public AsyncWebHandler {
+public:
+  /**
+   * @param portalUrl Where to send clients, e.g. "http://settings.dev";
+   * must outlive the router
+   */
+  explicit CaptiveRouter(const char *portalUrl);
+
+  /**
+   * @brief Probe registered for `path`, nullptr if there is none
+   */
+  const CaptiveProbe *Find(const char *path) const;
+
+  /**
+   * @brief Whether `host` (a Host header) addresses this device
+   * @details The portal's name, an IPv4 or IPv6 literal, a .local name or
+   * no host
+   */
+  bool IsPortalHost(const char *host) const;
+
+  bool canHandle(AsyncWebServerRequest *request) override;
+  void handleRequest(AsyncWebServerRequest *request) override;
+  bool isRequestHandlerTrivial() override { return true; }
+
+private:
+  uint8_t Slot(const char *path) const;
+
+  const char *portalUrl;
+  const char *portalHost; // Points into portalUrl
+  uint16_t seed = 0;      // Makes Slot() collision-free over the probes
+  uint8_t slots[CAPTIVE_ROUTER_SLOTS]; // Probe index, 0xFF if empty
+};
+
+#endif // CAPTIVEROUTER_H
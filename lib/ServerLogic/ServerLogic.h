@@ -3,45 +3,50 @@
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
+#include <BootProfile.h>
+#include <CaptiveRouter.h>
+#include <CrashLog.h>
 #include <ESPAsyncWebServer.h>
 #include <Helpers.h>
+#include <Logger.h>
+#include <MemoryMonitor.h>
+#include <Metrics.h>
 #include <Preferences.h>
 #include <Sensors.h>
+#include <Supervisor.h>
 #include <Update.h>
+#include <WiFi.h>
 #include <index.h>
 
+#define SERVER_HEALTH_TIMEOUT_MS 1000 // For IsServerAnswering()
+
 extern SensorRelayManager manager;
+extern MemoryMonitor memory_monitor;
+extern CrashLog crash_log;
+extern BootProfile boot_profile;
+extern Supervisor supervisor;
 extern JsonDocument doc;
 extern InternalTime internal_time;
 extern const char *localUrl;
 
+// Time spent in the handlers (not sending), exported on /metrics
+METRICS_HISTOGRAM(httpPageMetric, "http_page", "Handling GET /");
+METRICS_HISTOGRAM(httpReadValuesMetric, "http_read_values",
+                  "Handling GET /readValues");
+METRICS_HISTOGRAM(httpReadAdcMetric, "http_read_adc", "Handling GET /readADC");
+METRICS_HISTOGRAM(httpSubmitSensorsMetric, "http_submit_sensors",
+                  "Handling POST /submit-sensors");
+METRICS_HISTOGRAM(httpTunePidMetric, "http_tune_pid",
+                  "Handling POST /tune-pid");
+
+CaptiveRouter captiveRouter(localUrl);
+
 void SetupServer(AsyncWebServer &server, const IPAddress &localIP) {
-  server.on("/wpad.dat",
-            [](AsyncWebServerRequest *request) { request->send(404); });
-  server.on("/connecttest.txt", [](AsyncWebServerRequest *request) {
-    request->redirect("http://logout.net");
-  });
-  server.on("/redirect", [](AsyncWebServerRequest *request) {
-    request->redirect(localUrl);
-  });
-  server.on("/generate_204", [](AsyncWebServerRequest *request) {
-    request->redirect(localUrl);
-  });
-  server.on("/hotspot-detect.html", [](AsyncWebServerRequest *request) {
-    request->redirect(localUrl);
-  });
-  server.on("/ncsi.txt", [](AsyncWebServerRequest *request) {
-    request->redirect(localUrl);
-  });
-  server.on("/success.txt",
-            [](AsyncWebServerRequest *request) { request->send(200); });
-  server.on("/canonical.html", [](AsyncWebServerRequest *request) {
-    request->redirect(localUrl);
-  });
-  server.on("/favicon.ico",
-            [](AsyncWebServerRequest *request) { request->send(404); });
+  // OS connectivity probes and foreign hosts first, ahead of the routes
+  server.addHandler(&captiveRouter);
 
   server.on("/", HTTP_ANY, [](AsyncWebServerRequest *request) {
+    METRICS_TIME(httpPageMetric);
     AsyncWebServerResponse *response =
         request->beginResponse(200, "text/html", MAIN_page);
     response->addHeader("Cache-Control", "public,max-age=31536000");
@@ -77,6 +82,8 @@ void SetupServer(AsyncWebServer &server, const IPAddress &localIP) {
   });
 
   server.on("/readValues", HTTP_GET, [](AsyncWebServerRequest *request) {
+    METRICS_TIME(httpReadValuesMetric);
+    std::lock_guard<std::mutex> lock(manager.GetConfigLock());
     JsonDocument doc;
     JsonArray sensorsArray = doc["sensors"].to<JsonArray>(); // Updated
     JsonArray relaysArray = doc["relays"].to<JsonArray>();   // Updated
@@ -86,8 +93,9 @@ void SetupServer(AsyncWebServer &server, const IPAddress &localIP) {
       if (sensor) {
         JsonObject sensorObj = sensorsArray.add<JsonObject>(); // Updated
         sensorObj["id"] = sensor->GetId();
-        float value = sensor->GetValue();
+        float value = manager.GetSensorValue(i);
         sensorObj["value"] = value;
+        sensorObj["fault"] = sensorFaultName(manager.GetSensorFault(i));
       }
     }
 
@@ -96,8 +104,12 @@ void SetupServer(AsyncWebServer &server, const IPAddress &localIP) {
       if (relay) {
         JsonObject relayObj = relaysArray.add<JsonObject>(); // Updated
         relayObj["id"] = relay->GetId();
-        bool status = relay->IsOn();
+        bool status = manager.GetRelayStatus(i);
         relayObj["status"] = status;
+        relayObj["inFailSafe"] = manager.IsRelayFailSafe(i);
+        if (relay->IsProportional()) {
+          relayObj["duty"] = manager.GetRelayDuty(i);
+        }
       }
     }
 
@@ -107,6 +119,8 @@ void SetupServer(AsyncWebServer &server, const IPAddress &localIP) {
   });
 
   server.on("/readADC", HTTP_GET, [](AsyncWebServerRequest *request) {
+    METRICS_TIME(httpReadAdcMetric);
+    std::lock_guard<std::mutex> lock(manager.GetConfigLock());
     JsonDocument doc;
     JsonArray sensorsArray = doc["sensors"].to<JsonArray>(); // Updated
     JsonArray relaysArray = doc["relays"].to<JsonArray>();   // Updated
@@ -117,9 +131,16 @@ void SetupServer(AsyncWebServer &server, const IPAddress &localIP) {
         JsonObject sensorObj = sensorsArray.add<JsonObject>(); // Updated
         sensorObj["id"] = sensor->GetId();
         sensorObj["pin"] = sensor->GetPin();
+        sensorObj["io"] = sensor->GetIo();
         sensorObj["name"] = sensor->GetName();
-        float value = sensor->GetValue();
+        float value = manager.GetSensorValue(i);
         sensorObj["value"] = value;
+        sensorObj["unit"] = manager.GetSensorUnit(i);
+        sensorObj["raw"] = manager.GetSensorRaw(i);
+        calibrationToJson(sensor->GetCalibration(), sensorObj);
+        filterToJson(sensor->GetFilter(), sensorObj);
+        healthToJson(sensor->GetHealth(), sensorObj);
+        sensorObj["fault"] = sensorFaultName(manager.GetSensorFault(i));
       }
     }
 
@@ -130,6 +151,15 @@ void SetupServer(AsyncWebServer &server, const IPAddress &localIP) {
         relayObj["id"] = relay->GetId();
         relayObj["name"] = relay->GetName();
         relayObj["pin"] = relay->GetPin();
+        relayObj["io"] = relay->GetIo();
+        relayObj["minOn"] = relay->GetMinOnSeconds();
+        relayObj["minOff"] = relay->GetMinOffSeconds();
+        relayObj["failSafe"] = failSafeModeName(relay->GetFailSafe());
+        relayObj["inFailSafe"] = manager.IsRelayFailSafe(i);
+        pidToJson(*relay, relayObj);
+        if (relay->IsProportional()) {
+          relayObj["duty"] = manager.GetRelayDuty(i);
+        }
         JsonArray conditionsArray =
             relayObj["conditions"].to<JsonArray>(); // Updated
         for (int j = 0; j < MAX_CONDITIONS; j++) {
@@ -142,12 +172,30 @@ void SetupServer(AsyncWebServer &server, const IPAddress &localIP) {
             condObj["operator"] = condition->GetOperator();
             condObj["value"] = condition->GetValue();
             condObj["type"] = condition->GetType();
+            condObj["hysteresis"] = condition->GetHysteresis();
+            condObj["hold"] = condition->GetHoldSeconds();
+            condObj["parent"] = condition->GetParent();
+            if (condition->IsSchedule()) {
+              condObj["period"] = condition->GetSchedule().period;
+              condObj["start"] = condition->GetSchedule().start;
+              condObj["duration"] = condition->GetSchedule().duration;
+            }
           } else {
             break;
           }
         }
       }
     }
+    // Fitted I/O hardware, for the settings selects
+    JsonArray backendsArray = doc["backends"].to<JsonArray>();
+    for (int i = 0; i < MAX_IO_BACKENDS; i++) {
+      IoBackend *backend = manager.GetBackend(i);
+      if (backend) {
+        JsonObject backendObj = backendsArray.add<JsonObject>();
+        backendObj["id"] = i;
+        backendObj["name"] = backend->GetName();
+      }
+    }
     String jsonString;
     serializeJson(doc, jsonString);
     request->send(200, "application/json", jsonString);
@@ -173,12 +221,6 @@ void SetupServer(AsyncWebServer &server, const IPAddress &localIP) {
     String password = "";
 
     if (request->params() >= 3) {
-      Serial.println("got wifi");
-      for (size_t i = 0; i < request->params(); i++) {
-        Serial.println(i);
-        Serial.println(request->getParam(i)->value());
-      }
-
       // Wifi mode (wifi/hotspot)
       AsyncWebParameter *modeParam = request->getParam(0);
       if (modeParam != nullptr) {
@@ -199,7 +241,8 @@ void SetupServer(AsyncWebServer &server, const IPAddress &localIP) {
 
       Preferences prefs;
       prefs.begin("wifi", false);
-      Serial.println("Wifi mode: " + wifiMode);
+      LOG_INFO("WiFi settings saved, mode %s",
+               wifiMode ? "station" : "hotspot");
       prefs.putBool("wifimode", wifiMode);
       prefs.putString("wifissid", ssid);
       prefs.putString("wifipass", password);
@@ -236,65 +279,260 @@ void SetupServer(AsyncWebServer &server, const IPAddress &localIP) {
         }
       });
 
+#if METRICS_ENABLED
+  // Prometheus scrape target
+  server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+    AsyncResponseStream *response =
+        request->beginResponseStream("text/plain; version=0.0.4");
+    Metrics::WritePrometheus(*response);
+    response->printf("# TYPE " METRICS_PREFIX "heap_free_bytes gauge\n"
+                     METRICS_PREFIX "heap_free_bytes %lu\n",
+                     (unsigned long)memory_monitor.GetFreeHeap());
+    response->printf("# TYPE " METRICS_PREFIX "heap_largest_block_bytes gauge\n"
+                     METRICS_PREFIX "heap_largest_block_bytes %lu\n",
+                     (unsigned long)memory_monitor.GetLargestBlock());
+    response->printf("# TYPE " METRICS_PREFIX "heap_fragmentation_ratio gauge\n"
+                     METRICS_PREFIX "heap_fragmentation_ratio %.2f\n",
+                     memory_monitor.GetFragmentation() / 100.0f);
+    request->send(response);
+  });
+#endif
+
+  // When each boot phase finished, in ms since the app started
+  server.on("/boot", HTTP_GET, [](AsyncWebServerRequest *request) {
+    JsonDocument doc;
+    JsonArray phases = doc["phases"].to<JsonArray>();
+    for (uint8_t i = 0; i < boot_profile.GetNumPhases(); i++) {
+      const BootPhase &phase = boot_profile.GetPhase(i);
+      JsonObject phaseObj = phases.add<JsonObject>();
+      phaseObj["name"] = phase.name;
+      phaseObj["ms"] = phase.us / 1000.0f;
+    }
+    doc["timeToControlMs"] = boot_profile.GetPhaseUs("control") / 1000.0f;
+
+    String jsonString;
+    serializeJson(doc, jsonString);
+    request->send(200, "application/json", jsonString);
+  });
+
+  // Raw core dump of the last crash, for espcoredump.py. Registered before
+  // /crash, which would otherwise match this path too.
+  server.on("/crash/core", HTTP_GET, [](AsyncWebServerRequest *request) {
+    size_t size = crash_log.GetCoreDumpSize();
+    if (size == 0) {
+      request->send(404, "text/plain", "No core dump");
+      return;
+    }
+    AsyncWebServerResponse *response = request->beginResponse(
+        "application/octet-stream", size,
+        [](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+          return crash_log.ReadCoreDump(index, buffer, maxLen);
+        });
+    response->addHeader("Content-Disposition",
+                        "attachment; filename=\"core.elf\"");
+    request->send(response);
+  });
+
+  // Summary of the last crash and the reset counters
+  server.on("/crash", HTTP_GET, [](AsyncWebServerRequest *request) {
+    JsonDocument doc;
+    doc["boot"] = crash_log.GetBootCount();
+    doc["resetReason"] = resetReasonName(crash_log.GetResetReason());
+    doc["crashes"] = crash_log.GetCrashCount();
+    JsonObject resets = doc["resets"].to<JsonObject>();
+    for (uint8_t reason = 0; reason < CRASH_RESET_REASONS; reason++) {
+      if (crash_log.GetResetCount(reason)) {
+        resets[resetReasonName(reason)] = crash_log.GetResetCount(reason);
+      }
+    }
+
+    if (crash_log.HasCrash()) {
+      const CrashRecord &crash = crash_log.GetCrash();
+      JsonObject crashObj = doc["crash"].to<JsonObject>();
+      char hex[11];
+      crashObj["boot"] = crash.boot;
+      crashObj["reason"] = resetReasonName(crash.resetReason);
+      crashObj["task"] = (const char *)crash.task;
+      snprintf(hex, sizeof(hex), "0x%08lx", (unsigned long)crash.pc);
+      crashObj["pc"] = String(hex);
+      crashObj["cause"] = crash.cause;
+      crashObj["causeName"] = exceptionCauseName(crash.cause);
+      snprintf(hex, sizeof(hex), "0x%08lx", (unsigned long)crash.address);
+      crashObj["address"] = String(hex);
+      JsonArray backtrace = crashObj["backtrace"].to<JsonArray>();
+      for (uint8_t i = 0; i < crash.depth; i++) {
+        snprintf(hex, sizeof(hex), "0x%08lx",
+                 (unsigned long)crash.backtrace[i]);
+        backtrace.add(String(hex));
+      }
+      crashObj["corrupted"] = crash.corrupted;
+      crashObj["elfSha"] = (const char *)crash.elfSha;
+    } else {
+      doc["crash"] = nullptr;
+    }
+    doc["coreDumpSize"] = crash_log.GetCoreDumpSize();
+    doc["coreDumpBoot"] = crash_log.GetCoreDumpBoot();
+
+    String jsonString;
+    serializeJson(doc, jsonString);
+    AsyncWebServerResponse *response =
+        request->beginResponse(200, "application/json", jsonString);
+    response->addHeader("Content-Disposition",
+                        "inline; filename=\"crash.json\"");
+    request->send(response);
+  });
+
+  // Acknowledge the crash: drop the record and erase the core dump
+  server.on("/crash", HTTP_DELETE, [](AsyncWebServerRequest *request) {
+    crash_log.Clear();
+    request->send(200, "text/plain", "Crash record cleared");
+  });
+
+  // Watermarks from the last memory sample (taken by loop(), once a second)
+  server.on("/memory", HTTP_GET, [](AsyncWebServerRequest *request) {
+    JsonDocument doc;
+    doc["freeHeap"] = memory_monitor.GetFreeHeap();
+    doc["minFreeHeap"] = memory_monitor.GetMinFreeHeap();
+    doc["largestBlock"] = memory_monitor.GetLargestBlock();
+    doc["minLargestBlock"] = memory_monitor.GetMinLargestBlock();
+    doc["fragmentation"] = memory_monitor.GetFragmentation();
+    doc["maxFragmentation"] = memory_monitor.GetMaxFragmentation();
+    doc["samples"] = memory_monitor.GetSamples();
+
+    JsonArray alarms = doc["alarms"].to<JsonArray>();
+    for (uint8_t bit = 1; bit; bit <<= 1) {
+      if (memory_monitor.GetAlarms() & bit) {
+        alarms.add(memoryAlarmName((MemoryAlarm)bit));
+      }
+    }
+
+    JsonArray tasks = doc["tasks"].to<JsonArray>();
+    for (uint8_t i = 0; i < memory_monitor.GetNumTasks(); i++) {
+      const TaskWatermark &task = memory_monitor.GetTask(i);
+      JsonObject taskObj = tasks.add<JsonObject>();
+      taskObj["name"] = task.name;
+      taskObj["stackFree"] = task.stackFree;
+    }
+
+    String jsonString;
+    serializeJson(doc, jsonString);
+    request->send(200, "application/json", jsonString);
+  });
+
+  // Heartbeat latencies and restarts of the supervised subsystems
+  // Asked by the network task through IsServerAnswering()
+  server.on("/health", HTTP_GET,
+            [](AsyncWebServerRequest *request) { request->send(204); });
+
+  server.on("/supervisor", HTTP_GET, [](AsyncWebServerRequest *request) {
+    JsonDocument doc;
+    uint32_t now = millis();
+    JsonArray subsystems = doc["subsystems"].to<JsonArray>();
+    for (uint8_t i = 0; i < supervisor.GetNumSubsystems(); i++) {
+      const Subsystem &subsystem = supervisor.GetSubsystem(i);
+      uint32_t lastBeat = subsystem.lastBeatMs.load(std::memory_order_relaxed);
+      JsonObject subsystemObj = subsystems.add<JsonObject>();
+      subsystemObj["name"] = subsystem.name;
+      subsystemObj["timeoutMs"] = subsystem.timeoutMs;
+      if (lastBeat) {
+        subsystemObj["sinceBeatMs"] = now - lastBeat;
+      } else {
+        subsystemObj["sinceBeatMs"] = nullptr;
+      }
+      subsystemObj["latencyMs"] = subsystem.lastLatencyMs;
+      subsystemObj["maxLatencyMs"] = subsystem.maxLatencyMs;
+      subsystemObj["restarts"] = subsystem.restarts;
+      subsystemObj["watchdog"] =
+          subsystem.task.load(std::memory_order_relaxed) != nullptr;
+    }
+    if (supervisor.GetRebootReason()) {
+      doc["lastReboot"] = supervisor.GetRebootReason();
+    } else {
+      doc["lastReboot"] = nullptr;
+    }
+
+    String jsonString;
+    serializeJson(doc, jsonString);
+    request->send(200, "application/json", jsonString);
+  });
+
+  // Live PID tuning: new setpoint and gains take effect on the next control
+  // step without resetting the loop. Not saved until /submit-sensors.
+  server.on("/tune-pid", HTTP_POST, [](AsyncWebServerRequest *request) {
+    METRICS_TIME(httpTunePidMetric);
+    std::lock_guard<std::mutex> lock(manager.GetConfigLock());
+    if (!request->hasParam("id", true)) {
+      request->send(400, "text/plain", "No relay id");
+      return;
+    }
+    Relay *relay = manager.GetRelayById(
+        request->getParam("id", true)->value().toInt());
+    if (relay == nullptr || !relay->IsProportional()) {
+      request->send(404, "text/plain", "No such PID relay");
+      return;
+    }
+
+    // Applied by loop(), between two steps of the controller
+    auto param = [request](const char *name) {
+      return request->hasParam(name, true)
+                 ? request->getParam(name, true)->value().toFloat()
+                 : NAN;
+    };
+    PidTuning tuning = {relay->GetId(), param("setpoint"), param("kp"),
+                        param("ki"), param("kd")};
+    manager.QueuePidTuning(tuning);
+    request->send(200, "text/plain", "PID updated");
+  });
+
   server.on("/submit-sensors", HTTP_POST, [](AsyncWebServerRequest *request) {
+    METRICS_TIME(httpSubmitSensorsMetric);
     if (request->hasParam("body", true)) {
       String jsonStr = request->getParam("body", true)->value();
       JsonDocument doc;
       DeserializationError error = deserializeJson(doc, jsonStr);
 
       if (error) {
-        Serial.println("Invalid JSON received: " + String(error.c_str()));
+        LOG_WARN("Invalid JSON received: %s", error.c_str());
         request->send(400, "text/plain", "Invalid JSON");
         return;
       }
 
-      manager.Clear();
-
-      JsonArray sensorsArray = doc["sensors"];
-      for (JsonObject sensorObj : sensorsArray) {
-        uint8_t id = sensorObj["id"].as<int>();
-        String name = sensorObj["name"].as<String>();
-        uint8_t pin = sensorObj["pin"].as<int>();
-        float value = 0.0;
-        bool folded = true;
-        Sensor *sensor = new Sensor(id, name.c_str(), pin, value, folded);
-        manager.RegisterSensor(sensor);
-      }
-
-      JsonArray relaysArray = doc["relays"];
-      for (JsonObject relayObj : relaysArray) {
-        uint8_t id = relayObj["id"].as<int>();
-        String name = relayObj["name"].as<String>();
-        uint8_t pin = relayObj["pin"].as<int>();
-        bool status = false;
-        bool folded = false;
-        Relay *relay = new Relay(id, name.c_str(), pin, status, folded);
-
-        JsonArray conditionsArray = relayObj["conditions"];
-        for (JsonObject conditionObj : conditionsArray) {
-          uint8_t conditionId = conditionObj["id"].as<int>();
-          uint8_t sensor = conditionObj["sensor"].as<int>();
-          uint8_t sensorId = conditionObj["sensorId"].as<int>();
-          String op = conditionObj["operator"].as<String>();
-          float value = conditionObj["value"].as<float>();
-          String type = conditionObj["type"].as<String>();
-          Condition *condition = new Condition(
-              sensor, sensorId, op.c_str(), value, conditionId, type.c_str());
-          relay->AddCondition(condition);
-        }
-
-        manager.RegisterRelay(relay);
-        pinMode(pin, OUTPUT);
-        digitalWrite(pin, status ? HIGH : LOW);
-      }
-
-      manager.SaveToPreferences();
+      // Swapped in and saved by loop(), between two control passes
+      SensorRelayConfig *config = new SensorRelayConfig;
+      configFromJson(*config, doc.as<JsonObject>());
+      manager.QueueConfig(config);
       request->send(200, "text/plain", "Sensors and relays updated");
     } else {
-      Serial.println("No data received in request");
+      LOG_WARN("No data received in request");
       request->send(400, "text/plain", "No data received");
     }
   });
 }
 
+/**
+ * @brief Ask the web server for /health over the loopback interface
+ * @details Only a reply shows the AsyncTCP task is still accepting and
+ * answering requests. Blocks the caller for up to SERVER_HEALTH_TIMEOUT_MS.
+ * @return bool True if it answered 204 in time
+ */
+bool IsServerAnswering() {
+  WiFiClient client;
+  if (!client.connect(IPAddress(127, 0, 0, 1), 80, SERVER_HEALTH_TIMEOUT_MS)) {
+    return false;
+  }
+  client.print("GET /health HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+               "Connection: close\r\n\r\n");
+  uint32_t start = millis();
+  while (!client.available()) {
+    if (!client.connected() || millis() - start >= SERVER_HEALTH_TIMEOUT_MS) {
+      client.stop();
+      return false;
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+  String status = client.readStringUntil('\n');
+  client.stop();
+  return status.startsWith("HTTP/1.1 204");
+}
+
 #endif // SERVER_SETUP_H
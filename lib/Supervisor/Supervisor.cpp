@@ -0,0 +1,168 @@
+#include "Supervisor.h"
+#include <Logger.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <esp_task_wdt.h>
+
+#define SUPERVISOR_REBOOT_MAGIC 0x53555056 // "SUPV"
+
+// Which subsystem the supervisor rebooted for, read back on the next boot
+RTC_NOINIT_ATTR static struct {
+  uint32_t magic;
+  char reason[16];
+} lastReboot;
+
+void Supervisor::Begin() {
+  // Reconfigures the TWDT the IDF started, and makes it panic so a hang
+  // that gets past the supervisor leaves a core dump behind
+#if defined(ESP_IDF_VERSION_MAJOR) && ESP_IDF_VERSION_MAJOR >= 5
+  // IDF 5 replaces the whole config, so keep watching the same idle tasks
+  esp_task_wdt_config_t config = {
+      .timeout_ms = SUPERVISOR_TWDT_S * 1000,
+      .idle_core_mask = 0,
+      .trigger_panic = true,
+  };
+#ifdef CONFIG_ESP_TASK_WDT_CHECK_IDLE_TASK_CPU0
+  config.idle_core_mask |= 1 << 0;
+#endif
+#ifdef CONFIG_ESP_TASK_WDT_CHECK_IDLE_TASK_CPU1
+  config.idle_core_mask |= 1 << 1;
+#endif
+  if (esp_task_wdt_reconfigure(&config) == ESP_ERR_INVALID_STATE) {
+    esp_task_wdt_init(&config); // Not started at boot on this build
+  }
+#else
+  esp_task_wdt_init(SUPERVISOR_TWDT_S, true);
+#endif
+
+  if (lastReboot.magic == SUPERVISOR_REBOOT_MAGIC &&
+      esp_reset_reason() == ESP_RST_SW) {
+    strncpy(rebootReason, lastReboot.reason, sizeof(rebootReason) - 1);
+    LOG_WARN("Supervisor rebooted the last run: %s stalled", rebootReason);
+  }
+  lastReboot.magic = 0;
+}
+
+int8_t Supervisor::Add(const char *name, uint32_t timeoutMs,
+                       SubsystemRestart restart, void *arg) {
+  if (numSubsystems >= SUPERVISOR_MAX_SUBSYSTEMS) {
+    return -1;
+  }
+  Subsystem &subsystem = subsystems[numSubsystems];
+  subsystem.name = name;
+  subsystem.timeoutMs = timeoutMs;
+  subsystem.restart = restart;
+  subsystem.arg = arg;
+  return numSubsystems++;
+}
+
+void Supervisor::Attach(uint8_t id) {
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  subsystems[id].task.store(self, std::memory_order_release);
+  esp_task_wdt_add(self);
+}
+
+void Supervisor::Detach(uint8_t id) {
+  Subsystem &subsystem = subsystems[id];
+  TaskHandle_t self = subsystem.task.exchange(nullptr);
+  if (self) {
+    esp_task_wdt_delete(self);
+  }
+  subsystem.lastBeatMs.store(0, std::memory_order_release);
+}
+
+void Supervisor::Beat(uint8_t id) {
+  Subsystem &subsystem = subsystems[id];
+  uint32_t now = millis();
+  uint32_t last = subsystem.lastBeatMs.load(std::memory_order_relaxed);
+  if (last) {
+    subsystem.lastLatencyMs = now - last;
+    if (subsystem.lastLatencyMs > subsystem.maxLatencyMs) {
+      subsystem.maxLatencyMs = subsystem.lastLatencyMs;
+    }
+  }
+  subsystem.lastBeatMs.store(now ? now : 1, std::memory_order_release);
+  if (subsystem.task.load(std::memory_order_relaxed)) {
+    esp_task_wdt_reset();
+  }
+}
+
+SupervisorAction Supervisor::Check(uint32_t nowMs) {
+  SupervisorAction action = kSupervisorOk;
+  for (uint8_t i = 0; i < numSubsystems; i++) {
+    Subsystem &subsystem = subsystems[i];
+    uint32_t last = subsystem.lastBeatMs.load(std::memory_order_acquire);
+    // Signed, as a beat can land between reading nowMs and getting here
+    if (!last || (int32_t)(nowMs - last) <= (int32_t)subsystem.timeoutMs) {
+      continue;
+    }
+    uint32_t silentMs = nowMs - last;
+    LOG_WARN("Supervisor: %s silent for %u ms", subsystem.name, silentMs);
+    // It may never beat again to report this gap itself
+    if (silentMs > subsystem.maxLatencyMs) {
+      subsystem.maxLatencyMs = silentMs;
+    }
+
+    // Off the TWDT first, so the watchdog does not fire while it restarts
+    TaskHandle_t hung = subsystem.task.exchange(nullptr);
+    if (hung) {
+      esp_task_wdt_delete(hung);
+    }
+
+    if (nowMs - subsystem.windowStartMs >= SUPERVISOR_RESTART_WINDOW_MS) {
+      subsystem.windowStartMs = nowMs;
+      subsystem.recentRestarts = 0;
+    }
+    if (subsystem.restart &&
+        subsystem.recentRestarts < SUPERVISOR_MAX_RESTARTS) {
+      subsystem.recentRestarts++;
+      subsystem.restarts++;
+      // A full timeout for the new instance to come up and beat
+      subsystem.lastBeatMs.store(nowMs ? nowMs : 1,
+                                 std::memory_order_release);
+      if (subsystem.restart(hung, subsystem.arg)) {
+        LOG_WARN("Supervisor: %s restarted (%u in this window)",
+                 subsystem.name, subsystem.recentRestarts);
+        action = kSupervisorRestarted;
+        continue;
+      }
+      LOG_ERROR("Supervisor: %s failed to restart", subsystem.name);
+    }
+
+    strncpy(rebootReason, subsystem.name, sizeof(rebootReason) - 1);
+    return kSupervisorReboot;
+  }
+  return action;
+}
+
+void Supervisor::Task(void *arg) {
+  Supervisor &supervisor = *static_cast<Supervisor *>(arg);
+  esp_task_wdt_add(nullptr);
+  TickType_t wake = xTaskGetTickCount();
+  for (;;) {
+    esp_task_wdt_reset();
+    if (supervisor.Check(millis()) == kSupervisorReboot) {
+      LOG_ERROR("Supervisor: %s stalled, rebooting", supervisor.rebootReason);
+      if (supervisor.rebootHook) {
+        supervisor.rebootHook(supervisor.rebootReason);
+      }
+      memcpy(lastReboot.reason, supervisor.rebootReason,
+             sizeof(lastReboot.reason));
+      lastReboot.magic = SUPERVISOR_REBOOT_MAGIC;
+      // Give the log task a chance to write the lines above
+      vTaskDelay(pdMS_TO_TICKS(LOG_FLUSH_MS * 5));
+      esp_restart();
+    }
+    vTaskDelayUntil(&wake, pdMS_TO_TICKS(SUPERVISOR_CHECK_MS));
+  }
+}
+
+bool Supervisor::Start(SupervisorRebootHook hook) {
+  rebootHook = hook;
+  if (task) {
+    return true;
+  }
+  return xTaskCreatePinnedToCore(Task, "supervisor", SUPERVISOR_TASK_STACK,
+                                 this, SUPERVISOR_TASK_PRIORITY, &task,
+                                 SUPERVISOR_TASK_CORE) == pdPASS;
+}
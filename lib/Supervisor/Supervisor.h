@@ -0,0 +1,124 @@
+#ifndef SUPERVISOR_H
+#define SUPERVISOR_H
+
+#include <Arduino.h>
+#include <atomic>
+
+/**
+ * @brief Heartbeat supervision of the firmware's tasks, backed by the TWDT
+ * @details Each subsystem calls Beat() from its own task. The supervisor task
+ * checks every SUPERVISOR_CHECK_MS that no subsystem went quiet for longer
+ * than its timeout. A stalled subsystem is restarted through its restart
+ * function if it has one, at most SUPERVISOR_MAX_RESTARTS times per
+ * SUPERVISOR_RESTART_WINDOW_MS; otherwise the supervisor checkpoints and
+ * reboots. The task watchdog, at SUPERVISOR_TWDT_S (longer than every
+ * subsystem timeout), is the last resort for when the supervisor itself
+ * cannot run: it panics, which leaves a core dump for the CrashLog.
+ */
+#define SUPERVISOR_MAX_SUBSYSTEMS 4
+#define SUPERVISOR_CHECK_MS 500
+#define SUPERVISOR_TWDT_S 30
+#define SUPERVISOR_MAX_RESTARTS 3
+#define SUPERVISOR_RESTART_WINDOW_MS 600000 // 10 minutes
+#define SUPERVISOR_TASK_STACK 3072
+#define SUPERVISOR_TASK_PRIORITY 5 // Above the tasks it watches
+#define SUPERVISOR_TASK_CORE 0
+
+/**
+ * @brief Restarts a stalled subsystem, called from the supervisor task
+ * @param hung Task that stopped beating (already off the TWDT), or nullptr
+ * @return false if it could not, which escalates to a reboot
+ */
+typedef bool (*SubsystemRestart)(TaskHandle_t hung, void *arg);
+
+/**
+ * @brief Checkpoint before a supervisor reboot (relay states, ...)
+ */
+typedef void (*SupervisorRebootHook)(const char *reason);
+
+enum SupervisorAction : uint8_t {
+  kSupervisorOk,
+  kSupervisorRestarted, // A subsystem was restarted
+  kSupervisorReboot,    // A subsystem stalled and could not be restarted
+};
+
+/**
+ * @brief One supervised subsystem
+ */
+struct Subsystem {
+  const char *name;      // Literal
+  uint32_t timeoutMs;    // Longest silence before it counts as stalled
+  SubsystemRestart restart;
+  void *arg;
+  std::atomic<TaskHandle_t> task{nullptr}; // On the TWDT, set by Attach()
+  std::atomic<uint32_t> lastBeatMs{0};     // 0 until the first beat
+  uint32_t maxLatencyMs = 0; // Longest time between two beats
+  uint32_t lastLatencyMs = 0;
+  uint16_t restarts = 0;     // Since boot
+  uint8_t recentRestarts = 0; // In the current window
+  uint32_t windowStartMs = 0;
+};
+
+class Supervisor {
+public:
+  /**
+   * @brief Configure the TWDT and report a reboot done by the last run
+   */
+  void Begin();
+
+  /**
+   * @brief Supervise a subsystem
+   * @param restart nullptr if it can only be recovered by a reboot
+   * @return Its id for Attach() and Beat(), -1 if the table is full
+   */
+  int8_t Add(const char *name, uint32_t timeoutMs,
+             SubsystemRestart restart = nullptr, void *arg = nullptr);
+
+  /**
+   * @brief Put the calling task on the TWDT for subsystem `id`
+   * @note Call from the subsystem's task, Detach() before it ends
+   */
+  void Attach(uint8_t id);
+  void Detach(uint8_t id);
+
+  /**
+   * @brief The calling subsystem is alive (also feeds the TWDT)
+   */
+  void Beat(uint8_t id);
+
+  /**
+   * @brief Look for stalled subsystems and restart them
+   * @return kSupervisorReboot if one has to be recovered by a reboot
+   * @note Runs in the supervisor task; public for driving it by hand
+   */
+  SupervisorAction Check(uint32_t nowMs);
+
+  /**
+   * @brief Start the supervisor task
+   * @param hook Called before a reboot, from the supervisor task
+   */
+  bool Start(SupervisorRebootHook hook = nullptr);
+
+  uint8_t GetNumSubsystems() const { return numSubsystems; }
+  const Subsystem &GetSubsystem(uint8_t id) const { return subsystems[id]; }
+
+  /**
+   * @brief Subsystem that made the supervisor reboot, nullptr if none did
+   * @details Valid from Check() returning kSupervisorReboot, and after
+   * Begin() for the reboot the previous run did
+   */
+  const char *GetRebootReason() const {
+    return rebootReason[0] ? rebootReason : nullptr;
+  }
+
+private:
+  static void Task(void *arg);
+
+  Subsystem subsystems[SUPERVISOR_MAX_SUBSYSTEMS];
+  uint8_t numSubsystems = 0;
+  SupervisorRebootHook rebootHook = nullptr;
+  TaskHandle_t task = nullptr;
+  char rebootReason[16] = "";
+};
+
+#endif // SUPERVISOR_H
@@ -3,9 +3,15 @@
 
 #include <Arduino.h>
 #include <Helpers.h>
+#include <Logger.h>
+#include <InputEvent.h>
 #include <U8g2lib.h>
+#include <new>
 
-#define MAX_SCREENS 20
+#define MAX_SCREENS 20          // Screen IDs must be below this
+#define NAV_STACK_DEPTH 8       // Maximum nesting of opened screens
+#define NAV_BACK 0xFF           // HandleInput result: go to the previous screen
+#define SCREEN_ARENA_SIZE 1024  // Bytes shared by lazily built screens
 
 /**
  * @brief Base class for all UI screens
@@ -15,6 +21,9 @@ public:
   // Constructor with screen identifier
   Screen(uint8_t s) : screen_id(s) {}
 
+  // Virtual destructor so lazily built screens can be torn down
+  virtual ~Screen() {}
+
   /**
    * @brief Pure virtual function for drawing the screen content
    * @note This method must be overridden by derived classes
@@ -24,9 +33,27 @@ public:
   /**
    * @brief Virtual function to handle user input events
    * @param input The input event code (e.g., button press)
-   * @return uint8_t Action code indicating the result of handling input
+   * @return uint8_t ID of a screen to open, NAV_BACK to go back, or NO_INPUT
+   */
+  virtual uint8_t HandleInput(uint8_t input) = 0;
+
+  /**
+   * @brief Called when the screen becomes the current screen
+   * @note Override to allocate resources only needed while visible
+   */
+  virtual void OnEnter() {}
+
+  /**
+   * @brief Called when another screen replaces or covers this one
+   * @note Override to release what OnEnter allocated
+   */
+  virtual void OnExit() {}
+
+  /**
+   * @brief How often the screen wants to be redrawn without any input
+   * @return Interval in milliseconds, 0 to only redraw on the usual tick
    */
-  virtual uint8_t HandleInput(uint8_t input);
+  virtual uint16_t GetRefreshInterval() const { return 0; }
 
   /**
    * @brief Getter for screen ID
@@ -50,8 +77,8 @@ public:
    * @param Icon Pointer to bitmap array for the icon
    * @param id Unique identifier for the menu item
    */
-  MenuItem(const char *Title, const char *Description,
-           const unsigned char *Icon, const uint8_t id)
+  constexpr MenuItem(const char *Title, const char *Description,
+                     const unsigned char *Icon, const uint8_t id)
       : title(Title ? Title : ""), description(Description ? Description : ""),
         icon(Icon), id(id) {}
 
@@ -86,74 +113,191 @@ private:
   uint8_t id;                // Unique identifier for the menu item
 };
 
+/**
+ * @brief Constructs a screen in the memory it is given
+ * @param memory At least the size registered with the constructor, 8-byte
+ * aligned
+ */
+typedef Screen *(*ScreenConstructor)(void *memory);
+
+/**
+ * @brief Stack allocator shared by all lazily built screens
+ * @details Allocations are released in reverse order, which is exactly how
+ * screens leave the navigation stack, so there is no fragmentation and no
+ * heap use.
+ */
+class ScreenArena {
+public:
+  /**
+   * @brief Reserve `size` bytes on top of the arena
+   * @return Pointer to the block or nullptr if the arena is full
+   */
+  void *Allocate(size_t size) {
+    size = (size + 7) & ~(size_t)7;
+    if (used + size > SCREEN_ARENA_SIZE) {
+      return nullptr;
+    }
+    void *block = buffer + used;
+    used += size;
+    return block;
+  }
+
+  /**
+   * @brief Current top of the arena, to be passed back to Release
+   */
+  uint16_t Mark() const { return used; }
+
+  /**
+   * @brief Free everything allocated since `mark` was taken
+   */
+  void Release(uint16_t mark) { used = mark; }
+
+  /**
+   * @brief Bytes currently in use
+   */
+  uint16_t GetUsed() const { return used; }
+
+private:
+  alignas(8) uint8_t buffer[SCREEN_ARENA_SIZE];
+  uint16_t used = 0;
+};
+
 /**
  * @brief Class to manage current screen state and navigation
+ * @details Screens are looked up in a table indexed directly by their ID, and
+ * navigation keeps a fixed-depth stack so screens can simply return NAV_BACK
+ * instead of hard-coding where they came from.
+ *
+ * A screen is either resident (a long-lived object passed to RegisterScreen)
+ * or lazy (a constructor passed to RegisterFactory). Lazy screens are built in
+ * the shared ScreenArena when opened and destroyed when popped, so RAM follows
+ * the screens currently on the stack rather than every feature in the menu.
+ * Nothing here touches the heap.
  */
 class NavInfo {
 public:
   /**
-   * @brief Constructor: Initialize current screen and screen list
+   * @brief Constructor: Initialize current screen and screen table
    * @param initialId The ID of the initial screen
    */
   NavInfo(uint8_t initialId)
-      : current_screen_id(initialId), current_screen(nullptr), num_screens(0) {
-    // Initialize all screen pointers to nullptr
+      : current_screen_id(initialId), current_screen(nullptr), depth(0) {
     for (int i = 0; i < MAX_SCREENS; i++) {
-      screens[i].screen = nullptr;
+      screens[i] = {nullptr, nullptr, 0};
     }
   }
 
   /**
-   * @brief Register a screen with its ID
+   * @brief Register a resident screen under its ID
    * @param screen Pointer to the Screen object to register
+   * @note IDs must be below MAX_SCREENS, others are ignored
    */
   void RegisterScreen(Screen *screen) {
-    if (num_screens < MAX_SCREENS) {
-      screens[num_screens].id = screen->getId();
-      screens[num_screens].screen = screen;
-      num_screens++;
+    if (screen->getId() < MAX_SCREENS) {
+      screens[screen->getId()] = {screen, nullptr, 0};
     }
-    // If full, do nothing (or add error handling if needed)
   }
 
   /**
-   * @brief Get a screen by its ID
-   * @param id The ID of the screen to retrieve
-   * @return Screen* Pointer to the registered screen or nullptr if not found
+   * @brief Register a screen that is only built while it is open
+   * @param id The screen ID
+   * @param size sizeof the screen class
+   * @param create Placement-constructs the screen in the memory it is given
    */
-  Screen *GetScreenById(uint8_t id) const {
-    for (int i = 0; i < num_screens; i++) {
-      if (screens[i].id == id) {
-        return screens[i].screen;
-      }
+  void RegisterFactory(uint8_t id, size_t size, ScreenConstructor create) {
+    if (id < MAX_SCREENS) {
+      screens[id] = {nullptr, create, (uint16_t)size};
     }
-    return nullptr; // Return nullptr if not found
   }
 
   /**
-   * @brief Set the current screen using its ID
-   * @param id The ID of the screen to set as current
+   * @brief Check whether anything is registered under `id`
+   */
+  bool IsRegistered(uint8_t id) const {
+    return id < MAX_SCREENS && (screens[id].screen || screens[id].create);
+  }
+
+  /**
+   * @brief Open the screen registered under `id` on top of the current one
+   * @param id The ID of the screen to open
+   * @return false if the screen is unknown, the stack is full or the arena
+   * has no room for it
    */
-  void SetScreenById(uint8_t id) {
-      Serial.println("Setting screen");
-      current_screen = GetScreenById(id);
-      current_screen_id = id;
+  bool PushScreen(uint8_t id) {
+    if (!IsRegistered(id) || depth >= NAV_STACK_DEPTH) {
+      return false;
+    }
+    Leave();
+    if (!Open(id)) {
+      Enter(); // Stay where we were
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Return to the previous screen
+   * @return false if already at the root screen
+   */
+  bool PopScreen() {
+    if (depth <= 1) {
+      return false;
+    }
+    Leave();
+    Discard();
+    depth--;
+    Enter();
+    return true;
+  }
+
+  /**
+   * @brief Return to the root (first) screen
+   */
+  void PopToRoot() {
+    if (depth <= 1) {
+      return;
+    }
+    Leave();
+    while (depth > 1) {
+      Discard();
+      depth--;
+    }
+    Enter();
+  }
+
+  /**
+   * @brief Act on a HandleInput result: NAV_BACK pops, a screen ID pushes
+   * @param result Value returned from Screen::HandleInput
+   */
+  void Navigate(uint8_t result) {
+    if (result == NAV_BACK) {
+      PopScreen();
+    } else if (result != NO_INPUT) {
+      PushScreen(result);
+    }
   }
 
   /**
    * @brief Test function for debugging purposes
    */
   void test() {
-    Serial.println("Test called");
+    LOG_DEBUG("Test called");
   }
 
   /**
-   * @brief Set the current screen using a pointer
-   * @param screen Pointer to the Screen object
+   * @brief Make `screen` the root of the navigation stack
+   * @param screen Pointer to the Screen object (registered if needed)
    */
   void SetCurrentScreen(Screen *screen) {
-    current_screen = screen;
-    current_screen_id = screen->getId();
+    RegisterScreen(screen);
+    if (depth > 0) {
+      Leave();
+    }
+    while (depth > 0) {
+      Discard();
+      depth--;
+    }
+    Open(screen->getId());
   }
   /**
    * @brief Get the current screen
@@ -165,19 +309,84 @@ public:
    * @return uint8_t The ID of the current screen
    */
   uint8_t GetCurrentScreenId() const { return current_screen_id; }
+  /**
+   * @brief Get the number of screens on the navigation stack
+   */
+  uint8_t GetDepth() const { return depth; }
+  /**
+   * @brief Get the bytes of screen arena in use
+   */
+  uint16_t GetArenaUsed() const { return arena.GetUsed(); }
 
 private:
-  uint8_t current_screen_id; // Current screen ID (1 byte)
-  Screen *current_screen;    // Current screen pointer (2 bytes)
-  int num_screens;           // Number of registered screens (2 bytes)
-
   /**
-   * @brief Struct to store screen ID and pointer
+   * @brief Struct to store how a screen ID is provided
    */
   struct ScreenEntry {
-    uint8_t id;           // 1 byte
-    Screen *screen;       // 2 bytes
-  } screens[MAX_SCREENS]; // Array of MAX_SCREENS entries
+    Screen *screen;           // Resident screen, or nullptr
+    ScreenConstructor create; // Builds a lazy screen in the arena
+    uint16_t size;            // Bytes the lazy screen needs
+  };
+
+  /**
+   * @brief Struct to store one open screen
+   */
+  struct StackEntry {
+    Screen *screen; // Live screen instance
+    uint16_t mark;  // Arena top before it was built (lazy screens only)
+    uint8_t id;     // Screen ID
+    bool owned;     // True if built in the arena
+  };
+
+  // Push `id`, building it in the arena if needed, and enter it
+  bool Open(uint8_t id) {
+    StackEntry &top = stack[depth];
+    top.id = id;
+    top.mark = arena.Mark();
+    top.owned = screens[id].screen == nullptr;
+    top.screen = screens[id].screen;
+    if (top.owned) {
+      void *memory = arena.Allocate(screens[id].size);
+      if (memory == nullptr) {
+        return false;
+      }
+      top.screen = screens[id].create(memory);
+    }
+    depth++;
+    Enter();
+    return true;
+  }
+
+  // Destroy the top screen if it lives in the arena
+  void Discard() {
+    StackEntry &top = stack[depth - 1];
+    if (top.owned) {
+      top.screen->~Screen();
+      arena.Release(top.mark);
+    }
+  }
+
+  // Run the exit hook of the screen being left
+  void Leave() {
+    if (current_screen) {
+      current_screen->OnExit();
+    }
+    current_screen = nullptr;
+  }
+
+  // Activate the screen on top of the stack and run its enter hook
+  void Enter() {
+    current_screen_id = stack[depth - 1].id;
+    current_screen = stack[depth - 1].screen;
+    current_screen->OnEnter();
+  }
+
+  uint8_t current_screen_id;         // Current screen ID (1 byte)
+  Screen *current_screen;            // Current screen pointer
+  ScreenEntry screens[MAX_SCREENS];  // How each screen ID is provided
+  StackEntry stack[NAV_STACK_DEPTH]; // Open screens, root first
+  uint8_t depth;                     // Number of entries on the stack
+  ScreenArena arena;                 // Memory for lazily built screens
 };
 
 // class NavInfo {
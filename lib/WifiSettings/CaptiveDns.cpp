@@ -0,0 +1,96 @@
+#include "CaptiveDns.h"
+#include <string.h>
+
+#define DNS_HEADER_SIZE 12
+#define DNS_FLAG_QR 0x80 // In the first flags byte
+#define DNS_FLAG_AA 0x04
+#define DNS_FLAG_RD 0x01
+#define DNS_OPCODE_MASK 0x78
+#define DNS_RCODE_FORMERR 1
+#define DNS_RCODE_NOTIMP 4
+#define DNS_TYPE_A 1
+#define DNS_TYPE_ANY 255
+#define DNS_CLASS_IN 1
+
+/**
+ * @brief Header-only reply carrying an error code
+ */
+static size_t ErrorResponse(const uint8_t *query, uint8_t rcode,
+                            uint8_t *response) {
+  memcpy(response, query, 2); // Id
+  response[2] =
+      DNS_FLAG_QR | (query[2] & (DNS_OPCODE_MASK | DNS_FLAG_RD));
+  response[3] = rcode;
+  memset(response + 4, 0, DNS_HEADER_SIZE - 4);
+  return DNS_HEADER_SIZE;
+}
+
+bool CaptiveDns::Begin(const IPAddress &address, uint16_t port) {
+  const uint8_t record[sizeof(answer)] = {
+      0xC0, DNS_HEADER_SIZE, // The question's name, right after the header
+      0, DNS_TYPE_A,
+      0, DNS_CLASS_IN,
+      (CAPTIVE_DNS_TTL >> 24) & 0xFF, (CAPTIVE_DNS_TTL >> 16) & 0xFF,
+      (CAPTIVE_DNS_TTL >> 8) & 0xFF, CAPTIVE_DNS_TTL & 0xFF,
+      0, 4,
+      address[0], address[1], address[2], address[3]};
+  memcpy(answer, record, sizeof(answer));
+
+  End();
+  udp.onPacket([this](AsyncUDPPacket &packet) {
+    uint8_t response[CAPTIVE_DNS_MAX_PACKET];
+    size_t length = BuildResponse(packet.data(), packet.length(), response);
+    if (length) {
+      packet.write(response, length);
+      answered++;
+    } else {
+      ignored++;
+    }
+  });
+  return udp.listen(port);
+}
+
+void CaptiveDns::End() { udp.close(); }
+
+size_t CaptiveDns::BuildResponse(const uint8_t *query, size_t length,
+                                 uint8_t *response) const {
+  if (length < DNS_HEADER_SIZE || (query[2] & DNS_FLAG_QR)) {
+    return 0; // Not a query
+  }
+  if (query[2] & DNS_OPCODE_MASK) {
+    return ErrorResponse(query, DNS_RCODE_NOTIMP, response);
+  }
+  if (query[4] != 0 || query[5] != 1) {
+    return ErrorResponse(query, DNS_RCODE_FORMERR, response);
+  }
+
+  // Walk the question's name; queries never use compression there
+  size_t end = DNS_HEADER_SIZE;
+  while (end < length && query[end]) {
+    if (query[end] & 0xC0) {
+      return ErrorResponse(query, DNS_RCODE_FORMERR, response);
+    }
+    end += query[end] + 1;
+  }
+  end += 5; // Terminating zero, type and class
+  if (end > length || end + sizeof(answer) > CAPTIVE_DNS_MAX_PACKET) {
+    return ErrorResponse(query, DNS_RCODE_FORMERR, response);
+  }
+  uint16_t type = query[end - 4] << 8 | query[end - 3];
+  uint16_t qclass = query[end - 2] << 8 | query[end - 1];
+  bool answerable =
+      (type == DNS_TYPE_A || type == DNS_TYPE_ANY) && qclass == DNS_CLASS_IN;
+
+  // Header and question as they came, minus any EDNS record after them
+  memcpy(response, query, end);
+  response[2] = DNS_FLAG_QR | DNS_FLAG_AA | (query[2] & DNS_FLAG_RD);
+  response[3] = 0;
+  response[6] = 0;
+  response[7] = answerable;
+  memset(response + 8, 0, 4);
+  if (!answerable) {
+    return end;
+  }
+  memcpy(response + end, answer, sizeof(answer));
+  return end + sizeof(answer);
+}
@@ -0,0 +1,53 @@
+#ifndef CAPTIVEDNS_H
+#define CAPTIVEDNS_H
+
+#include <AsyncUDP.h>
+#include <IPAddress.h>
+
+/**
+ * @brief Captive portal DNS: every A query gets the portal's address
+ * @details Packets are answered from AsyncUDP's callback, in its own task,
+ * so DNS latency no longer depends on the UI loop or on any polling. The
+ * answer record is precomputed in Begin(); a reply is the query's header
+ * and question with the flags and counts patched, plus that record.
+ * Queries for other record types get an empty answer, so clients do not
+ * wait for them to time out. Answers carry a short TTL: clients that
+ * leave the access point stop using the portal's address soon after.
+ */
+#define CAPTIVE_DNS_PORT 53
+#define CAPTIVE_DNS_TTL 10         // Seconds
+#define CAPTIVE_DNS_MAX_PACKET 512 // Plain UDP DNS limit
+
+class CaptiveDns {
+public:
+  /**
+   * @brief Answer on `port` with `address`
+   * @return false if the port could not be opened
+   */
+  bool Begin(const IPAddress &address, uint16_t port = CAPTIVE_DNS_PORT);
+
+  /**
+   * @brief Stop answering
+   */
+  void End();
+
+  /**
+   * @brief Build the reply to one query
+   * @param response At least CAPTIVE_DNS_MAX_PACKET bytes
+   * @return Length of the reply, 0 if the packet is to be ignored
+   */
+  size_t BuildResponse(const uint8_t *query, size_t length,
+                       uint8_t *response) const;
+
+  uint32_t GetAnswered() const { return answered; }
+  uint32_t GetIgnored() const { return ignored; }
+
+private:
+  AsyncUDP udp;
+  // Name pointer to the question, type A, class IN, TTL, length, address
+  uint8_t answer[16];
+  uint32_t answered = 0; // Only written by the AsyncUDP task
+  uint32_t ignored = 0;
+};
+
+#endif // CAPTIVEDNS_H
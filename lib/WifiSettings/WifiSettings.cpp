@@ -1,11 +1,10 @@
 #include "WifiSettings.h"
+#include <Logger.h>
 
 bool StartWiFi(const bool initialMode, const char *ssid, const char *password,
                const IPAddress &localIP, const IPAddress &gatewayIP) {
-  Serial.println("Bingus");
   wifi_mode_t mode = (initialMode == 0) ? WIFI_AP : WIFI_STA;
-  String modeStr = (initialMode == 0) ? "WIFI_AP" : "WIFI_STA";
-  Serial.println("The mode string is: " + modeStr);
+  LOG_INFO("Starting WiFi as %s", (initialMode == 0) ? "WIFI_AP" : "WIFI_STA");
   WiFi.mode(mode);
 
   // If ssid is blank, fallback to Configuration
@@ -43,12 +42,15 @@ bool StartWiFi(const bool initialMode, const char *ssid, const char *password,
 
   return false;
 }
-void SetupCaptivePortal(DNSServer &dnsServer, const IPAddress &localIP) {
-  dnsServer.setTTL(3600);
-  dnsServer.start(53, "*", localIP);
+void SetupCaptivePortal(CaptiveDns &dnsServer, const IPAddress &localIP) {
+  if (!dnsServer.Begin(localIP)) {
+    LOG_WARN("Captive portal DNS failed to start");
+  }
 }
 
-void SetupDNS(DNSServer &dnsServer, const IPAddress &localIP) {
-  dnsServer.setTTL(3600);
-  dnsServer.start(53, "*", WiFi.softAPIP());
+bool IsWiFiUp(bool apMode) {
+  if (apMode) {
+    return (WiFi.getMode() & WIFI_AP) && (uint32_t)WiFi.softAPIP() != 0;
+  }
+  return WiFi.status() == WL_CONNECTED;
 }
@@ -2,15 +2,19 @@
 #define WIFISETTINGS
 
 #include <WiFi.h>
-#include <DNSServer.h>
+#include <CaptiveDns.h>
 
 bool StartWiFi(const bool initialMode, const char *ssid, const char *password,
                const IPAddress &localIP = IPAddress(1, 2, 3, 4), 
                const IPAddress &gatewayIP = IPAddress(1, 2, 3, 4));
 
-void SetupDNS(DNSServer &dnsServer, const IPAddress &localIP);
+void SetupCaptivePortal(CaptiveDns &dnsServer, const IPAddress &localIP);
 
-void SetupCaptivePortal(DNSServer &dnsServer, const IPAddress &localIP);
+/**
+ * @brief Whether the link StartWiFi() brought up is still there
+ * @param apMode Check the access point rather than the station connection
+ */
+bool IsWiFiUp(bool apMode);
 
 
 #endif // WIFISETTINGS 
@@ -408,6 +408,26 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
       padding: 0 4px;
     }
 
+    .condition-timing {
+      grid-column: 1 / -1;
+      display: flex;
+    }
+
+    .calibration-point {
+      display: flex;
+      gap: 6px;
+    }
+
+    .calibration-point button,
+    .calibration-point span {
+      width: auto;
+    }
+
+    .condition-group {
+      grid-template-columns: 1fr 1fr auto auto;
+      border-left: 2px solid var(--gray);
+    }
+
     .arrow-container {
       display: flex;
       flex-direction: column;
@@ -632,14 +652,40 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
     let sensorList = [];
     let relayList = [];
 
+    // Condition types that group other conditions (top level is an AND)
+    const GROUP_TYPES = ['and', 'or', 'not'];
+
+    // I/O hardware fitted to the board, replaced by the list from readADC
+    let ioBackends = [{id: 0, name: 'ESP32'}];
+
+    // Matches CALIBRATION_MAX_POINTS / CALIBRATION_MAX_DEGREE in Calibration.h
+    const CALIBRATION_MAX_POINTS = 8;
+    const HEALTH_DEFAULT_STALE = 30;
+    const CALIBRATION_COEFFICIENTS = 4;
+
     // ===== CLASS DEFINITIONS =====
     class Sensor {
-      constructor(id, name, pin, value, folded = true) {
+      constructor(id, name, pin, value, folded = true, io = 0) {
         this.id = id;
         this.name = name;
         this.pin = pin;
         this.value = value;
         this.folded = folded;
+        this.io = io;
+        // Reported by the backend, e.g. "V" or "°C"
+        this.unit = '';
+        this.raw = value;
+        // Raw reading -> value: 'none', 'linear' or 'table' use [raw, value]
+        // points, 'poly' uses coefficients, lowest power first
+        this.cal = {type: 'none', points: [], coef: []};
+        // Median window, EMA alpha and Kalman q/r; 0 turns a stage off
+        this.filter = {median: 0, ema: 0, q: 0, r: 0};
+        // Fault checks: plausible range (min >= max = off), max change per
+        // second, seconds without movement / without samples (0 = off), and
+        // readings pinned at the backend's rail
+        this.health = {min: 0, max: 0, rate: 0, stuck: 0, stale: HEALTH_DEFAULT_STALE, clip: false};
+        // 'ok', 'stale', 'clipped', 'range', 'rate' or 'stuck'
+        this.fault = 'ok';
       }
 
       setValue(value) {
@@ -648,23 +694,46 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
     }
 
     class Condition {
-      constructor(sensor, operator, value, id, type) {
+      constructor(sensor, operator, value, id, type, hysteresis = 0, hold = 0, parent = 0) {
         this.sensor = sensor;
         this.operator = operator;
         this.value = value;
         this.id = id;
         this.type = type;
+        this.hysteresis = hysteresis;
+        this.hold = hold;
+        this.parent = parent;
+        // Schedule conditions, in seconds: on for `duration` from `start`,
+        // repeating every `period` (defaults to 06:00-22:00 daily)
+        this.period = 86400;
+        this.start = 6 * 3600;
+        this.duration = 16 * 3600;
+      }
+
+      isGroup() {
+        return GROUP_TYPES.includes(this.type);
       }
     }
 
     class Relay {
-      constructor(id, name, pin, conditions = [], status = false, folded = true) {
+      constructor(id, name, pin, conditions = [], status = false, folded = true, minOn = 0, minOff = 0, io = 0) {
         this.id = id;
         this.name = name;
         this.pin = pin;
+        this.io = io;
         this.conditions = conditions;
         this.status = status;
         this.folded = folded;
+        this.minOn = minOn;
+        this.minOff = minOff;
+        // State while a sensor it reads is faulted: 'off', 'on' or 'hold'
+        this.failSafe = 'off';
+        this.inFailSafe = false;
+        // 'switch' follows the conditions; 'pwm' (hardware PWM) and 'slow'
+        // (on-time per `period` seconds) are driven by a PID loop
+        this.output = 'switch';
+        this.pid = {sensorId: 0, setpoint: 0, kp: 0, ki: 0, kd: 0, reverse: false, freq: 1000, period: 10};
+        this.duty = 0;
       }
 
       toggleStatus() {
@@ -696,6 +765,38 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
       _swapConditions(index1, index2) {
         [this.conditions[index1], this.conditions[index2]] = [this.conditions[index2], this.conditions[index1]];
       }
+
+      getGroup(id) {
+        return this.conditions.find(c => c.id === id && c.isGroup());
+      }
+
+      // Parent id as the device sees it: unknown groups count as top level
+      parentOf(condition) {
+        return condition.parent !== condition.id && this.getGroup(condition.parent) ? condition.parent : 0;
+      }
+
+      // Conditions in tree order, each with its nesting depth
+      flatten(parentId = 0, depth = 0, seen = new Set()) {
+        return this.conditions
+          .filter(c => this.parentOf(c) === parentId && !seen.has(c.id))
+          .flatMap(c => {
+            seen.add(c.id);
+            const children = c.isGroup() ? this.flatten(c.id, depth + 1, seen) : [];
+            return [{condition: c, depth}, ...children];
+          });
+      }
+
+      isInside(condition, groupId) {
+        for (let id = this.parentOf(condition), steps = 0; id !== 0 && steps < this.conditions.length; steps++) {
+          if (id === groupId) return true;
+          id = this.parentOf(this.getGroup(id));
+        }
+        return false;
+      }
+
+      nextConditionId() {
+        return this.conditions.reduce((max, c) => Math.max(max, c.id), 0) + 1;
+      }
     }
 
     // ===== UTILITY FUNCTIONS =====
@@ -730,7 +831,7 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
       const relay = getRelay(conditionReceiver);
       if (!relay) return;
 
-      const condition = new Condition(1, ">", 1, relay.conditions.length + 1, dropdown.value);
+      const condition = new Condition(1, ">", 1, relay.nextConditionId(), dropdown.value);
       condition.sensorId = 1; // Compatibility
       relay.conditions.push(condition);
       renderConditions(relay.id);
@@ -744,18 +845,46 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
           id: sensor.id,
           name: sensor.name,
           pin: sensor.pin,
+          io: sensor.io,
+          ...(sensor.cal.type !== 'none' && {
+            cal: sensor.cal.type === 'poly'
+              ? {type: 'poly', coef: sensor.cal.coef}
+              : {type: sensor.cal.type, points: [...sensor.cal.points].sort((a, b) => a[0] - b[0])}
+          }),
+          ...((sensor.filter.median > 1 || sensor.filter.ema > 0 || sensor.filter.r > 0) && {
+            filter: sensor.filter
+          }),
+          ...((sensor.health.min < sensor.health.max || sensor.health.rate > 0 || sensor.health.stuck > 0 ||
+               sensor.health.stale !== HEALTH_DEFAULT_STALE || sensor.health.clip) && {
+            health: sensor.health
+          })
         })),
         relays: relayList.map(relay => ({
           id: relay.id,
           name: relay.name,
           pin: relay.pin,
+          io: relay.io,
+          minOn: relay.minOn,
+          minOff: relay.minOff,
+          failSafe: relay.failSafe,
+          ...(relay.output !== 'switch' && {
+            pid: {...relay.pid, output: relay.output}
+          }),
           conditions: relay.conditions.map(condition => ({
             id: condition.id,
             sensor: condition.sensor,
             sensorId: condition.sensorId,
             operator: condition.operator,
             value: condition.value,
-            type: condition.type
+            type: condition.type,
+            hysteresis: condition.hysteresis,
+            hold: condition.hold,
+            parent: condition.parent,
+            ...(condition.type === 'schedule' && {
+              period: condition.period,
+              start: condition.start,
+              duration: condition.duration
+            })
           }))
         }))
       };
@@ -769,6 +898,10 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
           throw new Error('Invalid JSON structure: missing sensors or relays arrays');
         }
 
+        if (Array.isArray(data.backends) && data.backends.length > 0) {
+          ioBackends = data.backends;
+        }
+
         // Clear existing data
         sensorList.length = 0;
         relayList.length = 0;
@@ -780,7 +913,37 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
             sensorData.name || 'Unnamed Sensor',
             sensorData.pin || 1,
             sensorData.value || 0,
+            true,
+            sensorData.io || 0,
           );
+          sensor.unit = sensorData.unit || '';
+          sensor.raw = sensorData.raw ?? sensor.value;
+          if (sensorData.cal) {
+            sensor.cal = {
+              type: sensorData.cal.type || 'none',
+              points: sensorData.cal.points || [],
+              coef: sensorData.cal.coef || []
+            };
+          }
+          if (sensorData.filter) {
+            sensor.filter = {
+              median: sensorData.filter.median || 0,
+              ema: sensorData.filter.ema || 0,
+              q: sensorData.filter.q || 0,
+              r: sensorData.filter.r || 0
+            };
+          }
+          if (sensorData.health) {
+            sensor.health = {
+              min: sensorData.health.min || 0,
+              max: sensorData.health.max || 0,
+              rate: sensorData.health.rate || 0,
+              stuck: sensorData.health.stuck || 0,
+              stale: sensorData.health.stale ?? HEALTH_DEFAULT_STALE,
+              clip: !!sensorData.health.clip
+            };
+          }
+          sensor.fault = sensorData.fault || 'ok';
           sensorList.push(sensor);
         });
 
@@ -792,7 +955,19 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
             relayData.pin || 1,
             [],
             relayData.status || false,
+            true,
+            relayData.minOn || 0,
+            relayData.minOff || 0,
+            relayData.io || 0,
           );
+          relay.failSafe = relayData.failSafe || 'off';
+          relay.inFailSafe = !!relayData.inFailSafe;
+          if (relayData.pid) {
+            const {output, ...pid} = relayData.pid;
+            relay.output = output === 'slow' ? 'slow' : 'pwm';
+            relay.pid = {...relay.pid, ...pid};
+          }
+          relay.duty = relayData.duty || 0;
 
           // Import conditions for this relay
           if (relayData.conditions && Array.isArray(relayData.conditions)) {
@@ -802,9 +977,17 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
                 conditionData.operator || '>',
                 conditionData.value || 1,
                 conditionData.id || relay.conditions.length + 1,
-                conditionData.type || 'sensor'
+                conditionData.type || 'sensor',
+                conditionData.hysteresis || 0,
+                conditionData.hold || 0,
+                conditionData.parent || 0
               );
               condition.sensorId = conditionData.sensorId || conditionData.sensor || 1;
+              if (condition.type === 'schedule') {
+                condition.period = conditionData.period || 0;
+                condition.start = conditionData.start || 0;
+                condition.duration = conditionData.duration || 0;
+              }
               relay.conditions.push(condition);
             });
           }
@@ -880,42 +1063,49 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
         }
       });
 
-      // Check sensor pins
+      // Check sensor pins (the same channel on different boards is fine)
+      const pinKey = item => `${item.io}:${item.pin}`;
       const sensorPins = {};
       sensorList.forEach(sensor => {
-        if (sensorPins[sensor.pin]) {
+        const key = pinKey(sensor);
+        if (sensorPins[key]) {
           duplicates.pins.push({
             type: 'sensor',
             pin: sensor.pin,
-            ids: [...sensorPins[sensor.pin], sensor.id]
+            io: sensor.io,
+            ids: [...sensorPins[key], sensor.id]
           });
         } else {
-          sensorPins[sensor.pin] = [sensor.id];
+          sensorPins[key] = [sensor.id];
         }
       });
 
       // Check relay pins
       const relayPins = {};
       relayList.forEach(relay => {
-        if (relayPins[relay.pin]) {
+        const key = pinKey(relay);
+        if (relayPins[key]) {
           duplicates.pins.push({
             type: 'relay',
             pin: relay.pin,
-            ids: [...relayPins[relay.pin], relay.id]
+            io: relay.io,
+            ids: [...relayPins[key], relay.id]
           });
         } else {
-          relayPins[relay.pin] = [relay.id];
+          relayPins[key] = [relay.id];
         }
       });
 
       // Check cross-type pin conflicts
-      Object.keys(sensorPins).forEach(pin => {
-        if (relayPins[pin]) {
+      Object.keys(sensorPins).forEach(key => {
+        if (relayPins[key]) {
+          const [io, pin] = key.split(':').map(Number);
           duplicates.pins.push({
             type: 'cross-type',
-            pin: parseInt(pin),
-            sensorIds: sensorPins[pin],
-            relayIds: relayPins[pin]
+            pin: pin,
+            io: io,
+            sensorIds: sensorPins[key],
+            relayIds: relayPins[key]
           });
         }
       });
@@ -947,6 +1137,59 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
       if (relay) relay.pin = parseInt(pinInput.value) || 1;
     };
 
+    const updateRelayIo = (id, io) => {
+      const relay = getRelay(id);
+      if (relay) relay.io = parseInt(io) || 0;
+    };
+
+    const updateRelayDwell = (id, field, value) => {
+      const relay = getRelay(id);
+      if (relay) relay[field] = Math.max(0, parseInt(value) || 0);
+    };
+
+    const updateRelayFailSafe = (id, mode) => {
+      const relay = getRelay(id);
+      if (relay) relay.failSafe = mode;
+    };
+
+    const updateRelayOutput = (id, output) => {
+      const relay = getRelay(id);
+      if (!relay) return;
+      relay.output = output;
+      if (output !== 'switch' && !getSensor(relay.pid.sensorId) && sensorList.length > 0) {
+        relay.pid.sensorId = sensorList[0].id;
+      }
+      renderPid(id);
+    };
+
+    const updateRelayPid = (id, field, value) => {
+      const relay = getRelay(id);
+      if (!relay) return;
+      if (field === 'reverse') {
+        relay.pid.reverse = value;
+      } else if (field === 'sensorId' || field === 'freq' || field === 'period') {
+        relay.pid[field] = Math.max(0, parseInt(value) || 0);
+      } else {
+        relay.pid[field] = parseFloat(value) || 0;
+      }
+    };
+
+    // Setpoint and gains go to the running loop straight away; they are
+    // only saved with the rest of the config
+    const tunePid = async (id) => {
+      const relay = getRelay(id);
+      if (!relay || relay.output === 'switch') return;
+      const formData = new FormData();
+      formData.append('id', id);
+      ['setpoint', 'kp', 'ki', 'kd'].forEach(field => formData.append(field, relay.pid[field]));
+      try {
+        const response = await fetch('/tune-pid', {method: 'POST', body: formData});
+        console.log(await response.text());
+      } catch (error) {
+        console.error("Error tuning PID:", error);
+      }
+    };
+
     const updateSensorName = (id, newName) => {
       const sensor = getSensor(id);
       if (!sensor) return;
@@ -965,6 +1208,79 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
       if (sensor) sensor.pin = parseInt(pin) || 1;
     };
 
+    const updateSensorIo = (id, io) => {
+      const sensor = getSensor(id);
+      if (sensor) sensor.io = parseInt(io) || 0;
+    };
+
+    const updateCalibrationType = (id, type) => {
+      const sensor = getSensor(id);
+      if (!sensor) return;
+
+      const cal = sensor.cal;
+      cal.type = type;
+      // Start from an identity curve so the value doesn't jump
+      if (type === 'linear') cal.points = (cal.points.length >= 2 ? cal.points : [[0, 0], [1, 1]]).slice(0, 2);
+      if (type === 'table' && cal.points.length < 2) cal.points = [[0, 0], [1, 1]];
+      if (type === 'poly' && cal.coef.length === 0) cal.coef = [0, 1, 0, 0];
+      renderCalibration(id);
+    };
+
+    const updateCalibrationPoint = (id, index, field, value) => {
+      const sensor = getSensor(id);
+      if (sensor && sensor.cal.points[index]) {
+        sensor.cal.points[index][field] = parseFloat(value) || 0;
+      }
+    };
+
+    // Two-point calibration: take the live raw reading for a point
+    const captureCalibrationPoint = (id, index) => {
+      const sensor = getSensor(id);
+      if (!sensor || !sensor.cal.points[index]) return;
+
+      sensor.cal.points[index][0] = sensor.raw;
+      renderCalibration(id);
+    };
+
+    const addCalibrationPoint = (id) => {
+      const sensor = getSensor(id);
+      if (!sensor || sensor.cal.points.length >= CALIBRATION_MAX_POINTS) return;
+
+      const last = sensor.cal.points[sensor.cal.points.length - 1] || [0, 0];
+      sensor.cal.points.push([last[0] + 1, last[1]]);
+      renderCalibration(id);
+    };
+
+    const removeCalibrationPoint = (id, index) => {
+      const sensor = getSensor(id);
+      if (!sensor || sensor.cal.points.length <= 2) return;
+
+      sensor.cal.points.splice(index, 1);
+      renderCalibration(id);
+    };
+
+    const updateCalibrationCoefficient = (id, index, value) => {
+      const sensor = getSensor(id);
+      if (sensor) sensor.cal.coef[index] = parseFloat(value) || 0;
+    };
+
+    const updateSensorFilter = (id, field, value) => {
+      const sensor = getSensor(id);
+      if (sensor) sensor.filter[field] = Math.max(0, parseFloat(value) || 0);
+    };
+
+    const updateSensorHealth = (id, field, value) => {
+      const sensor = getSensor(id);
+      if (!sensor) return;
+      if (field === 'clip') {
+        sensor.health.clip = value;
+      } else if (field === 'min' || field === 'max') {
+        sensor.health[field] = parseFloat(value) || 0;
+      } else {
+        sensor.health[field] = Math.max(0, parseFloat(value) || 0);
+      }
+    };
+
     const updateConditionSensor = (relayId, conditionId, sensorId) => {
       const relay = getRelay(relayId);
       if (!relay) return;
@@ -992,6 +1308,52 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
       if (condition) condition.value = parseFloat(value) || 0;
     };
 
+    const updateConditionTiming = (relayId, conditionId, field, value) => {
+      const relay = getRelay(relayId);
+      if (!relay) return;
+
+      const condition = relay.conditions.find(c => c.id === conditionId);
+      if (condition) condition[field] = Math.max(0, parseFloat(value) || 0);
+    };
+
+    const updateConditionType = (relayId, conditionId, type) => {
+      const relay = getRelay(relayId);
+      if (!relay) return;
+
+      const condition = relay.conditions.find(c => c.id === conditionId);
+      if (condition && GROUP_TYPES.includes(type)) condition.type = type;
+    };
+
+    const updateConditionParent = (relayId, conditionId, parent) => {
+      const relay = getRelay(relayId);
+      if (!relay) return;
+
+      const condition = relay.conditions.find(c => c.id === conditionId);
+      if (condition) {
+        condition.parent = parseInt(parent) || 0;
+        renderConditions(relayId);
+      }
+    };
+
+    const updateConditionSchedule = (relayId, conditionId, field, seconds) => {
+      const relay = getRelay(relayId);
+      if (!relay) return;
+
+      const condition = relay.conditions.find(c => c.id === conditionId);
+      if (condition) condition[field] = Math.max(0, Math.round(seconds) || 0);
+    };
+
+    // "HH:MM" <-> seconds since midnight for <input type="time">
+    const timeToSeconds = (text) => {
+      const [hours, minutes] = text.split(':').map(Number);
+      return (hours || 0) * 3600 + (minutes || 0) * 60;
+    };
+
+    const secondsToTime = (seconds) => {
+      const pad = (n) => String(n).padStart(2, '0');
+      return `${pad(Math.floor(seconds / 3600) % 24)}:${pad(Math.floor(seconds / 60) % 60)}`;
+    };
+
     const updateConditionDropdowns = () => {
       const sensorSelects = document.querySelectorAll('.sensor-select');
       sensorSelects.forEach(select => {
@@ -1032,7 +1394,11 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
 
       const index = relay.conditions.findIndex(c => c.id === conditionId);
       if (index !== -1) {
-        relay.conditions.splice(index, 1);
+        const [removed] = relay.conditions.splice(index, 1);
+        // Members of a removed group move up a level
+        relay.conditions
+          .filter(c => c.parent === removed.id)
+          .forEach(c => c.parent = removed.parent);
         renderConditions(relayId);
       }
     };
@@ -1043,19 +1409,31 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
       if (container) container.innerHTML = sensorList.map(createSensorHTML).join('');
     };
 
+    const renderCalibration = (sensorId) => {
+      const sensor = getSensor(sensorId);
+      const container = document.querySelector(`[data-sensor-calibration="${sensorId}"]`);
+      if (sensor && container) container.innerHTML = createCalibrationHTML(sensor);
+    };
+
     const renderRelays = () => {
       const container = document.getElementById('relay-container');
       if (container) container.innerHTML = relayList.map(createRelayHTML).join('');
     };
 
+    const renderPid = (relayId) => {
+      const relay = getRelay(relayId);
+      const container = document.querySelector(`[data-relay-pid="${relayId}"]`);
+      if (relay && container) container.innerHTML = createPidHTML(relay);
+    };
+
     const renderConditions = (relayId) => {
       const relay = getRelay(relayId);
       if (!relay) return;
 
       const container = document.querySelector(`[data-relay-id="${relayId}"]`);
       if (container) {
-        container.innerHTML = relay.conditions
-          .map(condition => createConditionHTML(condition, relayId))
+        container.innerHTML = relay.flatten()
+          .map(({condition, depth}) => createConditionHTML(condition, relayId, depth))
           .join('');
       }
     };
@@ -1090,7 +1468,8 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
           <div data-sensor-initial="${sensor.id}">${sensor.name.charAt(0)}</div>
           <div>
             <span data-sensor-name="${sensor.id}">${sensor.name}</span>:
-            <span data-sensor-value="${sensor.id}">${sensor.value}</span>
+            <span data-sensor-value="${sensor.id}">${sensor.value}</span>${sensor.unit}
+            ${sensor.fault !== 'ok' ? `<span data-sensor-fault="${sensor.id}">⚠️ ${sensor.fault}</span>` : ''}
           </div>
           <button onclick="toggleSensorSettings(${sensor.id})" aria-label="Toggle sensor">⚙️</button>
           <button onclick="removeSensor(${sensor.id})" aria-label="Remove sensor">❌</button>
@@ -1101,20 +1480,136 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
             <input type="text" id="sensor-name" placeholder="Jeff maybe?" value="${sensor.name}" onchange="updateSensorName(${sensor.id}, this.value)">
           </div>
           <div class="input">
-            <label for="sensor-pin">Pin: </label>
+            <label for="sensor-io">I/O: </label>
+            ${createIoSelect('sensor-io', sensor.io, `updateSensorIo(${sensor.id}, this.value)`)}
+          </div>
+          <div class="input">
+            <label for="sensor-pin">Pin / channel: </label>
             <input type="number" id="sensor-pin" placeholder="Devboard pin number" value="${sensor.pin}" onchange="updateSensorPin(${sensor.id}, this.value)">
           </div>
+          <div class="input">
+            <label for="sensor-cal">Calibration (raw ${sensor.raw}): </label>
+            <select id="sensor-cal" onchange="updateCalibrationType(${sensor.id}, this.value)">
+              <option value="none" ${sensor.cal.type === 'none' ? 'selected' : ''}>None</option>
+              <option value="linear" ${sensor.cal.type === 'linear' ? 'selected' : ''}>Two-point</option>
+              <option value="table" ${sensor.cal.type === 'table' ? 'selected' : ''}>Lookup table</option>
+              <option value="poly" ${sensor.cal.type === 'poly' ? 'selected' : ''}>Polynomial</option>
+            </select>
+          </div>
+          <div data-sensor-calibration="${sensor.id}">${createCalibrationHTML(sensor)}</div>
+          <div class="input">
+            <label for="sensor-median">Median of (samples): </label>
+            <input type="number" id="sensor-median" min="0" max="9" step="2" placeholder="0 = off" value="${sensor.filter.median}" onchange="updateSensorFilter(${sensor.id}, 'median', this.value)">
+          </div>
+          <div class="input">
+            <label for="sensor-ema">Smoothing (0-1): </label>
+            <input type="number" id="sensor-ema" min="0" max="1" step="0.05" placeholder="0 = off" value="${sensor.filter.ema}" onchange="updateSensorFilter(${sensor.id}, 'ema', this.value)">
+          </div>
+          <div class="input">
+            <label for="sensor-kalman-r">Kalman noise / drift: </label>
+            <div class="calibration-point">
+              <input type="number" id="sensor-kalman-r" min="0" step="any" placeholder="Noise, 0 = off" value="${sensor.filter.r}" onchange="updateSensorFilter(${sensor.id}, 'r', this.value)">
+              <input type="number" min="0" step="any" aria-label="Drift" placeholder="Drift" value="${sensor.filter.q}" onchange="updateSensorFilter(${sensor.id}, 'q', this.value)">
+            </div>
+          </div>
+          <div class="input">
+            <label for="sensor-health-min">Plausible range: </label>
+            <div class="calibration-point">
+              <input type="number" id="sensor-health-min" step="any" placeholder="Min" value="${sensor.health.min}" onchange="updateSensorHealth(${sensor.id}, 'min', this.value)">
+              <span>→</span>
+              <input type="number" step="any" aria-label="Max" placeholder="Max" value="${sensor.health.max}" onchange="updateSensorHealth(${sensor.id}, 'max', this.value)">
+            </div>
+          </div>
+          <div class="input">
+            <label for="sensor-health-rate">Max change (/s): </label>
+            <input type="number" id="sensor-health-rate" min="0" step="any" placeholder="0 = off" value="${sensor.health.rate}" onchange="updateSensorHealth(${sensor.id}, 'rate', this.value)">
+          </div>
+          <div class="input">
+            <label for="sensor-health-stuck">Stuck after (s): </label>
+            <input type="number" id="sensor-health-stuck" min="0" placeholder="0 = off" value="${sensor.health.stuck}" onchange="updateSensorHealth(${sensor.id}, 'stuck', this.value)">
+          </div>
+          <div class="input">
+            <label for="sensor-health-stale">No data after (s): </label>
+            <input type="number" id="sensor-health-stale" min="0" placeholder="0 = off" value="${sensor.health.stale}" onchange="updateSensorHealth(${sensor.id}, 'stale', this.value)">
+          </div>
+          <div class="input">
+            <label for="sensor-health-clip">Flag readings at the rail: </label>
+            <input type="checkbox" id="sensor-health-clip" ${sensor.health.clip ? 'checked' : ''} onchange="updateSensorHealth(${sensor.id}, 'clip', this.checked)">
+          </div>
         </div>
       </div>
     `;
 
+    const createPidHTML = (relay) => {
+      if (relay.output === 'switch') return '';
+      const pid = relay.pid;
+      const sensorOptions = sensorList
+        .map(sensor => `<option value="${sensor.id}" ${sensor.id === pid.sensorId ? 'selected' : ''}>${sensor.name}</option>`)
+        .join('');
+      const gain = (field, label) => `
+        <div class="input">
+          <label>${label}: </label>
+          <input type="number" step="any" value="${pid[field]}" onchange="updateRelayPid(${relay.id}, '${field}', this.value); tunePid(${relay.id})">
+        </div>
+      `;
+      return `
+        <div class="input">
+          <label for="relay-pid-sensor">Sensor (conditions are ignored): </label>
+          <select id="relay-pid-sensor" onchange="updateRelayPid(${relay.id}, 'sensorId', this.value)">${sensorOptions}</select>
+        </div>
+        ${gain('setpoint', 'Setpoint')}
+        ${gain('kp', 'Kp')}
+        ${gain('ki', 'Ki (/s)')}
+        ${gain('kd', 'Kd (s)')}
+        <div class="input">
+          <label for="relay-pid-reverse">Raise output above setpoint: </label>
+          <input type="checkbox" id="relay-pid-reverse" ${pid.reverse ? 'checked' : ''} onchange="updateRelayPid(${relay.id}, 'reverse', this.checked)">
+        </div>
+        ${relay.output === 'pwm' ? `
+        <div class="input">
+          <label for="relay-pid-freq">PWM frequency (Hz): </label>
+          <input type="number" id="relay-pid-freq" min="1" value="${pid.freq}" onchange="updateRelayPid(${relay.id}, 'freq', this.value)">
+        </div>` : `
+        <div class="input">
+          <label for="relay-pid-period">Cycle (s): </label>
+          <input type="number" id="relay-pid-period" min="1" value="${pid.period}" onchange="updateRelayPid(${relay.id}, 'period', this.value)">
+        </div>`}
+      `;
+    };
+
+    const createCalibrationHTML = (sensor) => {
+      const cal = sensor.cal;
+      if (cal.type === 'poly') {
+        return Array.from({length: CALIBRATION_COEFFICIENTS}, (_, i) => `
+          <div class="input">
+            <label>x^${i}</label>
+            <input type="number" step="any" value="${cal.coef[i] ?? 0}" onchange="updateCalibrationCoefficient(${sensor.id}, ${i}, this.value)">
+          </div>
+        `).join('');
+      }
+      if (cal.type !== 'linear' && cal.type !== 'table') return '';
+
+      const rows = cal.points.map(([raw, value], i) => `
+        <div class="calibration-point">
+          <input type="number" step="any" value="${raw}" aria-label="Raw reading" onchange="updateCalibrationPoint(${sensor.id}, ${i}, 0, this.value)">
+          <span>→</span>
+          <input type="number" step="any" value="${value}" aria-label="Value" onchange="updateCalibrationPoint(${sensor.id}, ${i}, 1, this.value)">
+          <button onclick="captureCalibrationPoint(${sensor.id}, ${i})" aria-label="Use current raw reading">📍</button>
+          ${cal.type === 'table' ? `<button onclick="removeCalibrationPoint(${sensor.id}, ${i})" aria-label="Remove point">❌</button>` : ''}
+        </div>
+      `).join('');
+      const canAdd = cal.type === 'table' && cal.points.length < CALIBRATION_MAX_POINTS;
+      return rows + (canAdd ? `<button onclick="addCalibrationPoint(${sensor.id})">Add point</button>` : '');
+    };
+
     const createRelayHTML = (relay) => `
       <div id="${relay.id}">
         <div class="sensor">
           <div data-relay-initial="${relay.id}">${relay.name.charAt(0)}</div>
           <div>
             <span data-relay-name="${relay.id}">${relay.name}</span>:
-            <span data-relay-status="${relay.id}">${relay.status ? '🟢' : '🟥'}</span>
+            <span data-relay-status="${relay.id}">${relay.output !== 'switch' ? `${Math.round(relay.duty * 100)}%` : relay.status ? '🟢' : '🟥'}</span>
+            ${relay.inFailSafe ? '<span>⚠️ fail-safe</span>' : ''}
           </div>
           <button onclick="toggleRelaySettings(${relay.id})">⚙️</button>
           <button onclick="removeRelay(${relay.id})" aria-label="Remove relay">❌</button>
@@ -1125,20 +1620,123 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
             <input type="text" name="relay-name" id="relay-name" placeholder="*ahem* jeff?" value="${relay.name}" onchange="updateRelayName(${relay.id}, this.value)">
           </div>
           <div class="input">
-            <label for="relay-pin">Pin: </label>
+            <label for="relay-io">I/O: </label>
+            ${createIoSelect('relay-io', relay.io, `updateRelayIo(${relay.id}, this.value)`)}
+          </div>
+          <div class="input">
+            <label for="relay-pin">Pin / channel: </label>
             <input type="number" id="relay-pin" placeholder="Devboard output pin" value="${relay.pin}" onchange="updateRelayPin(${relay.id}, this)">
           </div>
+          <div class="input">
+            <label for="relay-min-on">Min on (s): </label>
+            <input type="number" id="relay-min-on" min="0" placeholder="Shortest on time" value="${relay.minOn}" onchange="updateRelayDwell(${relay.id}, 'minOn', this.value)">
+          </div>
+          <div class="input">
+            <label for="relay-min-off">Min off (s): </label>
+            <input type="number" id="relay-min-off" min="0" placeholder="Shortest off time" value="${relay.minOff}" onchange="updateRelayDwell(${relay.id}, 'minOff', this.value)">
+          </div>
+          <div class="input">
+            <label for="relay-fail-safe">On sensor fault: </label>
+            <select id="relay-fail-safe" onchange="updateRelayFailSafe(${relay.id}, this.value)">
+              <option value="off" ${relay.failSafe === 'off' ? 'selected' : ''}>Switch off</option>
+              <option value="on" ${relay.failSafe === 'on' ? 'selected' : ''}>Switch on</option>
+              <option value="hold" ${relay.failSafe === 'hold' ? 'selected' : ''}>Hold state</option>
+            </select>
+          </div>
+          <div class="input">
+            <label for="relay-output">Control: </label>
+            <select id="relay-output" onchange="updateRelayOutput(${relay.id}, this.value)">
+              <option value="switch" ${relay.output === 'switch' ? 'selected' : ''}>On/off by conditions</option>
+              <option value="pwm" ${relay.output === 'pwm' ? 'selected' : ''}>PID, PWM output</option>
+              <option value="slow" ${relay.output === 'slow' ? 'selected' : ''}>PID, slow PWM (mechanical relay)</option>
+            </select>
+          </div>
+          <div data-relay-pid="${relay.id}">${createPidHTML(relay)}</div>
           <span>Conditions</span>
           <div data-relay-id="${relay.id}"></div>
           <select onchange="addCondition(${relay.id}, this)">
             <option value="0">Add Condition</option>
             <option value="sensor">Sensor Condition</option>
+            <option value="schedule">Schedule</option>
+            <option value="and">All of (AND group)</option>
+            <option value="or">Any of (OR group)</option>
+            <option value="not">None of (NOT group)</option>
+          </select>
+        </div>
+      </div>
+    `;
+
+    const createIoSelect = (id, selected, onchange) => {
+      // Keep a saved backend visible even if the board isn't fitted any more
+      const backends = ioBackends.some(b => b.id === selected)
+        ? ioBackends : [...ioBackends, {id: selected, name: `Missing #${selected}`}];
+      const options = backends
+        .map(b => `<option value="${b.id}" ${b.id === selected ? 'selected' : ''}>${b.name}</option>`)
+        .join('');
+      return `<select id="${id}" onchange="${onchange}">${options}</select>`;
+    };
+
+    const createParentSelect = (condition, relayId) => {
+      const relay = getRelay(relayId);
+      const groupOptions = relay.conditions
+        .filter(c => c.isGroup() && c !== condition && !relay.isInside(c, condition.id))
+        .map(c => `<option value="${c.id}" ${c.id === relay.parentOf(condition) ? 'selected' : ''}>${c.type.toUpperCase()} #${c.id}</option>`)
+        .join('');
+
+      return `
+        <select class="parent-select" onchange="updateConditionParent(${relayId}, ${condition.id}, this.value)">
+          <option value="0">Top level</option>
+          ${groupOptions}
+        </select>
+      `;
+    };
+
+    const createArrowsHTML = (condition, relayId) => `
+      <div class="arrow-container">
+        <button class="move-up" onclick="getRelay(${relayId}).moveCondition(${condition.id}, 'up')">⬆️</button>
+        <button class="move-down" onclick="getRelay(${relayId}).moveCondition(${condition.id}, 'down')">⬇️</button>
+      </div>
+      <button class="remove-condition" onclick="removeCondition(${relayId}, ${condition.id})">❌</button>
+    `;
+
+    const createGroupHTML = (condition, relayId, depth) => `
+      <div class="relay-settings condition-group" data-condition-id="${condition.id}" style="margin-left: ${depth * 16}px">
+        <div class="input">
+          <select class="operator" onchange="updateConditionType(${relayId}, ${condition.id}, this.value)">
+            <option value="and" ${condition.type === 'and' ? 'selected' : ''}>All of #${condition.id}</option>
+            <option value="or" ${condition.type === 'or' ? 'selected' : ''}>Any of #${condition.id}</option>
+            <option value="not" ${condition.type === 'not' ? 'selected' : ''}>None of #${condition.id}</option>
           </select>
         </div>
+        <div class="input">${createParentSelect(condition, relayId)}</div>
+        ${createArrowsHTML(condition, relayId)}
       </div>
     `;
 
-    const createConditionHTML = (condition, relayId) => {
+    const createScheduleHTML = (condition, relayId, depth) => `
+      <div class="relay-settings condition-group" data-condition-id="${condition.id}" style="margin-left: ${depth * 16}px">
+        <div class="input">
+          <label>From</label>
+          <input type="time" value="${secondsToTime(condition.start)}" onchange="updateConditionSchedule(${relayId}, ${condition.id}, 'start', timeToSeconds(this.value))">
+        </div>
+        <div class="input">
+          <label>On for (min)</label>
+          <input type="number" min="1" value="${condition.duration / 60}" onchange="updateConditionSchedule(${relayId}, ${condition.id}, 'duration', this.value * 60)">
+        </div>
+        ${createArrowsHTML(condition, relayId)}
+        <div class="condition-timing">
+          <div class="input">${createParentSelect(condition, relayId)}</div>
+          <div class="input">
+            <label>Every (min)</label>
+            <input type="number" min="1" value="${condition.period / 60}" placeholder="1440 = daily" onchange="updateConditionSchedule(${relayId}, ${condition.id}, 'period', this.value * 60)">
+          </div>
+        </div>
+      </div>
+    `;
+
+    const createConditionHTML = (condition, relayId, depth = 0) => {
+      if (condition.isGroup()) return createGroupHTML(condition, relayId, depth);
+      if (condition.type === 'schedule') return createScheduleHTML(condition, relayId, depth);
       if (condition.type !== 'sensor') return '';
 
       const sensorOptions = sensorList
@@ -1146,7 +1744,7 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
         .join('');
 
       return `
-        <div class="relay-settings" data-condition-id="${condition.id}">
+        <div class="relay-settings" data-condition-id="${condition.id}" style="margin-left: ${depth * 16}px">
           <div class="input">
             <select class="sensor-select" data-condition-sensors="${relayId}" onchange="updateConditionSensor(${relayId}, ${condition.id}, this.value)">
               ${sensorOptions}
@@ -1165,11 +1763,18 @@ const char MAIN_page[] PROGMEM = R"=====(<!DOCTYPE html>
           <div class="input">
             <input type="number" class="condition-value" value="${condition.value}" placeholder="Value" onchange="updateConditionValue(${relayId}, ${condition.id}, this.value)">
           </div>
-          <div class="arrow-container">
-            <button class="move-up" onclick="getRelay(${relayId}).moveCondition(${condition.id}, 'up')">⬆️</button>
-            <button class="move-down" onclick="getRelay(${relayId}).moveCondition(${condition.id}, 'down')">⬇️</button>
+          ${createArrowsHTML(condition, relayId)}
+          <div class="condition-timing">
+            <div class="input">${createParentSelect(condition, relayId)}</div>
+            <div class="input">
+              <label>&plusmn;</label>
+              <input type="number" min="0" step="any" value="${condition.hysteresis}" placeholder="Hysteresis" onchange="updateConditionTiming(${relayId}, ${condition.id}, 'hysteresis', this.value)">
+            </div>
+            <div class="input">
+              <label>Hold (s)</label>
+              <input type="number" min="0" value="${condition.hold}" placeholder="Hold time" onchange="updateConditionTiming(${relayId}, ${condition.id}, 'hold', this.value)">
+            </div>
           </div>
-          <button class="remove-condition" onclick="removeCondition(${relayId}, ${condition.id})">❌</button>
         </div>
       `;
     };
@@ -13,17 +13,27 @@
 #include <SPI.h>               // For SPI communication with display
 #include <U8g2lib.h>           // For OLED display control
 #include <Update.h>            // For OTA (Over-The-Air) updates
+#include <Wire.h>              // I2C bus for expansion boards
 #include <time.h>              // For time-related functions
 
 /**
  * --- Internal Project Headers ---
  */
+#include <BootProfile.h>    // Boot phase timestamps
+#include <CrashLog.h>       // Crash records and reset counters
 #include <DebounceButton.h> // For debouncing button inputs
 #include <Helpers.h>        // Helper functions for the project
+#include <DigitalSensors.h> // Optional temperature / humidity sensors
+#include <I2cExpanders.h>   // Optional I2C ADC / GPIO expander backends
 #include <Icons.h>          // Icon definitions for UI
+#include <Logger.h>         // Deferred serial logging
+#include <MemoryMonitor.h>  // Heap and stack watermarks
+#include <Metrics.h>        // Hot-path timers, /metrics
+#include <RotaryEncoder.h>  // Optional PCNT encoder input
 #include <Screens.h>        // Screen management classes
 #include <Sensors.h>        // Sensor and relay data structs
 #include <ServerLogic.h>
+#include <Supervisor.h>   // Heartbeats and the task watchdog
 #include <UiKit.h>        // UI toolkit for display
 #include <WiFiInfo.h>     // WiFi information class
 #include <WifiSettings.h> // WiFi management functions
@@ -33,20 +43,24 @@
  */
 String current_screen = "Settings"; // Tracks the currently displayed screen
 InternalTime internal_time;         // Manages internal time with user offset
-NavInfo nav_info(0);         // Navigation info object initialized with ID 0
-uint8_t debug_pin_value = 0; // Debug pin value for testing
+NavInfo nav_info(0); // Navigation info object initialized with ID 0
 SensorRelayManager manager;
-
-TimeMenu time_menu(&internal_time, &nav_info, 2); // Time menu screen
-SliderMenu slider_menu(&nav_info, 3);
+Sparkline sparklines[MAX_SENSORS]; // Dashboard history per sensor slot
+MemoryMonitor memory_monitor;      // Heap/stack watermarks, /memory
+CrashLog crash_log;                // Last crash and resets, /crash
+BootProfile boot_profile;          // Boot phase timestamps, /boot
+Supervisor supervisor;             // Task heartbeats, /supervisor
 
 /**
  * --- Menu Configuration ---
  */
-const int kMenuNumItems = 8;        // Total number of menu items
+const int kMenuNumItems = 10;       // Total number of menu items
 const int KMenuMaxTitleLength = 22; // Max length for menu titles/descriptions
 
-MenuItem menuItems[kMenuNumItems] = {
+// Kept const so the table is placed in flash instead of RAM
+const MenuItem menuItems[kMenuNumItems] = {
+    MenuItem("Dashboard", "Live sensors & relays", kPlaceholderIcon, 8),
+    MenuItem("Memory", "Heap & stack usage", kPlaceholderIcon, 9),
     MenuItem("Time", "Current Time", kClockIcon, 2),
     MenuItem("Slider Test", "Test ui slider", kPlaceholderIcon, 3),
     MenuItem("WiFi", "Manage WiFi / HotSpot", kPlaceholderIcon, 2),
@@ -59,9 +73,47 @@ MenuItem menuItems[kMenuNumItems] = {
 /**
  * --- Button Objects for Debouncing ---
  */
-DebounceButton upButton(BUTTON_UP_PIN);
-DebounceButton downButton(BUTTON_DOWN_PIN);
-DebounceButton selectButton(BUTTON_SELECT_PIN);
+DebounceButton upButton(BUTTON_UP_PIN, UP);
+DebounceButton downButton(BUTTON_DOWN_PIN, DOWN);
+DebounceButton selectButton(BUTTON_SELECT_PIN, SELECT, BACK);
+InputManager input_manager; // Turns button interrupts into input events
+#ifdef ENCODER_A_PIN
+PcntEncoder encoder(ENCODER_A_PIN, ENCODER_B_PIN);
+#endif
+
+/**
+ * --- Sensor / Relay I/O Backends ---
+ * Expansion boards and digital sensors are enabled with build flags holding
+ * their I2C address or GPIO, e.g. -DIO_MCP23017_ADDR=0x20 -DIO_DHT22_PIN=27
+ */
+NativeIo native_io;
+#if defined(IO_ADS1115_ADDR) || defined(IO_MCP23017_ADDR) ||                 \
+    defined(IO_PCF8574_ADDR) || defined(IO_SHT3X_ADDR) ||                    \
+    defined(IO_BME280_ADDR)
+#define IO_HAS_I2C
+WireBus i2c_bus(Wire);
+#endif
+#ifdef IO_ADS1115_ADDR
+Ads1115 ads1115(i2c_bus, IO_ADS1115_ADDR);
+#endif
+#ifdef IO_MCP23017_ADDR
+Mcp23017 mcp23017(i2c_bus, IO_MCP23017_ADDR);
+#endif
+#ifdef IO_PCF8574_ADDR
+Pcf8574 pcf8574(i2c_bus, IO_PCF8574_ADDR);
+#endif
+#ifdef IO_DHT22_PIN
+Dht22 dht22(IO_DHT22_PIN);
+#endif
+#ifdef IO_DS18B20_PIN
+Ds18b20 ds18b20(IO_DS18B20_PIN);
+#endif
+#ifdef IO_SHT3X_ADDR
+Sht3x sht3x(i2c_bus, IO_SHT3X_ADDR);
+#endif
+#ifdef IO_BME280_ADDR
+Bme280 bme280(i2c_bus, IO_BME280_ADDR);
+#endif
 
 /**
  * --- Additional Global Variables ---
@@ -70,19 +122,23 @@ int selected_menu_item = 0; // Index of the currently selected menu item
 JsonDocument doc;           // JSON document for processing form data
 bool isAPMode = false;
 
-/**
- * @brief Detects button input and returns the type
- * @return The type of input (UP, DOWN, SELECT, or NO_INPUT)
- */
-uint8_t getInput() {
-  if (upButton.isPressed())
-    return UP;
-  if (downButton.isPressed())
-    return DOWN;
-  if (selectButton.isPressed())
-    return SELECT;
-  return NO_INPUT;
-}
+// WiFi, the web server and the captive portal DNS run in the background, on
+// the core the WiFi stack runs on, so the control loop never waits for them
+#define NETWORK_TASK_STACK 6144
+#define NETWORK_TASK_PRIORITY 1
+#define NETWORK_TASK_CORE 0
+#define NETWORK_CHECK_MS 2000 // WiFi and web server check, then heartbeat
+
+// Supervision: loop() runs both control and UI, so they share an entry and
+// are recovered by a reboot. The network task can be restarted on its own;
+// its timeout covers StartWiFi's 10 s connect attempt and a few failed
+// health checks.
+#define LOOP_TIMEOUT_MS 5000
+#define NETWORK_TIMEOUT_MS 20000
+int8_t loopSubsystem = -1;
+int8_t networkSubsystem = -1;
+bool serverStarted = false; // Only touched by NetworkTask
+std::atomic<bool> networkRestart{false}; // Set by RestartNetwork()
 
 /**
  * --- UI Initialization ---
@@ -90,163 +146,356 @@ uint8_t getInput() {
 char title_buf[] = "title";
 char desc_buf[] = "desc";
 
-BaseUi base_ui(title_buf, desc_buf, &internal_time);
+BaseUi base_ui(title_buf, desc_buf, &internal_time, &memory_monitor);
 
-SettingsList settings_menu(1, 8, menuItems, &nav_info);
+SettingsList settings_menu(1, kMenuNumItems, menuItems, &nav_info);
+
+/**
+ * @brief Bring up WiFi, the captive portal DNS and the web server, and keep
+ * checking them
+ * @details Runs as its own task so that a station connect (up to 10 s) or
+ * the access point start never holds back the control loop. DNS and HTTP
+ * are then answered by the AsyncUDP and AsyncTCP tasks; this one beats for
+ * the network only while the link is up and the web server answers a
+ * request of its own. When the supervisor asks for a restart it tears WiFi
+ * and the DNS responder down itself, at a point where it holds no lock, and
+ * starts them over. The web server keeps listening.
+ */
+static void NetworkTask(void *) {
+  for (;;) {
+    supervisor.Attach(networkSubsystem);
+    supervisor.Beat(networkSubsystem);
+    Preferences wifiPrefs;
+    wifiPrefs.begin("wifi");
+    String ssid = wifiPrefs.getString("wifissid", "");
+    String pass = wifiPrefs.getString("wifipass", "");
+    const bool wifimode = wifiPrefs.getBool("wifimode", 0);
+    wifiPrefs.end();
+
+    // connect/start network and start ap
+    StartWiFi(wifimode, ssid.c_str(), pass.c_str());
+    supervisor.Beat(networkSubsystem);
+    // Station mode falls back to an access point when it cannot connect
+    bool apMode = WiFi.getMode() & WIFI_AP;
+    if (apMode) {
+      SetupCaptivePortal(dnsServer, localIP);
+    }
+    if (!serverStarted) {
+      boot_profile.Mark("wifi");
+      SetupServer(server, WiFi.localIP());
+      server.begin();
+      serverStarted = true;
+      boot_profile.Mark("server");
+    }
+
+    IPAddress ip = WiFi.localIP();
+    LOG_INFO("IP address %u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    isAPMode = apMode;
+
+    while (!networkRestart.exchange(false)) {
+      vTaskDelay(pdMS_TO_TICKS(NETWORK_CHECK_MS));
+      // A lost link or a server that stopped answering goes without a
+      // beat, until the supervisor restarts the network
+      if (IsWiFiUp(apMode) && IsServerAnswering()) {
+        supervisor.Beat(networkSubsystem);
+      }
+    }
+
+    LOG_WARN("Restarting WiFi");
+    dnsServer.End();
+    WiFi.disconnect(true);
+  }
+}
+
+/**
+ * @brief Ask the network task to start over (supervisor task)
+ * @details The task is not deleted from here: it may be holding the WiFi
+ * driver's or NVS's locks. If it is stuck for good it never picks the
+ * request up, stays silent, and the restart limit reboots the device.
+ */
+static bool RestartNetwork(TaskHandle_t, void *) {
+  networkRestart.store(true);
+  return true;
+}
 
 /**
  * @brief Setup function for the Arduino sketch
+ * @details Ordered for time-to-control: the relays are driven from the
+ * saved config before anything slow happens, the network comes up in the
+ * background, and the display and menus last.
  */
 void setup() {
   Serial.begin(115200);
+  Logger::Begin(Serial);
+  supervisor.Begin();
+
+  // Backends have to be attached before the config configures their pins
+  manager.SetBackend(IO_NATIVE, &native_io);
+#ifdef IO_HAS_I2C
+  Wire.begin();
+  Wire.setClock(400000);
+#endif
+#ifdef IO_ADS1115_ADDR
+  if (!ads1115.Begin()) {
+    LOG_WARN("ADS1115 not found");
+  }
+  manager.SetBackend(IO_ADS1115, &ads1115);
+#endif
+#ifdef IO_MCP23017_ADDR
+  if (!mcp23017.Begin()) {
+    LOG_WARN("MCP23017 not found");
+  }
+  manager.SetBackend(IO_MCP23017, &mcp23017);
+#endif
+#ifdef IO_PCF8574_ADDR
+  if (!pcf8574.Begin()) {
+    LOG_WARN("PCF8574 not found");
+  }
+  manager.SetBackend(IO_PCF8574, &pcf8574);
+#endif
+#ifdef IO_DHT22_PIN
+  if (!dht22.Begin()) {
+    LOG_WARN("DHT22 timer unavailable");
+  }
+  manager.SetBackend(IO_DHT22, &dht22);
+#endif
+#ifdef IO_DS18B20_PIN
+  ds18b20.Begin();
+  LOG_INFO("DS18B20 probes: %u", ds18b20.GetNumDevices());
+  manager.SetBackend(IO_DS18B20, &ds18b20);
+#endif
+#ifdef IO_SHT3X_ADDR
+  if (!sht3x.Begin()) {
+    LOG_WARN("SHT3x not found");
+  }
+  manager.SetBackend(IO_SHT3X, &sht3x);
+#endif
+#ifdef IO_BME280_ADDR
+  if (!bme280.Begin()) {
+    LOG_WARN("BME280 not found");
+  }
+  manager.SetBackend(IO_BME280, &bme280);
+#endif
+  boot_profile.Mark("io");
+
+  manager.LoadFromPreferences();
+  // Relays go back to where they were before the reset, dwell timers
+  // included, instead of waiting off for the rules to re-converge
+  manager.RestoreRelayStates(millis());
+  boot_profile.Mark("config");
+
+  // First control pass right away, rather than after the first interval
+  unsigned long now = millis();
+  manager.PollInputs(now);
+  manager.UpdateSchedules(time(nullptr));
+  manager.UpdateRelays(now);
+  manager.UpdateControllers(now);
+  boot_profile.Mark("control");
+
+  // Reading the last core dump and counting the boot can wait until the
+  // relays are driven again
+  crash_log.Begin();
+  boot_profile.Mark("crashlog");
+
+  loopSubsystem = supervisor.Add("loop", LOOP_TIMEOUT_MS);
+  networkSubsystem =
+      supervisor.Add("network", NETWORK_TIMEOUT_MS, RestartNetwork);
+  xTaskCreatePinnedToCore(NetworkTask, "net", NETWORK_TASK_STACK, nullptr,
+                          NETWORK_TASK_PRIORITY, nullptr, NETWORK_TASK_CORE);
 
   u8g2.begin();
   SPI.setClockDivider(CLOCK_SPEED);
-  Serial.println(esp_reset_reason());
   u8g2.setBusClock(CLOCK_SPEED);
-  delay(2000);
-
-  nav_info.RegisterScreen(&settings_menu);
-  nav_info.RegisterScreen(&time_menu);
-  nav_info.RegisterScreen(&slider_menu);
+  boot_profile.Mark("display");
+
+  // Everything but the root menu is built on demand in the screen arena
+  nav_info.RegisterFactory(2, sizeof(TimeMenu), [](void *memory) -> Screen * {
+    return new (memory) TimeMenu(&internal_time, &nav_info, 2);
+  });
+  nav_info.RegisterFactory(3, sizeof(SliderMenu), [](void *memory) -> Screen * {
+    return new (memory) SliderMenu(&nav_info, 3);
+  });
+  nav_info.RegisterFactory(8, sizeof(DashboardScreen),
+                           [](void *memory) -> Screen * {
+                             return new (memory)
+                                 DashboardScreen(8, &manager, sparklines);
+                           });
+  nav_info.RegisterFactory(9, sizeof(MemoryScreen),
+                           [](void *memory) -> Screen * {
+                             return new (memory)
+                                 MemoryScreen(9, &memory_monitor);
+                           });
   nav_info.SetCurrentScreen(&settings_menu);
 
-  // -- Setup WIfi --
-  Preferences wifiPrefs;
-  wifiPrefs.begin("wifi");
-  String ssidString = wifiPrefs.getString("wifissid", "");
-  String passString = wifiPrefs.getString("wifipass", "");
-
-  // Now get the const char* pointer from the String object
-  const char *ssid = ssidString.c_str();
-  const char *pass = passString.c_str();
-  const bool wifimode = wifiPrefs.getBool("wifimode", 0);
-  wifiPrefs.end();
-
-  // connect/start network and start ap
-  isAPMode = StartWiFi(wifimode, ssid, pass);
-  SetupCaptivePortal(dnsServer, localIP);
-  SetupServer(server, WiFi.localIP());
-
-  server.begin();
+  input_manager.AddButton(&upButton);
+  input_manager.AddButton(&downButton);
+  input_manager.AddButton(&selectButton);
+  input_manager.AddChord(&upButton, &downButton, HOME);
+#ifdef ENCODER_A_PIN
+  encoder.Begin();
+  input_manager.AddSource(&encoder);
+#endif
+  input_manager.Begin();
+
+  // Stacks worth watching: loop()'s, the web server's and the logger's
+  memory_monitor.WatchTask("loopTask", xTaskGetCurrentTaskHandle());
+  memory_monitor.WatchTask("async_tcp");
+  memory_monitor.WatchTask("log");
+  memory_monitor.WatchTask("supervisor");
 
-  manager.LoadFromPreferences();
   for (int i = 0; i < manager.GetNumSensors(); i++) {
     Sensor *sensor = manager.sensors[i];
     if (sensor) {
-      Serial.print("  Sensor ID: ");
-      Serial.print(sensor->GetId());
-      Serial.print(", Name: ");
-      Serial.print(sensor->GetName());
-      float value = sensor->GetValue();
-      Serial.print(", Value: ");
-      Serial.println(value);
-      Serial.print(" Pin: ");
-      Serial.println(sensor->GetPin());
-      pinMode(sensor->GetPin(), INPUT);
+      LOG_DEBUG("Sensor %u: io %u pin %u value %.2f", sensor->GetId(),
+                sensor->GetIo(), sensor->GetPin(), manager.GetSensorValue(i));
     }
   }
 
   for (int i = 0; i < manager.GetNumRelays(); i++) {
     Relay *relay = manager.relays[i];
     if (relay) {
-      Serial.println("  Relay ID: ");
-      Serial.print(relay->GetId());
-      Serial.println(" Relay Name: ");
-      Serial.println(relay->GetName());
-      Serial.print(" Pin: ");
-      Serial.println(relay->GetPin());
-      pinMode(relay->GetPin(), OUTPUT);
+      LOG_DEBUG("Relay %u: io %u pin %u", relay->GetId(), relay->GetIo(),
+                relay->GetPin());
     }
   }
-
-  Serial.println(WiFi.localIP());
+  boot_profile.Mark("ui");
+
+  // The relay states are in RTC memory already; the NVS copy also covers a
+  // power loss after the reboot
+  supervisor.Attach(loopSubsystem);
+  supervisor.Beat(loopSubsystem);
+  supervisor.Start(
+      [](const char *) { manager.SaveRelayStates(millis(), true); });
 }
 
 // Defining variables here to keep them by their function (loop)
-uint8_t input;
+InputEvent input_event;
 uint8_t input_result;
 
-/**
- * @brief Main loop function for the Arduino sketch
- */
-
-// Function to check if the button is pressed
-bool buttonPressed() {
-  if (upButton.isPressed() || downButton.isPressed() ||
-      selectButton.isPressed()) {
-    return true;
-  } else {
-    return false;
-  }
-}
-
 unsigned long previousMillis = 0; // Store the last time the display was updated
 const long interval = 5000;       // Interval at which to update (5 seconds)
 
+METRICS_HISTOGRAM(loopMetric, "loop", "One pass of loop()");
+METRICS_HISTOGRAM(renderMetric, "render", "Rendering one OLED frame");
+
 /**
  * Main loop of the system.
  *
  * all the logic for updating the UI, handling inputs,
- * and managing sensor and relay states. It also includes a simple debug pin
- * value update mechanism.
+ * and managing sensor and relay states.
  */
 void loop() {
+  METRICS_TIME(loopMetric);
   static unsigned long lastUpdate = 0;
   const unsigned long updateInterval = 1000; // 1 second
+  static unsigned long lastPoll = 0;
+  // Sensor drivers advance their conversions between control ticks
+  const unsigned long pollInterval = 50;
+  static unsigned long lastControl = 0;
   static bool displayDirty = false; // Flag to track if display needs updating
+  static unsigned long lastDraw = 0;
+  static unsigned long lastMemorySample = 0;
+
+  // Also feeds the task watchdog for loopTask
+  supervisor.Beat(loopSubsystem);
+
+  // Settings posted to the web server take effect here, between two passes
+  // of the control loop
+  if (manager.ApplyQueuedConfig()) {
+    displayDirty = true;
+  }
+  manager.ApplyQueuedPidTuning();
+
+  // Drain every queued input so presses made while rendering aren't lost
+  while (input_manager.Read(input_event)) {
+    displayDirty = true;
+
+    // Long select goes back a screen, up+down returns to the menu
+    if (input_event.input == BACK) {
+      nav_info.PopScreen();
+      continue;
+    }
+    if (input_event.input == HOME) {
+      nav_info.PopToRoot();
+      continue;
+    }
 
-  // Process DNS requests for captive portal if in AP mode
-  if (isAPMode) {
-    dnsServer.processNextRequest();
+    // Handle screen navigation based on user input, fast encoder turns
+    // arrive as one event with several steps
+    for (uint8_t step = 0; step < input_event.steps; step++) {
+      input_result =
+          nav_info.GetCurrentScreen()->HandleInput(input_event.input);
+      if (input_result != NO_INPUT) {
+        nav_info.Navigate(input_result);
+        break;
+      }
+    }
   }
 
-  input = getInput();
+  // Read every sensor from its backend; each call only starts or collects
+  // conversions, so slow digital sensors never stall the loop. Only relays
+  // reading a sensor whose value changed get re-evaluated on the next tick.
+  if (millis() - lastPoll >= pollInterval) {
+    lastPoll = millis();
+    manager.PollInputs(lastPoll);
+  }
 
-  // Check for input or time-based updates
-  if (millis() - lastUpdate >= updateInterval || input != NO_INPUT) {
+  // PID-driven relays run at their own fixed rate, which also sets the
+  // resolution of time-proportioned outputs
+  if (millis() - lastControl >= PID_INTERVAL_MS) {
+    lastControl = millis();
+    manager.UpdateControllers(lastControl);
+  }
+
+  // Check for time-based updates
+  if (millis() - lastUpdate >= updateInterval) {
     lastUpdate = millis();
     displayDirty = true;
 
-    // Handle screen navigation based on user input
-    input_result = nav_info.GetCurrentScreen()->HandleInput(input);
-    if (input_result != NO_INPUT) {
-      nav_info.SetScreenById(input_result);
-    }
     // Tick the internal time
     internal_time.Tick();
 
-    // Update sensor values with debug pin value for testing
-    bool sensorChanged = false;
     for (int i = 0; i < manager.GetNumSensors(); i++) {
       if (manager.sensors[i]) {
-        float oldValue = manager.sensors[i]->GetValue();
-        manager.sensors[i]->SetValue(debug_pin_value);
-        if (oldValue != debug_pin_value) {
-          sensorChanged = true;
+        // Feed the dashboard history, restarting it if the slot was reused
+        Sparkline &sparkline = sparklines[i];
+        if (sparkline.GetOwner() != manager.sensorIds[i]) {
+          sparkline.Reset(manager.sensorIds[i]);
         }
+        sparkline.Push(manager.GetSensorValue(i));
       }
     }
 
-    // Evaluate and update relay states based on conditions
-    bool relayChanged = false;
-    for (int i = 0; i < manager.GetNumRelays(); i++) {
-      if (manager.relays[i]) {
-        Relay &relay = *manager.relays[i];
-        bool shouldBeOn = evaluateRelayConditions(relay, manager);
-        // Serial.println(shouldBeOn);
-        if (shouldBeOn != relay.GetStatus()) {
-          relay.SetStatus(shouldBeOn);
-          // Serial.print("Relay updated: ");
-          // Serial.println(relay.GetStatus());
-          relayChanged = true;
-        }
-      }
-    }
+    // Evaluate and update relay states based on conditions, hysteresis,
+    // hold times and minimum on/off times
+    manager.UpdateSchedules(time(nullptr));
+    manager.UpdateRelays(millis()); // The redraw below shows any switch
+    manager.SaveRelayStates(millis()); // NVS copy, throttled
+  }
+
+  // Heap and stack watermarks; sampling does not allocate
+  if (millis() - lastMemorySample >= MEMORY_SAMPLE_MS) {
+    lastMemorySample = millis();
+    memory_monitor.Sample();
+  }
+
+#if METRICS_ENABLED
+  // 'm' on the serial console prints the timing table
+  if (Serial.available() > 0 && Serial.read() == 'm') {
+    Metrics::Dump(Serial);
+  }
+#endif
+
+  // Screens like the dashboard ask to be redrawn at their own rate
+  uint16_t refresh = nav_info.GetCurrentScreen()->GetRefreshInterval();
+  if (refresh && millis() - lastDraw >= refresh) {
+    displayDirty = true;
   }
 
   // Only render the screen when needed
   if (displayDirty) {
+    lastDraw = millis();
+    METRICS_TIME(renderMetric);
     u8g2.firstPage();
     do {
       nav_info.GetCurrentScreen()->Draw();
@@ -0,0 +1,108 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Host build: the slice of Arduino and FreeRTOS the tested libraries use.
+// Time is simulated: tests set stubMillis, and delays advance it.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef void *TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef void (*TaskFunction_t)(void *);
+#define pdPASS 1
+#define pdFAIL 0
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portTICK_PERIOD_MS 1
+
+inline uint32_t stubMillis = 0; // What millis() returns
+inline int stubTask = 0;        // Stands in for the only task there is
+
+inline unsigned long millis() { return stubMillis; }
+inline TickType_t xTaskGetTickCount() { return stubMillis; }
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return &stubTask; }
+inline void vTaskDelay(TickType_t ticks) { stubMillis += ticks; }
+inline void vTaskDelayUntil(TickType_t *wake, TickType_t ticks) {
+  *wake += ticks;
+  stubMillis = *wake;
+}
+
+// No tasks on the host: anything that starts one runs without it
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char *,
+                                          uint32_t, void *, unsigned,
+                                          TaskHandle_t *handle, BaseType_t) {
+  if (handle) {
+    *handle = nullptr;
+  }
+  return pdFAIL;
+}
+
+// GPIO: pins read back high (idle, pulled up) and writes go nowhere. The
+// drivers built for the host talk to their devices through other seams.
+#define LOW 0
+#define HIGH 1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define OUTPUT_OPEN_DRAIN 0x13
+#define FALLING 0x02
+#define IRAM_ATTR
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return HIGH; }
+inline uint32_t analogReadMilliVolts(uint8_t) { return 0; }
+inline uint32_t ledcSetup(uint8_t, uint32_t frequency, uint8_t) {
+  return frequency;
+}
+inline void ledcAttachPin(uint8_t, uint8_t) {}
+inline void ledcDetachPin(uint8_t) {}
+inline void ledcWrite(uint8_t, uint32_t) {}
+inline void attachInterruptArg(uint8_t, void (*)(void *), void *, int) {}
+inline unsigned long micros() { return stubMillis * 1000; }
+inline void delayMicroseconds(uint32_t) {}
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t written = 0;
+    while (size--) {
+      written += write(*buffer++);
+    }
+    return written;
+  }
+  size_t print(const char *text) {
+    return write((const uint8_t *)text, strlen(text));
+  }
+  size_t println() { return write('\n'); }
+  size_t printf(const char *format, ...) {
+    char text[128];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    return write((const uint8_t *)text,
+                 length < (int)sizeof(text) ? length : sizeof(text) - 1);
+  }
+};
+
+class HostSerial : public Print {
+public:
+  size_t write(uint8_t c) override { return fputc(c, stdout) == c; }
+};
+
+inline HostSerial Serial;
+
+#endif // ARDUINO_H
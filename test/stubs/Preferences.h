@@ -0,0 +1,20 @@
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+#include <stddef.h>
+
+/**
+ * @brief Host build: an NVS namespace that is always empty and drops writes
+ */
+class Preferences {
+public:
+  bool begin(const char *name, bool readOnly = false) { return true; }
+  void end() {}
+  size_t getBytesLength(const char *key) { return 0; }
+  size_t getBytes(const char *key, void *buffer, size_t length) { return 0; }
+  size_t putBytes(const char *key, const void *value, size_t length) {
+    return length;
+  }
+};
+
+#endif // PREFERENCES_H
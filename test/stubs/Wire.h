@@ -0,0 +1,17 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <Arduino.h>
+
+// Host build: a bus with nothing on it; tests use their own I2cBus
+class TwoWire {
+public:
+  void beginTransmission(uint8_t) {}
+  size_t write(uint8_t) { return 1; }
+  size_t write(const uint8_t *, size_t length) { return length; }
+  uint8_t endTransmission(bool = true) { return 2; } // Address NACK
+  size_t requestFrom(uint8_t, size_t) { return 0; }
+  int read() { return -1; }
+};
+
+#endif // WIRE_H
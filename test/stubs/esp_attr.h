@@ -0,0 +1,9 @@
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+// Host build: section attributes only matter on the chip
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+#define IRAM_ATTR
+
+#endif // ESP_ATTR_H
@@ -0,0 +1,22 @@
+#ifndef ESP_SYSTEM_H
+#define ESP_SYSTEM_H
+
+#include <stdlib.h>
+
+typedef enum {
+  ESP_RST_UNKNOWN,
+  ESP_RST_POWERON,
+  ESP_RST_EXT,
+  ESP_RST_SW,
+  ESP_RST_PANIC,
+  ESP_RST_INT_WDT,
+  ESP_RST_TASK_WDT,
+  ESP_RST_WDT,
+} esp_reset_reason_t;
+
+inline esp_reset_reason_t stubResetReason = ESP_RST_POWERON;
+
+inline esp_reset_reason_t esp_reset_reason() { return stubResetReason; }
+inline void esp_restart() { abort(); } // A test that gets here failed
+
+#endif // ESP_SYSTEM_H
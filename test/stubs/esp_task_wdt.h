@@ -0,0 +1,20 @@
+#ifndef ESP_TASK_WDT_H
+#define ESP_TASK_WDT_H
+
+#include <Arduino.h>
+#include <esp_err.h>
+
+inline int stubWdtTasks = 0; // Tasks on the TWDT
+
+inline esp_err_t esp_task_wdt_init(uint32_t, bool) { return ESP_OK; }
+inline esp_err_t esp_task_wdt_add(TaskHandle_t) {
+  stubWdtTasks++;
+  return ESP_OK;
+}
+inline esp_err_t esp_task_wdt_delete(TaskHandle_t) {
+  stubWdtTasks--;
+  return ESP_OK;
+}
+inline esp_err_t esp_task_wdt_reset() { return ESP_OK; }
+
+#endif // ESP_TASK_WDT_H
@@ -0,0 +1,30 @@
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include <Arduino.h>
+#include <esp_err.h>
+
+// Host build: timers are created but never fire
+typedef struct esp_timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *arg);
+#define ESP_TIMER_TASK 0
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void *arg;
+  int dispatch_method; // ESP_TIMER_TASK
+  const char *name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t *,
+                                  esp_timer_handle_t *handle) {
+  *handle = nullptr;
+  return ESP_OK;
+}
+inline esp_err_t esp_timer_start_once(esp_timer_handle_t, uint64_t) {
+  return ESP_OK;
+}
+inline int64_t esp_timer_get_time() { return (int64_t)stubMillis * 1000; }
+
+#endif // ESP_TIMER_H
@@ -0,0 +1,40 @@
+#ifndef KNOB_TRACE_H
+#define KNOB_TRACE_H
+
+#include <RotaryEncoder.h>
+
+/**
+ * @brief Quadrature count of a detented knob, one sample per count change
+ * @details Three gestures, at 4 counts per detent:
+ * - 1.0 s: five slow clockwise clicks, 400 ms apart, each with contact
+ *   chatter on its first edge
+ * - 4.0 s: a clockwise flick of 20 detents at 50 detents/s
+ * - 6.0 s: three slow counter-clockwise clicks, chatter included
+ */
+static const EncoderSample kKnobTrace[] = {
+    {1000, 1}, {1001, 0}, {1002, 1}, {1010, 2}, {1018, 3}, {1026, 4},
+    {1400, 5}, {1401, 4}, {1402, 5}, {1410, 6}, {1418, 7}, {1426, 8},
+    {1800, 9}, {1801, 8}, {1802, 9}, {1810, 10}, {1818, 11}, {1826, 12},
+    {2200, 13}, {2201, 12}, {2202, 13}, {2210, 14}, {2218, 15}, {2226, 16},
+    {2600, 17}, {2601, 16}, {2602, 17}, {2610, 18}, {2618, 19}, {2626, 20},
+    {4000, 21}, {4005, 22}, {4010, 23}, {4015, 24}, {4020, 25}, {4025, 26},
+    {4030, 27}, {4035, 28}, {4040, 29}, {4045, 30}, {4050, 31}, {4055, 32},
+    {4060, 33}, {4065, 34}, {4070, 35}, {4075, 36}, {4080, 37}, {4085, 38},
+    {4090, 39}, {4095, 40}, {4100, 41}, {4105, 42}, {4110, 43}, {4115, 44},
+    {4120, 45}, {4125, 46}, {4130, 47}, {4135, 48}, {4140, 49}, {4145, 50},
+    {4150, 51}, {4155, 52}, {4160, 53}, {4165, 54}, {4170, 55}, {4175, 56},
+    {4180, 57}, {4185, 58}, {4190, 59}, {4195, 60}, {4200, 61}, {4205, 62},
+    {4210, 63}, {4215, 64}, {4220, 65}, {4225, 66}, {4230, 67}, {4235, 68},
+    {4240, 69}, {4245, 70}, {4250, 71}, {4255, 72}, {4260, 73}, {4265, 74},
+    {4270, 75}, {4275, 76}, {4280, 77}, {4285, 78}, {4290, 79}, {4295, 80},
+    {4300, 81}, {4305, 82}, {4310, 83}, {4315, 84}, {4320, 85}, {4325, 86},
+    {4330, 87}, {4335, 88}, {4340, 89}, {4345, 90}, {4350, 91}, {4355, 92},
+    {4360, 93}, {4365, 94}, {4370, 95}, {4375, 96}, {4380, 97}, {4385, 98},
+    {4390, 99}, {4395, 100}, {6000, 99}, {6001, 100}, {6002, 99}, {6010, 98},
+    {6018, 97}, {6026, 96}, {6400, 95}, {6401, 96}, {6402, 95}, {6410, 94},
+    {6418, 93}, {6426, 92}, {6800, 91}, {6801, 92}, {6802, 91}, {6810, 90},
+    {6818, 89}, {6826, 88},
+};
+static const size_t kKnobTraceLength = sizeof(kKnobTrace) / sizeof(kKnobTrace[0]);
+
+#endif // KNOB_TRACE_H
@@ -0,0 +1,75 @@
+#include <RotaryEncoder.h>
+#include <unity.h>
+
+#include "knob_trace.h"
+
+#define POLL_MS 5 // INPUT_POLL_MS, the rate InputManager polls sources at
+
+/**
+ * @brief Events produced by replaying the knob trace between two times
+ */
+struct Replay {
+  InputEvent events[64];
+  uint8_t count = 0;
+
+  Replay(uint32_t fromMs, uint32_t toMs) {
+    TraceEncoder encoder(kKnobTrace, kKnobTraceLength);
+    InputEvent event;
+    for (uint32_t now = 0; now <= 8000; now += POLL_MS) {
+      if (encoder.Poll(now, event) && now >= fromMs && now < toMs &&
+          count < 64) {
+        events[count++] = event;
+      }
+    }
+    TEST_ASSERT_TRUE(encoder.IsDone());
+  }
+};
+
+void setUp() {}
+void tearDown() {}
+
+void test_slow_clicks_step_once() {
+  Replay replay(0, 3000);
+  // Chatter on the first edge must not add or lose a detent
+  TEST_ASSERT_EQUAL_UINT8(5, replay.count);
+  for (uint8_t i = 0; i < replay.count; i++) {
+    TEST_ASSERT_EQUAL_UINT8(UP, replay.events[i].input);
+    TEST_ASSERT_EQUAL_UINT8(1, replay.events[i].steps);
+  }
+}
+
+void test_flick_accelerates() {
+  Replay replay(3000, 5000);
+  TEST_ASSERT_EQUAL_UINT8(20, replay.count);
+  uint32_t steps = 0;
+  for (uint8_t i = 0; i < replay.count; i++) {
+    TEST_ASSERT_EQUAL_UINT8(UP, replay.events[i].input);
+    if (i > 0) {
+      TEST_ASSERT_GREATER_OR_EQUAL_UINT8(replay.events[i - 1].steps,
+                                         replay.events[i].steps);
+    }
+    steps += replay.events[i].steps;
+  }
+  // Starts from rest, then ramps up to the cap at 50 detents/s
+  TEST_ASSERT_EQUAL_UINT8(1, replay.events[0].steps);
+  TEST_ASSERT_EQUAL_UINT8(ENCODER_ACCEL_MAX_STEP,
+                          replay.events[replay.count - 1].steps);
+  TEST_ASSERT_GREATER_THAN_UINT32(3 * replay.count, steps);
+}
+
+void test_pause_forgets_speed() {
+  Replay replay(5000, 8000);
+  TEST_ASSERT_EQUAL_UINT8(3, replay.count);
+  for (uint8_t i = 0; i < replay.count; i++) {
+    TEST_ASSERT_EQUAL_UINT8(DOWN, replay.events[i].input);
+    TEST_ASSERT_EQUAL_UINT8(1, replay.events[i].steps);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_slow_clicks_step_once);
+  RUN_TEST(test_flick_accelerates);
+  RUN_TEST(test_pause_forgets_speed);
+  return UNITY_END();
+}
@@ -0,0 +1,223 @@
+#ifndef NOISY_TRACE_H
+#define NOISY_TRACE_H
+
+#include <stddef.h>
+
+/**
+ * @brief Temperature samples in °C, one per control tick
+ * @details Gaussian noise (sigma 0.15) on a known signal, with single-sample
+ * spikes of about ±3 at least 7 samples apart, about one per hundred:
+ * - samples 0-999: constant 21.5
+ * - samples 1000-1999: ramp from 21.5 up by 0.005 per sample
+ */
+#define NOISY_TRACE_STEP 1000
+#define NOISY_TRACE_LEVEL 21.5f
+#define NOISY_TRACE_SLOPE 0.005f
+#define NOISY_TRACE_SIGMA 0.15f
+
+static const float kNoisyTrace[] = {
+    21.17f, 21.30f, 21.39f, 21.47f, 21.48f, 21.38f, 21.48f, 21.56f, 21.63f, 21.57f,
+    21.29f, 21.43f, 21.21f, 21.35f, 21.50f, 21.50f, 21.41f, 21.67f, 21.50f, 21.57f,
+    21.39f, 21.52f, 21.22f, 21.90f, 21.30f, 21.37f, 21.49f, 21.39f, 21.36f, 21.27f,
+    21.46f, 21.81f, 21.66f, 21.44f, 21.42f, 21.72f, 21.48f, 21.71f, 21.41f, 21.67f,
+    21.48f, 21.42f, 21.39f, 21.56f, 21.49f, 21.64f, 21.70f, 21.69f, 21.55f, 21.79f,
+    21.65f, 21.31f, 21.33f, 21.54f, 21.44f, 21.43f, 21.50f, 21.47f, 21.82f, 21.47f,
+    21.37f, 21.28f, 21.66f, 21.40f, 21.13f, 21.43f, 21.37f, 21.55f, 21.31f, 21.44f,
+    21.45f, 21.45f, 21.54f, 21.63f, 21.53f, 21.39f, 21.66f, 21.56f, 21.49f, 21.54f,
+    21.62f, 21.39f, 21.71f, 21.56f, 21.42f, 21.71f, 21.38f, 21.63f, 21.42f, 21.18f,
+    21.53f, 21.54f, 21.41f, 21.17f, 21.54f, 21.37f, 21.42f, 21.53f, 21.13f, 21.67f,
+    21.62f, 21.57f, 21.53f, 21.83f, 21.40f, 21.54f, 21.73f, 21.14f, 21.47f, 21.52f,
+    21.38f, 21.46f, 21.39f, 21.39f, 21.48f, 21.64f, 21.39f, 21.59f, 21.48f, 21.28f,
+    21.39f, 21.22f, 21.45f, 21.53f, 21.41f, 21.51f, 21.40f, 21.73f, 21.72f, 21.38f,
+    21.52f, 21.56f, 21.62f, 21.22f, 21.56f, 21.27f, 21.68f, 21.65f, 21.43f, 22.07f,
+    21.25f, 21.20f, 21.45f, 21.25f, 21.51f, 21.36f, 21.55f, 21.49f, 21.58f, 21.80f,
+    21.43f, 21.35f, 21.55f, 21.29f, 21.51f, 21.45f, 21.37f, 21.84f, 21.90f, 21.73f,
+    21.42f, 21.33f, 21.58f, 21.38f, 21.82f, 21.44f, 21.65f, 21.49f, 21.62f, 21.49f,
+    21.42f, 21.35f, 21.67f, 21.50f, 21.47f, 21.52f, 21.37f, 21.31f, 21.63f, 21.45f,
+    21.20f, 21.38f, 21.63f, 21.70f, 21.19f, 21.66f, 21.57f, 18.50f, 21.61f, 21.51f,
+    21.54f, 21.40f, 21.60f, 21.53f, 21.68f, 21.37f, 21.51f, 21.55f, 21.69f, 21.42f,
+    21.60f, 21.63f, 21.39f, 21.55f, 21.31f, 21.44f, 21.72f, 21.33f, 21.58f, 21.46f,
+    21.53f, 21.62f, 21.43f, 21.29f, 21.37f, 21.44f, 21.57f, 21.29f, 21.62f, 21.41f,
+    21.31f, 21.83f, 21.39f, 21.67f, 21.17f, 21.36f, 21.50f, 21.80f, 21.45f, 21.56f,
+    21.61f, 21.69f, 21.47f, 21.29f, 21.55f, 21.47f, 21.51f, 21.41f, 21.51f, 21.41f,
+    21.40f, 21.56f, 21.60f, 21.40f, 21.53f, 21.46f, 21.63f, 21.43f, 21.57f, 21.48f,
+    21.57f, 21.37f, 21.75f, 21.38f, 21.67f, 21.17f, 21.62f, 21.39f, 21.55f, 21.50f,
+    21.35f, 21.47f, 21.30f, 21.57f, 21.71f, 21.88f, 21.72f, 21.42f, 21.30f, 21.46f,
+    21.50f, 21.33f, 21.47f, 21.49f, 21.39f, 21.22f, 21.53f, 21.53f, 21.33f, 21.56f,
+    21.49f, 21.50f, 21.46f, 21.47f, 21.58f, 21.63f, 21.56f, 21.39f, 21.40f, 21.29f,
+    21.52f, 21.62f, 21.42f, 21.44f, 21.40f, 21.54f, 21.19f, 21.46f, 21.66f, 21.65f,
+    21.36f, 21.44f, 21.60f, 21.71f, 21.67f, 21.77f, 21.36f, 21.49f, 21.79f, 21.43f,
+    21.44f, 21.28f, 21.71f, 21.35f, 21.52f, 21.69f, 21.62f, 21.49f, 21.59f, 21.51f,
+    21.73f, 21.66f, 21.44f, 21.36f, 21.45f, 21.11f, 21.45f, 21.60f, 21.37f, 21.73f,
+    21.19f, 21.40f, 21.51f, 21.51f, 21.52f, 21.39f, 21.46f, 21.41f, 21.53f, 21.63f,
+    21.69f, 21.43f, 21.63f, 21.43f, 21.69f, 21.61f, 21.35f, 21.53f, 21.62f, 21.52f,
+    21.16f, 21.53f, 21.64f, 21.32f, 21.28f, 21.45f, 21.42f, 21.27f, 21.45f, 21.45f,
+    21.49f, 21.55f, 21.42f, 21.50f, 21.65f, 21.69f, 21.56f, 21.25f, 21.38f, 21.53f,
+    21.40f, 21.49f, 21.58f, 21.26f, 21.46f, 21.54f, 21.64f, 21.49f, 21.68f, 21.61f,
+    21.55f, 21.49f, 21.68f, 21.20f, 21.68f, 21.60f, 21.42f, 21.65f, 21.38f, 21.35f,
+    21.26f, 21.50f, 21.76f, 21.54f, 21.54f, 21.29f, 21.30f, 21.44f, 21.48f, 21.50f,
+    21.71f, 21.52f, 21.55f, 21.61f, 21.47f, 21.54f, 21.66f, 21.67f, 21.69f, 21.33f,
+    21.56f, 21.42f, 21.37f, 21.75f, 21.29f, 21.74f, 21.52f, 21.43f, 21.64f, 21.35f,
+    21.44f, 21.60f, 21.42f, 21.53f, 21.46f, 21.54f, 21.68f, 21.73f, 21.43f, 21.67f,
+    21.74f, 21.59f, 21.58f, 21.40f, 21.53f, 21.70f, 21.47f, 21.39f, 21.20f, 21.43f,
+    21.49f, 21.36f, 21.68f, 21.52f, 21.45f, 21.25f, 21.73f, 21.48f, 21.66f, 21.78f,
+    21.47f, 21.44f, 21.40f, 21.58f, 21.55f, 21.49f, 21.28f, 21.59f, 21.46f, 21.55f,
+    21.54f, 21.35f, 21.52f, 21.54f, 21.56f, 21.67f, 21.46f, 21.49f, 21.31f, 21.83f,
+    21.69f, 21.59f, 21.35f, 21.30f, 21.63f, 21.42f, 21.36f, 21.39f, 21.58f, 21.69f,
+    21.21f, 21.96f, 21.57f, 21.61f, 21.38f, 21.47f, 21.55f, 21.40f, 21.51f, 21.63f,
+    21.45f, 21.38f, 21.37f, 21.39f, 21.51f, 21.72f, 21.60f, 21.13f, 18.04f, 21.45f,
+    21.49f, 21.24f, 21.71f, 21.48f, 21.50f, 21.56f, 21.41f, 21.65f, 21.49f, 21.31f,
+    21.56f, 21.51f, 21.40f, 21.65f, 21.47f, 21.56f, 21.35f, 21.33f, 21.50f, 21.44f,
+    21.48f, 21.39f, 21.18f, 21.45f, 21.65f, 21.43f, 21.66f, 21.41f, 21.57f, 21.64f,
+    21.56f, 21.54f, 21.61f, 21.51f, 21.44f, 21.54f, 21.49f, 21.53f, 21.30f, 21.42f,
+    21.47f, 21.54f, 21.27f, 21.51f, 21.52f, 21.32f, 21.54f, 21.36f, 21.33f, 21.39f,
+    21.57f, 21.78f, 21.48f, 21.53f, 21.58f, 21.40f, 21.48f, 21.53f, 21.54f, 21.54f,
+    21.60f, 21.35f, 21.59f, 21.27f, 21.67f, 21.42f, 21.69f, 21.50f, 21.59f, 21.42f,
+    21.44f, 21.36f, 21.55f, 21.46f, 21.70f, 21.36f, 21.59f, 21.61f, 21.60f, 21.53f,
+    21.45f, 21.44f, 21.29f, 21.45f, 21.44f, 21.40f, 21.43f, 21.48f, 21.43f, 21.71f,
+    21.80f, 21.93f, 21.48f, 21.33f, 21.85f, 21.49f, 21.62f, 21.43f, 21.63f, 21.61f,
+    21.69f, 21.38f, 21.13f, 21.42f, 21.27f, 21.53f, 21.48f, 21.67f, 21.32f, 21.54f,
+    21.49f, 21.69f, 21.25f, 21.60f, 21.24f, 21.77f, 21.64f, 21.66f, 21.43f, 21.53f,
+    18.63f, 21.52f, 21.36f, 21.69f, 21.43f, 21.53f, 21.50f, 21.68f, 21.48f, 21.42f,
+    21.57f, 21.36f, 21.46f, 21.69f, 21.61f, 21.32f, 21.47f, 21.31f, 21.46f, 21.70f,
+    21.04f, 21.58f, 21.41f, 21.38f, 21.59f, 21.80f, 21.58f, 21.56f, 21.22f, 21.43f,
+    21.38f, 21.63f, 21.66f, 21.27f, 21.55f, 21.37f, 21.39f, 21.43f, 21.18f, 21.54f,
+    21.62f, 21.33f, 21.42f, 21.62f, 21.42f, 21.58f, 21.31f, 21.45f, 21.68f, 21.36f,
+    21.39f, 21.60f, 21.43f, 21.56f, 21.39f, 21.54f, 21.77f, 21.62f, 21.42f, 21.30f,
+    21.38f, 21.51f, 21.58f, 21.52f, 21.49f, 21.60f, 21.85f, 21.29f, 21.60f, 21.63f,
+    21.48f, 21.41f, 21.17f, 21.54f, 21.35f, 21.53f, 21.52f, 21.70f, 21.39f, 21.77f,
+    21.55f, 21.62f, 21.47f, 21.44f, 21.20f, 21.50f, 21.40f, 21.64f, 21.36f, 21.32f,
+    21.45f, 21.54f, 21.41f, 21.21f, 21.34f, 21.33f, 21.43f, 21.42f, 21.71f, 21.74f,
+    21.54f, 21.58f, 21.44f, 21.54f, 21.43f, 21.66f, 21.36f, 21.56f, 21.75f, 21.43f,
+    21.45f, 21.87f, 21.56f, 21.58f, 21.74f, 21.48f, 21.66f, 18.85f, 21.57f, 21.68f,
+    21.55f, 21.71f, 21.60f, 21.69f, 21.48f, 21.51f, 21.43f, 21.50f, 21.51f, 21.40f,
+    21.43f, 21.30f, 21.81f, 24.05f, 21.26f, 21.37f, 21.41f, 21.45f, 21.58f, 21.22f,
+    21.63f, 21.75f, 21.49f, 21.53f, 21.64f, 21.42f, 21.52f, 21.69f, 21.54f, 21.75f,
+    21.46f, 21.57f, 21.70f, 21.63f, 21.52f, 21.48f, 21.58f, 21.60f, 21.47f, 21.60f,
+    21.71f, 21.54f, 21.93f, 21.39f, 21.60f, 21.64f, 21.51f, 21.16f, 21.38f, 21.21f,
+    21.37f, 21.69f, 21.58f, 21.57f, 21.67f, 21.44f, 21.33f, 21.37f, 21.47f, 21.60f,
+    21.63f, 21.41f, 21.20f, 21.48f, 21.63f, 21.52f, 21.38f, 21.56f, 21.33f, 21.59f,
+    21.62f, 21.44f, 21.53f, 21.73f, 21.60f, 21.62f, 21.47f, 21.47f, 21.40f, 21.66f,
+    21.39f, 21.69f, 21.67f, 21.42f, 21.44f, 21.48f, 21.41f, 21.38f, 21.49f, 21.51f,
+    21.42f, 21.29f, 21.49f, 21.60f, 21.60f, 21.65f, 21.77f, 21.57f, 21.42f, 21.69f,
+    21.54f, 21.38f, 21.69f, 21.50f, 21.70f, 21.42f, 21.63f, 21.48f, 21.57f, 21.89f,
+    21.67f, 21.68f, 21.37f, 21.98f, 21.43f, 21.38f, 21.31f, 21.60f, 21.38f, 21.40f,
+    21.90f, 21.47f, 21.36f, 21.46f, 21.43f, 21.57f, 21.66f, 21.59f, 21.64f, 21.56f,
+    21.66f, 21.59f, 21.48f, 21.45f, 21.54f, 21.33f, 21.35f, 21.70f, 21.58f, 21.36f,
+    21.38f, 21.51f, 21.55f, 21.85f, 21.72f, 21.85f, 21.32f, 21.78f, 21.74f, 21.27f,
+    21.74f, 21.54f, 21.74f, 21.48f, 21.56f, 21.42f, 21.47f, 25.12f, 21.51f, 21.83f,
+    21.67f, 21.49f, 21.46f, 21.65f, 21.16f, 21.67f, 23.90f, 21.66f, 21.30f, 21.38f,
+    21.29f, 21.74f, 21.40f, 21.41f, 21.35f, 21.75f, 21.53f, 21.78f, 21.38f, 21.48f,
+    21.57f, 21.64f, 21.57f, 21.45f, 21.16f, 21.60f, 21.41f, 21.60f, 21.54f, 21.49f,
+    21.43f, 21.44f, 21.69f, 21.40f, 21.49f, 21.53f, 21.60f, 21.37f, 21.54f, 21.76f,
+    21.62f, 21.61f, 21.50f, 21.52f, 21.38f, 21.43f, 21.55f, 21.54f, 21.52f, 21.33f,
+    21.72f, 21.39f, 21.72f, 21.48f, 21.62f, 21.53f, 21.35f, 21.55f, 21.57f, 21.48f,
+    21.49f, 21.72f, 21.41f, 21.59f, 21.65f, 21.40f, 21.52f, 21.60f, 21.56f, 21.66f,
+    21.41f, 21.84f, 21.66f, 21.78f, 21.66f, 21.77f, 21.55f, 22.05f, 21.65f, 21.55f,
+    21.35f, 21.59f, 21.49f, 21.69f, 21.63f, 21.52f, 21.48f, 21.40f, 21.42f, 21.28f,
+    21.61f, 21.46f, 21.15f, 21.71f, 21.47f, 21.54f, 21.48f, 21.36f, 21.33f, 21.58f,
+    21.76f, 21.52f, 21.51f, 21.36f, 21.48f, 21.63f, 21.73f, 21.49f, 21.76f, 21.45f,
+    21.51f, 21.50f, 21.39f, 21.58f, 21.78f, 21.62f, 21.93f, 21.77f, 21.77f, 21.58f,
+    21.44f, 21.71f, 21.81f, 21.80f, 21.60f, 21.84f, 21.33f, 21.78f, 21.48f, 21.61f,
+    21.70f, 21.57f, 21.51f, 21.72f, 21.86f, 21.58f, 22.19f, 21.78f, 21.71f, 21.82f,
+    21.67f, 21.65f, 21.61f, 21.62f, 22.15f, 21.78f, 21.59f, 21.77f, 22.05f, 21.74f,
+    21.79f, 21.76f, 21.76f, 19.18f, 21.80f, 21.58f, 21.76f, 21.74f, 21.76f, 21.62f,
+    21.62f, 21.75f, 21.90f, 21.95f, 21.68f, 18.50f, 21.77f, 21.74f, 21.77f, 21.76f,
+    22.00f, 22.05f, 22.03f, 21.71f, 21.94f, 21.96f, 21.82f, 21.88f, 21.95f, 21.61f,
+    21.79f, 22.01f, 21.86f, 22.11f, 21.94f, 22.17f, 22.13f, 21.90f, 21.96f, 22.02f,
+    22.08f, 21.94f, 21.87f, 22.17f, 21.97f, 21.78f, 22.07f, 21.80f, 21.89f, 21.65f,
+    21.90f, 21.93f, 22.23f, 22.12f, 22.03f, 22.02f, 22.11f, 21.87f, 21.98f, 22.07f,
+    22.11f, 22.28f, 21.98f, 22.01f, 22.41f, 21.99f, 21.99f, 22.02f, 22.32f, 22.24f,
+    21.91f, 22.29f, 22.16f, 22.14f, 22.06f, 22.11f, 22.04f, 22.47f, 22.20f, 21.96f,
+    22.06f, 22.24f, 22.13f, 22.29f, 22.03f, 22.03f, 22.04f, 22.23f, 22.05f, 22.26f,
+    21.97f, 22.08f, 22.33f, 22.00f, 22.38f, 22.39f, 22.07f, 22.57f, 22.19f, 22.17f,
+    22.27f, 22.14f, 22.28f, 22.25f, 22.26f, 22.35f, 22.54f, 22.01f, 22.20f, 22.26f,
+    22.35f, 22.24f, 22.35f, 22.13f, 22.27f, 22.46f, 22.63f, 22.46f, 22.15f, 22.26f,
+    22.42f, 22.38f, 22.56f, 22.25f, 22.49f, 22.48f, 22.24f, 22.47f, 22.47f, 22.42f,
+    22.41f, 22.44f, 22.47f, 22.44f, 22.23f, 22.48f, 22.40f, 22.35f, 22.68f, 22.46f,
+    22.35f, 22.40f, 22.34f, 22.25f, 22.29f, 22.57f, 22.40f, 22.65f, 22.75f, 22.66f,
+    22.27f, 22.59f, 22.38f, 22.77f, 22.54f, 22.64f, 22.44f, 22.53f, 22.32f, 22.22f,
+    22.63f, 22.73f, 22.68f, 22.62f, 19.19f, 22.39f, 22.70f, 22.83f, 22.57f, 22.51f,
+    22.59f, 22.61f, 22.47f, 22.81f, 22.77f, 22.61f, 22.59f, 22.60f, 22.72f, 22.62f,
+    22.76f, 22.48f, 22.83f, 22.45f, 22.63f, 22.69f, 22.55f, 22.65f, 22.44f, 22.63f,
+    22.96f, 22.80f, 22.91f, 22.85f, 22.95f, 22.46f, 22.66f, 22.93f, 22.81f, 22.68f,
+    22.77f, 22.65f, 22.94f, 22.84f, 22.74f, 22.71f, 22.79f, 22.83f, 22.66f, 22.55f,
+    22.78f, 22.71f, 22.77f, 22.95f, 22.74f, 22.87f, 22.76f, 22.74f, 23.03f, 22.82f,
+    22.93f, 22.86f, 22.62f, 22.89f, 22.93f, 22.50f, 22.90f, 22.99f, 22.80f, 23.17f,
+    22.92f, 23.08f, 23.02f, 22.77f, 22.59f, 22.92f, 22.92f, 22.95f, 22.97f, 23.06f,
+    23.08f, 23.04f, 23.35f, 22.87f, 23.16f, 22.82f, 22.90f, 22.92f, 23.23f, 22.91f,
+    23.21f, 23.09f, 22.86f, 23.06f, 23.02f, 23.06f, 23.01f, 23.01f, 23.15f, 22.90f,
+    23.08f, 23.07f, 23.12f, 22.83f, 23.14f, 23.31f, 23.09f, 23.07f, 23.09f, 23.07f,
+    23.44f, 23.28f, 23.23f, 23.33f, 23.18f, 23.18f, 22.98f, 23.17f, 23.22f, 23.23f,
+    22.96f, 23.31f, 23.33f, 23.03f, 23.04f, 23.26f, 23.15f, 23.25f, 23.34f, 23.40f,
+    23.28f, 23.11f, 23.43f, 23.20f, 23.20f, 23.36f, 23.12f, 23.39f, 22.92f, 23.02f,
+    23.10f, 23.35f, 23.19f, 23.21f, 23.23f, 23.44f, 23.49f, 23.19f, 22.99f, 23.41f,
+    23.22f, 23.30f, 23.38f, 23.22f, 23.29f, 23.39f, 23.24f, 23.41f, 23.68f, 23.26f,
+    23.51f, 23.56f, 23.49f, 23.56f, 23.55f, 23.47f, 23.37f, 23.37f, 23.25f, 23.31f,
+    23.37f, 23.58f, 23.13f, 23.31f, 23.54f, 23.44f, 23.25f, 23.42f, 23.19f, 23.48f,
+    23.56f, 23.32f, 23.58f, 23.16f, 23.48f, 23.62f, 23.44f, 23.38f, 23.39f, 23.71f,
+    23.60f, 23.29f, 23.41f, 23.68f, 23.58f, 23.64f, 23.33f, 23.69f, 23.73f, 23.62f,
+    23.64f, 23.71f, 23.60f, 23.74f, 23.43f, 23.74f, 23.40f, 23.24f, 23.48f, 23.44f,
+    23.52f, 23.56f, 23.63f, 23.58f, 23.74f, 23.71f, 23.71f, 23.42f, 23.71f, 23.52f,
+    23.71f, 23.74f, 23.59f, 23.67f, 23.80f, 23.51f, 23.46f, 23.77f, 23.88f, 23.11f,
+    23.57f, 23.71f, 23.67f, 23.88f, 23.85f, 23.45f, 23.45f, 23.71f, 23.77f, 23.37f,
+    23.54f, 23.49f, 23.98f, 23.66f, 23.95f, 23.76f, 23.83f, 23.32f, 24.18f, 24.01f,
+    23.96f, 23.81f, 23.63f, 23.91f, 23.76f, 23.80f, 23.98f, 23.92f, 23.83f, 23.91f,
+    24.00f, 23.77f, 24.01f, 23.74f, 24.13f, 23.92f, 24.00f, 24.01f, 23.80f, 23.88f,
+    23.66f, 23.76f, 24.01f, 23.84f, 24.06f, 23.90f, 23.82f, 23.62f, 23.70f, 23.93f,
+    23.94f, 23.89f, 23.62f, 23.99f, 24.03f, 23.72f, 24.11f, 24.02f, 23.75f, 23.99f,
+    23.95f, 23.98f, 23.99f, 23.67f, 24.20f, 23.98f, 23.95f, 24.43f, 24.00f, 23.76f,
+    24.08f, 24.02f, 23.82f, 23.98f, 23.99f, 23.96f, 24.07f, 23.90f, 24.19f, 24.13f,
+    24.07f, 24.13f, 24.04f, 23.89f, 24.01f, 24.28f, 24.14f, 24.08f, 24.25f, 24.07f,
+    24.35f, 24.37f, 24.29f, 24.05f, 23.92f, 24.34f, 24.14f, 24.10f, 23.96f, 24.26f,
+    23.90f, 24.37f, 24.03f, 24.14f, 24.23f, 24.40f, 24.18f, 24.27f, 24.55f, 24.15f,
+    24.53f, 24.21f, 24.00f, 24.06f, 24.18f, 24.28f, 24.68f, 24.33f, 24.36f, 23.89f,
+    24.51f, 24.37f, 24.31f, 24.65f, 24.38f, 24.43f, 24.32f, 24.46f, 24.20f, 24.35f,
+    24.19f, 24.46f, 24.23f, 24.36f, 24.38f, 24.44f, 24.54f, 24.46f, 24.29f, 24.53f,
+    24.39f, 24.21f, 24.61f, 24.36f, 24.66f, 24.35f, 24.27f, 24.28f, 24.61f, 24.42f,
+    24.42f, 24.36f, 24.15f, 24.46f, 24.67f, 24.23f, 24.78f, 24.45f, 24.40f, 24.49f,
+    24.63f, 24.63f, 24.35f, 24.78f, 24.34f, 24.52f, 24.40f, 24.52f, 24.59f, 24.39f,
+    24.53f, 24.52f, 24.46f, 24.46f, 24.51f, 24.56f, 24.78f, 24.58f, 24.62f, 24.63f,
+    24.46f, 24.60f, 24.52f, 24.50f, 24.74f, 24.70f, 24.74f, 24.50f, 24.47f, 24.59f,
+    24.66f, 24.59f, 24.88f, 24.34f, 24.56f, 27.04f, 24.76f, 24.58f, 24.93f, 24.51f,
+    24.54f, 24.88f, 24.67f, 24.66f, 24.69f, 24.40f, 24.75f, 24.80f, 24.76f, 24.88f,
+    24.79f, 24.81f, 24.81f, 24.71f, 24.92f, 24.62f, 24.69f, 24.76f, 24.56f, 24.69f,
+    24.92f, 24.88f, 24.58f, 24.72f, 24.59f, 24.83f, 24.81f, 24.56f, 24.77f, 28.29f,
+    24.92f, 24.71f, 24.98f, 24.93f, 24.91f, 24.74f, 24.62f, 25.10f, 24.87f, 24.75f,
+    24.72f, 24.92f, 25.05f, 24.78f, 24.96f, 24.84f, 24.88f, 25.09f, 24.85f, 25.14f,
+    24.75f, 24.94f, 25.06f, 25.05f, 25.29f, 28.60f, 25.06f, 24.85f, 25.17f, 25.03f,
+    24.75f, 24.71f, 24.62f, 25.06f, 27.71f, 24.74f, 25.24f, 25.11f, 25.15f, 25.21f,
+    25.27f, 25.19f, 25.02f, 25.11f, 25.16f, 24.89f, 25.26f, 25.26f, 25.24f, 25.10f,
+    25.30f, 25.29f, 25.40f, 25.12f, 25.09f, 25.19f, 25.18f, 25.09f, 25.10f, 25.14f,
+    24.95f, 25.04f, 25.15f, 25.28f, 25.04f, 25.26f, 25.06f, 24.90f, 25.44f, 25.47f,
+    25.13f, 25.15f, 25.29f, 25.42f, 25.25f, 25.45f, 25.17f, 25.19f, 25.05f, 25.31f,
+    25.35f, 25.25f, 25.31f, 25.26f, 25.29f, 25.23f, 25.01f, 25.46f, 25.45f, 25.23f,
+    25.25f, 25.52f, 25.33f, 25.40f, 25.32f, 25.48f, 25.20f, 25.61f, 25.29f, 25.39f,
+    25.41f, 25.55f, 25.39f, 25.15f, 25.13f, 25.28f, 25.40f, 25.43f, 25.22f, 25.54f,
+    28.83f, 25.27f, 25.63f, 25.32f, 25.45f, 25.38f, 25.37f, 25.55f, 25.30f, 25.42f,
+    25.18f, 25.56f, 25.32f, 25.17f, 25.18f, 25.17f, 25.54f, 25.48f, 25.46f, 25.68f,
+    25.65f, 25.40f, 25.62f, 25.79f, 25.54f, 25.41f, 25.31f, 25.55f, 28.50f, 25.47f,
+    25.77f, 25.44f, 25.50f, 25.29f, 25.73f, 25.69f, 25.45f, 25.50f, 25.74f, 25.60f,
+    25.73f, 25.98f, 25.86f, 25.58f, 25.83f, 25.67f, 25.78f, 25.63f, 25.55f, 25.50f,
+    25.41f, 25.87f, 25.68f, 25.61f, 25.74f, 25.73f, 25.78f, 25.56f, 25.67f, 25.88f,
+    25.85f, 25.78f, 25.80f, 25.64f, 25.63f, 25.69f, 25.65f, 25.96f, 25.85f, 25.86f,
+    25.69f, 25.67f, 25.79f, 25.93f, 25.87f, 25.81f, 25.80f, 25.84f, 25.69f, 25.86f,
+    25.87f, 25.82f, 25.96f, 25.85f, 25.84f, 25.54f, 25.82f, 25.56f, 25.62f, 25.76f,
+    25.79f, 25.59f, 25.86f, 25.89f, 25.69f, 25.83f, 25.92f, 25.89f, 25.69f, 25.89f,
+    25.96f, 25.74f, 25.88f, 25.77f, 25.93f, 25.85f, 25.86f, 26.06f, 26.18f, 26.01f,
+    25.95f, 26.10f, 26.25f, 25.93f, 26.13f, 25.87f, 26.01f, 25.89f, 25.99f, 25.96f,
+    25.87f, 26.07f, 26.16f, 26.09f, 25.65f, 26.02f, 26.05f, 25.89f, 25.99f, 23.53f,
+    26.13f, 26.40f, 26.11f, 26.25f, 26.14f, 26.11f, 25.81f, 26.11f, 25.90f, 26.11f,
+    26.00f, 26.28f, 26.08f, 26.25f, 26.02f, 26.26f, 26.19f, 25.91f, 26.20f, 26.21f,
+    26.21f, 26.30f, 26.23f, 26.08f, 25.96f, 25.82f, 26.19f, 26.21f, 26.17f, 26.26f,
+    26.22f, 26.25f, 26.53f, 26.43f, 25.98f, 26.32f, 26.33f, 26.27f, 26.42f, 26.49f,
+    26.27f, 26.39f, 26.41f, 26.30f, 26.14f, 26.37f, 26.45f, 26.58f, 26.19f, 26.13f,
+    26.28f, 26.29f, 26.19f, 26.28f, 26.48f, 26.54f, 26.52f, 26.49f, 26.29f, 26.57f,
+    26.35f, 26.46f, 26.53f, 26.45f, 26.45f, 26.61f, 26.42f, 26.61f, 26.18f, 26.49f,
+    26.41f, 26.29f, 26.25f, 26.49f, 26.06f, 26.28f, 26.61f, 26.44f, 26.44f, 26.36f,
+    26.52f, 26.60f, 26.71f, 26.22f, 26.42f, 26.27f, 26.53f, 26.56f, 26.35f, 29.42f,
+};
+static const size_t kNoisyTraceLength =
+    sizeof(kNoisyTrace) / sizeof(kNoisyTrace[0]);
+
+#endif // NOISY_TRACE_H
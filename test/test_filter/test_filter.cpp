@@ -0,0 +1,204 @@
+#include <SensorFilter.h>
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <unity.h>
+
+#include "noisy_trace.h"
+
+#define BENCH_ROUNDS 200 // Passes over the trace per benchmark
+
+// Signal the trace was generated from, without noise or spikes
+static float TrueValue(size_t index) {
+  if (index < NOISY_TRACE_STEP) {
+    return NOISY_TRACE_LEVEL;
+  }
+  return NOISY_TRACE_LEVEL + (index - NOISY_TRACE_STEP) * NOISY_TRACE_SLOPE;
+}
+
+// Root mean square error against TrueValue() over [from, to)
+static float Rms(const float *values, size_t from, size_t to) {
+  double sum = 0.0;
+  for (size_t i = from; i < to; i++) {
+    double error = values[i] - TrueValue(i);
+    sum += error * error;
+  }
+  return sqrt(sum / (to - from));
+}
+
+static float filtered[kNoisyTraceLength];
+
+static void FilterTrace(SensorFilter &filter) {
+  filter.Reset();
+  for (size_t i = 0; i < kNoisyTraceLength; i++) {
+    filtered[i] = filter.Apply(kNoisyTrace[i]);
+  }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_median_matches_sorted_window() {
+  for (uint8_t window = 3; window <= FILTER_MAX_WINDOW; window += 2) {
+    SensorFilter filter;
+    filter.SetMedian(window);
+    for (size_t i = 0; i < kNoisyTraceLength; i++) {
+      // Reference: sort the samples seen so far, at most `window` of them
+      size_t count = std::min<size_t>(i + 1, window);
+      float sorted[FILTER_MAX_WINDOW];
+      std::copy(kNoisyTrace + i + 1 - count, kNoisyTrace + i + 1, sorted);
+      std::sort(sorted, sorted + count);
+      float value = filter.Apply(kNoisyTrace[i]);
+      if (value != sorted[count / 2]) {
+        char message[64];
+        snprintf(message, sizeof(message), "window %u at sample %u", window,
+                 (unsigned)i);
+        TEST_FAIL_MESSAGE(message);
+      }
+    }
+  }
+
+  // Ties: the repeated value is the median whatever its position
+  SensorFilter filter;
+  filter.SetMedian(5);
+  const float ties[] = {2.0f, 1.0f, 2.0f, 2.0f, 3.0f, 1.0f, 1.0f};
+  const float expected[] = {2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f, 2.0f};
+  for (uint8_t i = 0; i < 7; i++) {
+    TEST_ASSERT_EQUAL_FLOAT(expected[i], filter.Apply(ties[i]));
+  }
+}
+
+void test_median_rejects_spikes() {
+  SensorFilter filter;
+  filter.SetMedian(5);
+  FilterTrace(filter);
+
+  // Spikes are ~20 sigma; after the median nothing is further than 5 sigma
+  float rawWorst = 0.0f;
+  float worst = 0.0f;
+  for (size_t i = 0; i < kNoisyTraceLength; i++) {
+    rawWorst = std::max(rawWorst, fabsf(kNoisyTrace[i] - TrueValue(i)));
+    worst = std::max(worst, fabsf(filtered[i] - TrueValue(i)));
+  }
+  TEST_ASSERT_GREATER_THAN_FLOAT(2.0f, rawWorst);
+  TEST_ASSERT_LESS_THAN_FLOAT(5 * NOISY_TRACE_SIGMA, worst);
+}
+
+void test_ema_step_response() {
+  const float alpha = 0.2f;
+  SensorFilter filter;
+  filter.SetEma(alpha);
+  filter.Apply(0.0f); // Primes at 0
+  for (int n = 1; n <= 30; n++) {
+    // Closed form of y += alpha * (1 - y) from 0: 1 - (1 - alpha)^n
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 1.0f - powf(1.0f - alpha, n),
+                             filter.Apply(1.0f));
+  }
+
+  // Out of range turns the stage off
+  filter.SetEma(1.0f);
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, filter.GetEmaAlpha());
+  filter.Apply(0.0f);
+  TEST_ASSERT_EQUAL_FLOAT(5.0f, filter.Apply(5.0f));
+}
+
+void test_kalman_reaches_steady_state() {
+  const float q = 1e-4f;
+  const float r = NOISY_TRACE_SIGMA * NOISY_TRACE_SIGMA;
+  SensorFilter filter;
+  filter.SetKalman(q, r);
+  filter.Apply(0.0f);
+  for (int n = 0; n < 1000; n++) {
+    filter.Apply(0.0f);
+  }
+
+  // Riccati fixed point: predicted variance p solves p^2 - q p - q r = 0
+  // and the gain is p / (p + r); a unit step then moves the estimate by it
+  float predicted = (q + sqrtf(q * q + 4 * q * r)) / 2;
+  float gain = predicted / (predicted + r);
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, gain, filter.Apply(1.0f));
+
+  // On the trace (after the median has taken the spikes out) it removes
+  // most of the noise and still follows the ramp
+  filter.SetMedian(5);
+  FilterTrace(filter);
+  float raw = Rms(kNoisyTrace, 100, NOISY_TRACE_STEP);
+  float flat = Rms(filtered, 100, NOISY_TRACE_STEP);
+  float ramp = Rms(filtered, NOISY_TRACE_STEP + 100, kNoisyTraceLength);
+  TEST_ASSERT_LESS_THAN_FLOAT(raw / 3, flat);
+  TEST_ASSERT_LESS_THAN_FLOAT(2 * NOISY_TRACE_SIGMA, ramp);
+}
+
+void test_stages_chain_in_order() {
+  SensorFilter chained;
+  chained.SetMedian(5);
+  chained.SetEma(0.3f);
+  chained.SetKalman(1e-3f, 0.02f);
+  SensorFilter median;
+  median.SetMedian(5);
+  SensorFilter ema;
+  ema.SetEma(0.3f);
+  SensorFilter kalman;
+  kalman.SetKalman(1e-3f, 0.02f);
+  for (size_t i = 0; i < kNoisyTraceLength; i++) {
+    float value = kalman.Apply(ema.Apply(median.Apply(kNoisyTrace[i])));
+    TEST_ASSERT_EQUAL_FLOAT(value, chained.Apply(kNoisyTrace[i]));
+  }
+}
+
+/**
+ * @brief Time one configuration over the trace and report ns per sample
+ * @details Host numbers: useful to compare stages and catch regressions, not
+ * as ESP32 timings.
+ */
+static void Bench(const char *name, SensorFilter &filter) {
+  volatile float sink = 0.0f;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    filter.Reset();
+    for (size_t i = 0; i < kNoisyTraceLength; i++) {
+      sink = filter.Apply(kNoisyTrace[i]);
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  double ns = std::chrono::duration<double, std::nano>(elapsed).count() /
+              (BENCH_ROUNDS * kNoisyTraceLength);
+  char message[64];
+  snprintf(message, sizeof(message), "%-14s %7.1f ns/sample", name, ns);
+  TEST_MESSAGE(message);
+  (void)sink;
+}
+
+void test_benchmark() {
+  SensorFilter off;
+  Bench("off", off);
+  SensorFilter median5;
+  median5.SetMedian(5);
+  Bench("median 5", median5);
+  SensorFilter median9;
+  median9.SetMedian(9);
+  Bench("median 9", median9);
+  SensorFilter ema;
+  ema.SetEma(0.2f);
+  Bench("ema", ema);
+  SensorFilter kalman;
+  kalman.SetKalman(1e-4f, 0.0225f);
+  Bench("kalman", kalman);
+  SensorFilter all;
+  all.SetMedian(9);
+  all.SetEma(0.2f);
+  all.SetKalman(1e-4f, 0.0225f);
+  Bench("median9+ema+kf", all);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_median_matches_sorted_window);
+  RUN_TEST(test_median_rejects_spikes);
+  RUN_TEST(test_ema_step_response);
+  RUN_TEST(test_kalman_reaches_steady_state);
+  RUN_TEST(test_stages_chain_in_order);
+  RUN_TEST(test_benchmark);
+  return UNITY_END();
+}
@@ -0,0 +1,84 @@
+#include "MockI2cBus.h"
+
+bool MockI2cBus::AddDevice(uint8_t address, uint8_t width) {
+  if (numDevices >= MOCK_I2C_DEVICES) {
+    return false;
+  }
+  Device &device = devices[numDevices++];
+  device.address = address;
+  device.width = width;
+  device.pointer = 0;
+  return true;
+}
+
+uint8_t *MockI2cBus::GetRegisters(uint8_t address) {
+  Device *device = Find(address);
+  return device ? device->registers : nullptr;
+}
+
+MockI2cBus::Device *MockI2cBus::Find(uint8_t address) {
+  for (uint8_t i = 0; i < numDevices; i++) {
+    if (devices[i].address == address) {
+      return &devices[i];
+    }
+  }
+  return nullptr;
+}
+
+size_t MockI2cBus::Offset(const Device &device, size_t index) const {
+  return (device.pointer * device.width + index) % MOCK_I2C_REGISTERS;
+}
+
+bool MockI2cBus::Write(uint8_t address, const uint8_t *data, size_t length) {
+  transfers++;
+  Device *device = Find(address);
+  if (device == nullptr) {
+    return false;
+  }
+  if (device->width == 0) {
+    for (size_t i = 0; i < length; i++) {
+      device->registers[i % MOCK_I2C_REGISTERS] = data[i];
+    }
+    return true;
+  }
+  if (length == 0) {
+    return true;
+  }
+  device->pointer = data[0];
+  for (size_t i = 1; i < length; i++) {
+    device->registers[Offset(*device, i - 1)] = data[i];
+  }
+  device->pointer += (length - 1) / device->width;
+  return true;
+}
+
+bool MockI2cBus::Read(uint8_t address, uint8_t *data, size_t length) {
+  transfers++;
+  Device *device = Find(address);
+  if (device == nullptr) {
+    return false;
+  }
+  if (device->width == 0) {
+    for (size_t i = 0; i < length; i++) {
+      data[i] = device->registers[i % MOCK_I2C_REGISTERS];
+    }
+    return true;
+  }
+  for (size_t i = 0; i < length; i++) {
+    data[i] = device->registers[Offset(*device, i)];
+  }
+  device->pointer += length / device->width;
+  return true;
+}
+
+bool MockI2cBus::ReadRegisters(uint8_t address, uint8_t reg, uint8_t *data,
+                               size_t length) {
+  Device *device = Find(address);
+  if (device == nullptr) {
+    transfers++;
+    return false;
+  }
+  // Pointer write and read share one transaction (repeated start)
+  device->pointer = reg;
+  return Read(address, data, length);
+}
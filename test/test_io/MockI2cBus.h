@@ -0,0 +1,58 @@
+#ifndef MOCKI2CBUS_H
+#define MOCKI2CBUS_H
+
+#include <I2cBus.h>
+
+#define MOCK_I2C_DEVICES 4     // Devices a MockI2cBus can simulate
+#define MOCK_I2C_REGISTERS 256 // Registers per simulated device
+
+/**
+ * @brief In-memory I2C bus for host tests
+ * @details Each device is a register file. For devices with a register
+ * pointer, the first byte written sets the pointer and it advances every
+ * `width` bytes, so MCP23017 (8-bit registers, auto-increment) and ADS1115
+ * (16-bit registers) behave as the drivers expect. Devices without one
+ * (PCF8574) read and write register 0 directly.
+ */
+class MockI2cBus : public I2cBus {
+public:
+  /**
+   * @brief Add a simulated device
+   * @param address 7-bit address
+   * @param width Bytes per register, 0 for a device without a pointer
+   * @return false if there is no room for another device
+   */
+  bool AddDevice(uint8_t address, uint8_t width = 1);
+
+  /**
+   * @brief Register file of a device, to preset inputs or check outputs
+   * @return nullptr if the device doesn't exist
+   */
+  uint8_t *GetRegisters(uint8_t address);
+
+  // Transactions seen so far (writes and reads each count one)
+  uint32_t GetTransfers() const { return transfers; }
+  void ResetTransfers() { transfers = 0; }
+
+  bool Write(uint8_t address, const uint8_t *data, size_t length) override;
+  bool Read(uint8_t address, uint8_t *data, size_t length) override;
+  bool ReadRegisters(uint8_t address, uint8_t reg, uint8_t *data,
+                     size_t length) override;
+
+private:
+  struct Device {
+    uint8_t address;
+    uint8_t width;
+    uint8_t pointer;
+    uint8_t registers[MOCK_I2C_REGISTERS];
+  };
+
+  Device *Find(uint8_t address);
+  size_t Offset(const Device &device, size_t index) const;
+
+  Device devices[MOCK_I2C_DEVICES] = {};
+  uint8_t numDevices = 0;
+  uint32_t transfers = 0;
+};
+
+#endif // MOCKI2CBUS_H
@@ -0,0 +1,173 @@
+#include <I2cExpanders.h>
+#include <unity.h>
+
+#include "MockI2cBus.h"
+
+#define ADS1115_ADDR 0x48
+#define MCP23017_ADDR 0x20
+#define PCF8574_ADDR 0x27
+
+static MockI2cBus bus;
+
+void setUp() { bus = MockI2cBus(); }
+void tearDown() {}
+
+// Raw conversion result the ADS1115 would give for `volts`
+static void SetConversion(float volts) {
+  int16_t raw = (int16_t)(volts / (4.096f / 32768.0f));
+  uint8_t *registers = bus.GetRegisters(ADS1115_ADDR);
+  registers[0] = raw >> 8;
+  registers[1] = raw;
+}
+
+// Channel of the conversion last started, from the MUX field
+static uint8_t StartedChannel() {
+  uint8_t *registers = bus.GetRegisters(ADS1115_ADDR);
+  return (registers[2] >> 4) & 0x03;
+}
+
+void test_ads1115_round_robin() {
+  bus.AddDevice(ADS1115_ADDR, 2);
+  Ads1115 ads(bus, ADS1115_ADDR);
+  ads.ConfigureInput(0);
+  ads.ConfigureInput(2);
+  float value;
+
+  // First tick only starts channel 0
+  ads.Poll(0);
+  TEST_ASSERT_EQUAL_UINT32(1, bus.GetTransfers());
+  TEST_ASSERT_EQUAL_UINT8(0, StartedChannel());
+  TEST_ASSERT_FALSE(ads.ReadInput(0, value));
+
+  // Too soon for the converter: no bus traffic at all
+  bus.ResetTransfers();
+  ads.Poll(ADS1115_CONVERSION_MS - 1);
+  TEST_ASSERT_EQUAL_UINT32(0, bus.GetTransfers());
+
+  // Then one read and one write per tick, skipping unused channels
+  const uint8_t order[] = {2, 0, 2};
+  const float volts[] = {1.0f, 2.5f, 0.5f};
+  uint32_t now = ADS1115_CONVERSION_MS;
+  uint8_t reading = 0;
+  for (uint8_t i = 0; i < 3; i++, now += ADS1115_CONVERSION_MS) {
+    SetConversion(volts[i]);
+    bus.ResetTransfers();
+    ads.Poll(now);
+    TEST_ASSERT_EQUAL_UINT32(2, bus.GetTransfers());
+    TEST_ASSERT_EQUAL_UINT8(order[i], StartedChannel());
+
+    // Only the channel just collected is fresh, and only once
+    uint8_t other = reading == 0 ? 2 : 0;
+    TEST_ASSERT_FALSE(ads.ReadInput(other, value));
+    TEST_ASSERT_TRUE(ads.ReadInput(reading, value));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, volts[i], value);
+    TEST_ASSERT_FALSE(ads.ReadInput(reading, value));
+    reading = order[i];
+  }
+}
+
+void test_mcp23017_one_transfer_each_way() {
+  bus.AddDevice(MCP23017_ADDR);
+  Mcp23017 mcp(bus, MCP23017_ADDR);
+  mcp.ConfigureOutput(0);
+  mcp.ConfigureOutput(9);
+  mcp.ConfigureInput(3);
+  mcp.ConfigureInput(12);
+  TEST_ASSERT_TRUE(mcp.Begin());
+  uint8_t *registers = bus.GetRegisters(MCP23017_ADDR);
+  TEST_ASSERT_EQUAL_HEX8(0xFE, registers[0x00]); // IODIRA
+  TEST_ASSERT_EQUAL_HEX8(0xFD, registers[0x01]); // IODIRB
+
+  for (uint8_t tick = 0; tick < 2; tick++) {
+    registers[0x12] = tick ? 0x00 : 0x08; // GPIOA: GPA3
+    registers[0x13] = tick ? 0x10 : 0x00; // GPIOB: GPB4 = channel 12
+
+    bus.ResetTransfers();
+    mcp.Poll(tick);
+    TEST_ASSERT_EQUAL_UINT32(1, bus.GetTransfers());
+    float value;
+    TEST_ASSERT_TRUE(mcp.ReadInput(3, value));
+    TEST_ASSERT_EQUAL_FLOAT(tick ? 0.0f : 1.0f, value);
+    TEST_ASSERT_TRUE(mcp.ReadInput(12, value));
+    TEST_ASSERT_EQUAL_FLOAT(tick ? 1.0f : 0.0f, value);
+    TEST_ASSERT_FALSE(mcp.ReadInput(3, value));
+
+    // Both outputs switch, one latch write for the two of them
+    bus.ResetTransfers();
+    mcp.WriteOutput(0, !tick);
+    mcp.WriteOutput(9, !tick);
+    mcp.Flush();
+    TEST_ASSERT_EQUAL_UINT32(1, bus.GetTransfers());
+    TEST_ASSERT_EQUAL_HEX8(tick ? 0x00 : 0x01, registers[0x14]); // OLATA
+    TEST_ASSERT_EQUAL_HEX8(tick ? 0x00 : 0x02, registers[0x15]); // OLATB
+
+    // Nothing changed, nothing sent
+    mcp.Flush();
+    TEST_ASSERT_EQUAL_UINT32(1, bus.GetTransfers());
+  }
+}
+
+void test_mcp23017_retries_failed_write() {
+  // Nothing answers at this address: every write is NACKed
+  Mcp23017 mcp(bus, MCP23017_ADDR);
+  mcp.ConfigureOutput(0);
+  TEST_ASSERT_FALSE(mcp.Begin());
+
+  bus.ResetTransfers();
+  mcp.WriteOutput(0, true);
+  mcp.Flush();
+  mcp.Flush();
+  TEST_ASSERT_EQUAL_UINT32(4, bus.GetTransfers()); // Latch and IODIR, twice
+
+  // Once the device answers the pending writes land
+  bus.AddDevice(MCP23017_ADDR);
+  mcp.Flush();
+  uint8_t *registers = bus.GetRegisters(MCP23017_ADDR);
+  TEST_ASSERT_EQUAL_HEX8(0x01, registers[0x14]);
+  TEST_ASSERT_EQUAL_HEX8(0xFE, registers[0x00]);
+  bus.ResetTransfers();
+  mcp.Flush();
+  TEST_ASSERT_EQUAL_UINT32(0, bus.GetTransfers());
+}
+
+void test_pcf8574_holds_inputs_high() {
+  bus.AddDevice(PCF8574_ADDR, 0);
+  Pcf8574 pcf(bus, PCF8574_ADDR);
+  pcf.ConfigureInput(1);
+  pcf.ConfigureInput(6);
+  pcf.ConfigureOutput(0);
+  TEST_ASSERT_TRUE(pcf.Begin());
+  uint8_t *port = bus.GetRegisters(PCF8574_ADDR);
+  TEST_ASSERT_EQUAL_HEX8(0x42, port[0]);
+
+  // Input bits stay high whatever the outputs do
+  bus.ResetTransfers();
+  pcf.WriteOutput(0, true);
+  pcf.Flush();
+  TEST_ASSERT_EQUAL_HEX8(0x43, port[0]);
+  pcf.WriteOutput(0, false);
+  pcf.Flush();
+  TEST_ASSERT_EQUAL_HEX8(0x42, port[0]);
+  TEST_ASSERT_EQUAL_UINT32(2, bus.GetTransfers());
+
+  // Input 6 pulled low by whatever is wired to it
+  port[0] = 0x02;
+  bus.ResetTransfers();
+  pcf.Poll(0);
+  TEST_ASSERT_EQUAL_UINT32(1, bus.GetTransfers());
+  float value;
+  TEST_ASSERT_TRUE(pcf.ReadInput(1, value));
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, value);
+  TEST_ASSERT_TRUE(pcf.ReadInput(6, value));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, value);
+  TEST_ASSERT_FALSE(pcf.ReadInput(0, value)); // An output, not an input
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_ads1115_round_robin);
+  RUN_TEST(test_mcp23017_one_transfer_each_way);
+  RUN_TEST(test_mcp23017_retries_failed_write);
+  RUN_TEST(test_pcf8574_holds_inputs_high);
+  return UNITY_END();
+}
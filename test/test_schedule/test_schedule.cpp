@@ -0,0 +1,121 @@
+#include <Schedule.h>
+#include <TimerWheel.h>
+#include <stdio.h>
+#include <unity.h>
+
+#define MONTH_START 1790812800UL // 2026-10-01 00:00
+#define MONTH_SECONDS (31 * SECONDS_PER_DAY)
+
+/**
+ * @brief A schedule driven by the wheel the way Condition drives its own:
+ * the state is set when armed and flipped by each edge's timer
+ */
+struct WheelSchedule {
+  Schedule schedule;
+  TimerNode timer;
+  bool state = false;
+  uint32_t edges = 0;
+
+  void Arm(TimerWheel &wheel, uint32_t now) {
+    state = schedule.IsActive(now);
+    timer.callback = OnEdge;
+    timer.context = this;
+    uint32_t edge = schedule.NextEdge(now);
+    if (edge) {
+      wheel.Schedule(&timer, edge);
+    }
+  }
+
+  static void OnEdge(TimerWheel &wheel, TimerNode *node, uint32_t now) {
+    WheelSchedule &self = *static_cast<WheelSchedule *>(node->context);
+    self.state = !self.state;
+    self.edges++;
+    wheel.Schedule(node, self.schedule.NextEdge(now));
+  }
+};
+
+static const Schedule kSchedules[] = {
+    {SECONDS_PER_DAY, 6 * 3600UL, 16 * 3600UL},      // Lights 06:00-22:00
+    {SECONDS_PER_DAY, 22 * 3600UL, 8 * 3600UL},      // Across midnight
+    {3600, 0, 300},                                  // 5 min every hour
+    {420, 17, 1},                                    // 1 s every 7 min
+    {5400, 1800, 2700},                              // 90 min cycle
+    {3 * SECONDS_PER_DAY, SECONDS_PER_DAY + 60, 600}, // Every third day
+    {600, 0, 600},                                   // Always on
+    {0, 0, 60},                                      // Disabled
+};
+static const uint8_t kNumSchedules = sizeof(kSchedules) / sizeof(kSchedules[0]);
+
+static TimerWheel wheel;
+static WheelSchedule schedules[kNumSchedules];
+
+void setUp() {
+  wheel.Reset(MONTH_START);
+  for (uint8_t i = 0; i < kNumSchedules; i++) {
+    schedules[i] = WheelSchedule();
+    schedules[i].schedule = kSchedules[i];
+    schedules[i].Arm(wheel, MONTH_START);
+  }
+}
+
+void tearDown() {}
+
+void test_wheel_matches_is_active_for_a_month() {
+  uint32_t expectedEdges[kNumSchedules] = {};
+  bool previous[kNumSchedules];
+  for (uint8_t i = 0; i < kNumSchedules; i++) {
+    previous[i] = kSchedules[i].IsActive(MONTH_START);
+  }
+
+  for (uint32_t now = MONTH_START + 1; now <= MONTH_START + MONTH_SECONDS;
+       now++) {
+    wheel.Advance(now);
+    for (uint8_t i = 0; i < kNumSchedules; i++) {
+      bool active = kSchedules[i].IsActive(now);
+      expectedEdges[i] += active != previous[i];
+      previous[i] = active;
+      if (schedules[i].state != active) {
+        char message[64];
+        snprintf(message, sizeof(message), "schedule %u at second %lu", i,
+                 (unsigned long)(now - MONTH_START));
+        TEST_FAIL_MESSAGE(message);
+      }
+    }
+  }
+
+  // No spurious timers either: every edge fired exactly once
+  for (uint8_t i = 0; i < kNumSchedules; i++) {
+    TEST_ASSERT_EQUAL_UINT32(expectedEdges[i], schedules[i].edges);
+  }
+  TEST_ASSERT_EQUAL_UINT32(31 * 2, schedules[0].edges);
+  TEST_ASSERT_EQUAL_UINT32(31 * 24 * 2, schedules[2].edges);
+  TEST_ASSERT_EQUAL_UINT32(0, schedules[6].edges);
+  TEST_ASSERT_EQUAL_UINT32(0, schedules[7].edges);
+}
+
+void test_next_edge_is_the_first_change() {
+  for (uint8_t i = 0; i < kNumSchedules; i++) {
+    const Schedule &schedule = kSchedules[i];
+    // Every 97 s over three days catches each phase of the short periods
+    for (uint32_t now = MONTH_START; now < MONTH_START + 3 * SECONDS_PER_DAY;
+         now += 97) {
+      uint32_t edge = schedule.NextEdge(now);
+      bool active = schedule.IsActive(now);
+      if (!edge) {
+        TEST_ASSERT_TRUE(schedule.period == 0 ||
+                         schedule.duration >= schedule.period);
+        continue;
+      }
+      TEST_ASSERT_TRUE(edge > now);
+      TEST_ASSERT_TRUE(schedule.IsActive(edge) != active);
+      TEST_ASSERT_TRUE(schedule.IsActive(edge - 1) == active);
+    }
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_wheel_matches_is_active_for_a_month);
+  RUN_TEST(test_next_edge_is_the_first_change);
+  return UNITY_END();
+}
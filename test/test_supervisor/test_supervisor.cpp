@@ -0,0 +1,157 @@
+#include <Supervisor.h>
+#include <esp_task_wdt.h>
+#include <unity.h>
+
+#define TIMEOUT_MS 20000
+#define START_MS 1000
+
+/**
+ * @brief Restart function that counts its calls and can fail
+ */
+struct FakeRestart {
+  uint8_t calls = 0;
+  TaskHandle_t hung = nullptr;
+  bool succeed = true;
+
+  static bool Restart(TaskHandle_t hung, void *arg) {
+    FakeRestart &self = *static_cast<FakeRestart *>(arg);
+    self.calls++;
+    self.hung = hung;
+    return self.succeed;
+  }
+};
+
+static FakeRestart fake;
+
+// A subsystem that beat once at START_MS and then went quiet
+static int8_t AddSilent(Supervisor &supervisor,
+                        SubsystemRestart restart = FakeRestart::Restart) {
+  int8_t id = supervisor.Add("network", TIMEOUT_MS, restart, &fake);
+  supervisor.Attach(id);
+  supervisor.Beat(id);
+  return id;
+}
+
+void setUp() {
+  stubMillis = START_MS;
+  stubWdtTasks = 0;
+  fake = FakeRestart();
+}
+
+void tearDown() {}
+
+void test_beating_subsystem_is_left_alone() {
+  Supervisor supervisor;
+  int8_t id = AddSilent(supervisor);
+  // Never beaten: not checked at all
+  supervisor.Add("idle", TIMEOUT_MS);
+
+  for (int i = 0; i < 100; i++) {
+    stubMillis += TIMEOUT_MS - 1;
+    TEST_ASSERT_EQUAL(kSupervisorOk, supervisor.Check(stubMillis));
+    supervisor.Beat(id);
+  }
+  // Silent for exactly the timeout is still fine
+  TEST_ASSERT_EQUAL(kSupervisorOk, supervisor.Check(stubMillis + TIMEOUT_MS));
+  TEST_ASSERT_EQUAL_UINT8(0, fake.calls);
+  TEST_ASSERT_EQUAL_UINT32(TIMEOUT_MS - 1,
+                           supervisor.GetSubsystem(id).maxLatencyMs);
+}
+
+void test_stall_restarts_the_subsystem() {
+  Supervisor supervisor;
+  int8_t id = AddSilent(supervisor);
+  TEST_ASSERT_EQUAL_INT(1, stubWdtTasks);
+
+  uint32_t stall = START_MS + TIMEOUT_MS + 1;
+  TEST_ASSERT_EQUAL(kSupervisorRestarted, supervisor.Check(stall));
+  TEST_ASSERT_EQUAL_UINT8(1, fake.calls);
+  TEST_ASSERT_TRUE(fake.hung == xTaskGetCurrentTaskHandle());
+  // Off the TWDT before the restart, so the watchdog can't fire meanwhile
+  TEST_ASSERT_EQUAL_INT(0, stubWdtTasks);
+  const Subsystem &subsystem = supervisor.GetSubsystem(id);
+  TEST_ASSERT_EQUAL_UINT16(1, subsystem.restarts);
+  TEST_ASSERT_EQUAL_UINT32(TIMEOUT_MS + 1, subsystem.maxLatencyMs);
+  TEST_ASSERT_NULL(supervisor.GetRebootReason());
+
+  // The new instance gets a full timeout to come up
+  TEST_ASSERT_EQUAL(kSupervisorOk, supervisor.Check(stall + TIMEOUT_MS));
+  stubMillis = stall + TIMEOUT_MS;
+  supervisor.Attach(id);
+  supervisor.Beat(id);
+  TEST_ASSERT_EQUAL_INT(1, stubWdtTasks);
+  TEST_ASSERT_EQUAL(kSupervisorOk, supervisor.Check(stubMillis + TIMEOUT_MS));
+  TEST_ASSERT_EQUAL_UINT8(1, fake.calls);
+}
+
+void test_restart_limit_reboots() {
+  Supervisor supervisor;
+  AddSilent(supervisor);
+
+  uint32_t now = START_MS;
+  for (uint8_t i = 1; i <= SUPERVISOR_MAX_RESTARTS; i++) {
+    now += TIMEOUT_MS + 1;
+    TEST_ASSERT_EQUAL(kSupervisorRestarted, supervisor.Check(now));
+    TEST_ASSERT_EQUAL_UINT8(i, fake.calls);
+  }
+  now += TIMEOUT_MS + 1;
+  TEST_ASSERT_EQUAL(kSupervisorReboot, supervisor.Check(now));
+  TEST_ASSERT_EQUAL_UINT8(SUPERVISOR_MAX_RESTARTS, fake.calls);
+  TEST_ASSERT_EQUAL_STRING("network", supervisor.GetRebootReason());
+}
+
+void test_restart_window_expires() {
+  Supervisor supervisor;
+  int8_t id = AddSilent(supervisor);
+
+  uint32_t now = START_MS;
+  for (uint8_t i = 0; i < SUPERVISOR_MAX_RESTARTS; i++) {
+    now += TIMEOUT_MS + 1;
+    supervisor.Check(now);
+  }
+  // Healthy for the rest of the window
+  while (now < SUPERVISOR_RESTART_WINDOW_MS) {
+    stubMillis = now += 1000;
+    supervisor.Beat(id);
+    TEST_ASSERT_EQUAL(kSupervisorOk, supervisor.Check(now));
+  }
+
+  // A stall in the next window is restarted again rather than rebooting
+  now += TIMEOUT_MS + 1;
+  TEST_ASSERT_EQUAL(kSupervisorRestarted, supervisor.Check(now));
+  const Subsystem &subsystem = supervisor.GetSubsystem(id);
+  TEST_ASSERT_EQUAL_UINT8(1, subsystem.recentRestarts);
+  TEST_ASSERT_EQUAL_UINT16(SUPERVISOR_MAX_RESTARTS + 1, subsystem.restarts);
+}
+
+void test_failed_restart_reboots() {
+  Supervisor supervisor;
+  AddSilent(supervisor);
+  fake.succeed = false;
+
+  TEST_ASSERT_EQUAL(kSupervisorReboot,
+                    supervisor.Check(START_MS + TIMEOUT_MS + 1));
+  TEST_ASSERT_EQUAL_UINT8(1, fake.calls);
+  TEST_ASSERT_EQUAL_STRING("network", supervisor.GetRebootReason());
+}
+
+void test_stall_without_restart_reboots() {
+  Supervisor supervisor;
+  AddSilent(supervisor, nullptr);
+
+  TEST_ASSERT_EQUAL(kSupervisorReboot,
+                    supervisor.Check(START_MS + TIMEOUT_MS + 1));
+  TEST_ASSERT_EQUAL_UINT8(0, fake.calls);
+  TEST_ASSERT_EQUAL_INT(0, stubWdtTasks);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_beating_subsystem_is_left_alone);
+  RUN_TEST(test_stall_restarts_the_subsystem);
+  RUN_TEST(test_restart_limit_reboots);
+  RUN_TEST(test_restart_window_expires);
+  RUN_TEST(test_failed_restart_reboots);
+  RUN_TEST(test_stall_without_restart_reboots);
+  return UNITY_END();
+}